@@ -0,0 +1,125 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <charts/gridlines.h>
+#include <charts/plot_axis.h>
+#include <graphics/brush.h>
+#include <graphics/layer.h>
+#include "benchmark.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+/* dense manual tick lists, without labels so that only the stroking is measured */
+static AxisDefinition mkManualAxis(size_t tick_count) {
+  AxisDefinition axis;
+  axis.mode = AxisMode::MANUAL;
+  axis.label_placement = AxisLabelPlacement::BOTTOM;
+  for (size_t i = 0; i < tick_count; ++i) {
+    axis.ticks.push_back(double(i) / tick_count);
+  }
+
+  return axis;
+}
+
+static void benchAxisRender(BenchmarkState* state, size_t tick_count) {
+  Layer layer(1200, 800);
+  Rectangle clip(80, 20, 1100, 740);
+  auto axis = mkManualAxis(tick_count);
+
+  state->setItemsPerIteration(tick_count);
+  while (state->next()) {
+    if (renderAxis(axis, clip, AxisPosition::BOTTOM, &layer) != OK) {
+      abort();
+    }
+  }
+}
+
+/* the previous implementation: one strokeLine call per tick */
+static void benchAxisStrokeLine(BenchmarkState* state, size_t tick_count) {
+  Layer layer(1200, 800);
+  Rectangle clip(80, 20, 1100, 740);
+  auto axis = mkManualAxis(tick_count);
+  auto y = clip.y + clip.h;
+  auto tick_length = from_rem(layer, axis.tick_length_rem);
+
+  state->setItemsPerIteration(tick_count);
+  while (state->next()) {
+    StrokeStyle style;
+    strokeLine(&layer, clip.x, y, clip.x + clip.w, y, style);
+
+    for (const auto& tick : axis.ticks) {
+      auto x = clip.x + clip.w * tick;
+      strokeLine(&layer, x, y, x, y + tick_length, style);
+    }
+  }
+}
+
+static void benchGridRender(BenchmarkState* state, size_t tick_count) {
+  Layer layer(1200, 800);
+  Viewport viewport(1200, 800, {20, 20, 40, 80});
+
+  chart::GridDefinition grid_h(chart::GridDefinition::GRID_HORIZONTAL);
+  chart::GridDefinition grid_v(chart::GridDefinition::GRID_VERTICAL);
+  for (size_t i = 0; i < tick_count; ++i) {
+    grid_h.addTick(double(i) / tick_count);
+    grid_v.addTick(double(i) / tick_count);
+  }
+
+  state->setItemsPerIteration(tick_count * 2);
+  while (state->next()) {
+    chart::renderGrid(grid_h, viewport, &layer);
+    chart::renderGrid(grid_v, viewport, &layer);
+  }
+}
+
+BENCHMARK(axis_render_manual_100) {
+  benchAxisRender(state, 100);
+}
+
+BENCHMARK(axis_render_manual_1e4) {
+  benchAxisRender(state, 10000);
+}
+
+BENCHMARK(axis_render_strokeline_100) {
+  benchAxisStrokeLine(state, 100);
+}
+
+BENCHMARK(axis_render_strokeline_1e4) {
+  benchAxisStrokeLine(state, 10000);
+}
+
+BENCHMARK(grid_render_100) {
+  benchGridRender(state, 100);
+}
+
+BENCHMARK(grid_render_1e4) {
+  benchGridRender(state, 10000);
+}
+
@@ -0,0 +1,93 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string>
+#include <common/config_helpers.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+static plist::Property mkDataProperty(size_t n) {
+  SyntheticData gen;
+  plist::Property prop;
+  prop.name = "xs";
+  prop.values.resize(n);
+  for (auto& v : prop.values) {
+    v.data = std::to_string(uint64_t(gen.next() * 100000) / 100.0);
+    v.is_literal = true;
+  }
+
+  return prop;
+}
+
+static void benchParseDataSeries(BenchmarkState* state, size_t n) {
+  auto prop = mkDataProperty(n);
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    std::vector<double> data;
+    if (!parseDataSeries(prop, &data)) {
+      abort();
+    }
+
+    doNotOptimize(data.data());
+  }
+}
+
+/* the previous stod based implementation, for reference */
+static void benchParseDataSeriesStod(BenchmarkState* state, size_t n) {
+  auto prop = mkDataProperty(n);
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    std::vector<double> data;
+    for (const auto& v : prop.values) {
+      data.emplace_back(std::stod(v.data));
+    }
+
+    doNotOptimize(data.data());
+  }
+}
+
+BENCHMARK(parse_data_series_1e3) {
+  benchParseDataSeries(state, 1000);
+}
+
+BENCHMARK(parse_data_series_1e6) {
+  benchParseDataSeries(state, 1000000);
+}
+
+BENCHMARK(parse_data_series_stod_1e3) {
+  benchParseDataSeriesStod(state, 1000);
+}
+
+BENCHMARK(parse_data_series_stod_1e6) {
+  benchParseDataSeriesStod(state, 1000000);
+}
+
@@ -0,0 +1,112 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <common/domain.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+static void benchDomainFit(BenchmarkState* state, size_t n) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    DomainConfig domain;
+    domain_fit(ys, &domain);
+    doNotOptimize(domain.max);
+  }
+}
+
+static void benchDomainTranslate(BenchmarkState* state, size_t n) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  DomainConfig domain;
+  domain_fit(ys, &domain);
+
+  std::vector<double> out(n);
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = domain_translate(domain, ys[i]);
+    }
+
+    doNotOptimize(out.data());
+  }
+}
+
+static void benchDomainTranslateSpan(BenchmarkState* state, size_t n) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  DomainConfig domain;
+  domain_fit(ys, &domain);
+
+  std::vector<double> out(n);
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    domain_translate_span(domain, ys.data(), out.data(), n);
+    doNotOptimize(out.data());
+  }
+}
+
+BENCHMARK(domain_fit_1e3) {
+  benchDomainFit(state, 1000);
+}
+
+BENCHMARK(domain_fit_1e6) {
+  benchDomainFit(state, 1000000);
+}
+
+BENCHMARK(domain_fit_1e7) {
+  benchDomainFit(state, 10000000);
+}
+
+BENCHMARK(domain_translate_1e3) {
+  benchDomainTranslate(state, 1000);
+}
+
+BENCHMARK(domain_translate_1e6) {
+  benchDomainTranslate(state, 1000000);
+}
+
+BENCHMARK(domain_translate_span_1e3) {
+  benchDomainTranslateSpan(state, 1000);
+}
+
+BENCHMARK(domain_translate_span_1e6) {
+  benchDomainTranslateSpan(state, 1000000);
+}
+
@@ -0,0 +1,88 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <charts/line_chart.h>
+#include <graphics/layer.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+static linechart::LinechartSeries mkRandomWalk(size_t n) {
+  linechart::LinechartSeries series;
+  SyntheticData().randomWalk(n, &series.xs, &series.ys);
+  return series;
+}
+
+static void benchLinechartRender(
+    BenchmarkState* state,
+    size_t n,
+    DecimationMode decimate) {
+  linechart::LinechartConfig config;
+  config.axis_top.mode = AxisMode::OFF;
+  config.axis_right.mode = AxisMode::OFF;
+  config.axis_bottom.mode = AxisMode::OFF;
+  config.axis_left.mode = AxisMode::OFF;
+  config.series.emplace_back(mkRandomWalk(n));
+  config.series.back().decimate = decimate;
+
+  Layer layer(1200, 600);
+  Rectangle clip(0, 0, layer.width, layer.height);
+
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    layer.clear(Colour{1, 1, 1, 1});
+    if (!linechart::draw(config, clip, &layer)) {
+      abort();
+    }
+  }
+}
+
+BENCHMARK(linechart_render_1e6) {
+  benchLinechartRender(state, 1000000, DecimationMode::AUTO);
+}
+
+BENCHMARK(linechart_render_1e7) {
+  benchLinechartRender(state, 10000000, DecimationMode::AUTO);
+}
+
+BENCHMARK(linechart_render_1e8) {
+  benchLinechartRender(state, 100000000, DecimationMode::AUTO);
+}
+
+/* full-resolution paths; 1e8 points is left out as it needs ~6GB for the path */
+BENCHMARK(linechart_render_nodecimate_1e6) {
+  benchLinechartRender(state, 1000000, DecimationMode::OFF);
+}
+
+BENCHMARK(linechart_render_nodecimate_1e7) {
+  benchLinechartRender(state, 10000000, DecimationMode::OFF);
+}
+
@@ -0,0 +1,187 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <fstream>
+#include <utils/flagparser.h>
+#include <utils/wallclock.h>
+#include <utils/stringutil.h>
+#include "benchmark.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+namespace plotfx {
+namespace bench {
+
+BenchmarkState::BenchmarkState(
+    uint64_t min_runtime_us) :
+    min_runtime_us_(min_runtime_us),
+    iterations_(0),
+    items_per_iteration_(0),
+    time_begin_(0),
+    time_end_(0) {}
+
+bool BenchmarkState::next() {
+  auto now = MonotonicClock::now();
+  if (iterations_ == 0 && time_begin_ == 0) {
+    time_begin_ = now;
+    return true;
+  }
+
+  ++iterations_;
+  time_end_ = now;
+  return time_end_ - time_begin_ < min_runtime_us_;
+}
+
+void BenchmarkState::setItemsPerIteration(uint64_t items) {
+  items_per_iteration_ = items;
+}
+
+uint64_t BenchmarkState::getIterations() const {
+  return iterations_;
+}
+
+uint64_t BenchmarkState::getRuntimeMicros() const {
+  return time_end_ - time_begin_;
+}
+
+uint64_t BenchmarkState::getItemsPerIteration() const {
+  return items_per_iteration_;
+}
+
+std::vector<Benchmark>& getBenchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+BenchmarkRegistration::BenchmarkRegistration(
+    const char* name,
+    BenchmarkFn fn) {
+  getBenchmarks().emplace_back(Benchmark{name, fn});
+}
+
+} // namespace bench
+} // namespace plotfx
+
+struct BenchmarkResult {
+  std::string name;
+  uint64_t iterations;
+  double ns_per_iter;
+  uint64_t items_per_iter;
+  double items_per_sec;
+};
+
+static void writeJSON(
+    const std::vector<BenchmarkResult>& results,
+    uint64_t min_runtime_us,
+    std::ostream& os) {
+  os << "{\n  \"min_runtime_us\": " << min_runtime_us << ",\n";
+  os << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    os << (i > 0 ? ",\n" : "\n")
+       << "    {\"name\": \"" << r.name << "\""
+       << ", \"iterations\": " << r.iterations
+       << ", \"ns_per_iter\": " << uint64_t(r.ns_per_iter)
+       << ", \"items_per_iter\": " << r.items_per_iter
+       << ", \"items_per_sec\": " << uint64_t(r.items_per_sec)
+       << "}";
+  }
+
+  os << "\n  ]\n}\n";
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  std::string flag_filter;
+  flag_parser.defineString("filter", false, &flag_filter);
+
+  std::string flag_json;
+  flag_parser.defineString("json", false, &flag_json);
+
+  uint64_t flag_min_time_ms = 500;
+  flag_parser.defineUInt64("min-time-ms", false, &flag_min_time_ms);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc.isSuccess()) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    std::cerr <<
+        "Usage: $ plotfx_bench [--filter <name>] [--json <file>] "
+        "[--min-time-ms <ms>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto min_runtime_us = flag_min_time_ms * 1000;
+
+  std::vector<BenchmarkResult> results;
+  for (const auto& b : getBenchmarks()) {
+    if (!flag_filter.empty() && b.name.find(flag_filter) == std::string::npos) {
+      continue;
+    }
+
+    BenchmarkState state(min_runtime_us);
+    b.fn(&state);
+
+    BenchmarkResult r;
+    r.name = b.name;
+    r.iterations = state.getIterations();
+    r.ns_per_iter =
+        state.getRuntimeMicros() * 1000.0 /
+        std::max(state.getIterations(), uint64_t(1));
+    r.items_per_iter = state.getItemsPerIteration();
+    r.items_per_sec =
+        r.ns_per_iter > 0 ? r.items_per_iter / (r.ns_per_iter / 1e9) : 0;
+
+    std::cerr << StringUtil::format("$0 $1 iters, $2 ns/iter",
+        r.name,
+        r.iterations,
+        uint64_t(r.ns_per_iter));
+
+    if (r.items_per_iter > 0 && r.ns_per_iter > 0) {
+      std::cerr << StringUtil::format(", $0 items/s", uint64_t(r.items_per_sec));
+    }
+
+    std::cerr << std::endl;
+    results.emplace_back(std::move(r));
+  }
+
+  if (flag_json == "-") {
+    writeJSON(results, min_runtime_us, std::cout);
+  } else if (!flag_json.empty()) {
+    std::ofstream json_file(flag_json);
+    writeJSON(results, min_runtime_us, json_file);
+    if (!json_file) {
+      std::cerr << "ERROR: can't write " << flag_json << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
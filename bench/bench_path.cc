@@ -0,0 +1,119 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <graphics/compact_path.h>
+#include <graphics/path.h>
+#include <graphics/simplify.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+static void benchPathBuild(BenchmarkState* state, size_t n, bool reserve) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    Path path;
+    if (reserve) {
+      path.reserve(n);
+    }
+
+    path.moveTo(xs[0], ys[0]);
+    for (size_t i = 1; i < n; ++i) {
+      path.lineTo(xs[i], ys[i]);
+    }
+
+    doNotOptimize(path.data());
+  }
+}
+
+static void benchCompactPathBuild(BenchmarkState* state, size_t n) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    CompactPath path(n);
+    path.moveTo(xs[0], ys[0]);
+    for (size_t i = 1; i < n; ++i) {
+      path.lineTo(xs[i], ys[i]);
+    }
+
+    doNotOptimize(path.coords());
+  }
+}
+
+static void benchPathSimplify(BenchmarkState* state, size_t n, double tolerance) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData().randomWalk(n, &xs, &ys);
+
+  /* a long smooth-ish series drawn 1200px wide */
+  CompactPath path(n);
+  for (size_t i = 0; i < n; ++i) {
+    auto x = double(i) / n * 1200;
+    i == 0 ? path.moveTo(x, ys[i]) : path.lineTo(x, ys[i]);
+  }
+
+  CompactPath out;
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    path_simplify(path, tolerance, &out);
+    doNotOptimize(out.coords());
+  }
+}
+
+BENCHMARK(path_build_1e3) {
+  benchPathBuild(state, 1000, false);
+}
+
+BENCHMARK(path_build_1e6) {
+  benchPathBuild(state, 1000000, false);
+}
+
+BENCHMARK(path_build_reserved_1e6) {
+  benchPathBuild(state, 1000000, true);
+}
+
+BENCHMARK(compact_path_build_1e6) {
+  benchCompactPathBuild(state, 1000000);
+}
+
+BENCHMARK(path_simplify_0px_1e6) {
+  benchPathSimplify(state, 1000000, 0);
+}
+
+BENCHMARK(path_simplify_05px_1e6) {
+  benchPathSimplify(state, 1000000, 0.5);
+}
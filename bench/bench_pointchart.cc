@@ -0,0 +1,95 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <charts/point_chart.h>
+#include <graphics/layer.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+static void benchPointchartRender(
+    BenchmarkState* state,
+    size_t n,
+    MarkerShape shape,
+    pointchart::PointchartMode mode = pointchart::PointchartMode::MARKERS) {
+  pointchart::PointchartConfig config;
+  config.axis_top.mode = AxisMode::OFF;
+  config.axis_right.mode = AxisMode::OFF;
+  config.axis_bottom.mode = AxisMode::OFF;
+  config.axis_left.mode = AxisMode::OFF;
+
+  pointchart::PointchartSeries series;
+  SyntheticData().randomWalk(n, &series.xs, &series.ys);
+  series.mode = mode;
+  series.marker.shape = shape;
+  series.marker.colour = Colour::fromRGBA(0, 0, 0, 0.5);
+  config.series.emplace_back(std::move(series));
+
+  Layer layer(1200, 600);
+  Rectangle clip(0, 0, layer.width, layer.height);
+
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    layer.clear(Colour{1, 1, 1, 1});
+    if (!pointchart::draw(config, clip, &layer)) {
+      abort();
+    }
+  }
+}
+
+BENCHMARK(pointchart_render_1e5) {
+  benchPointchartRender(state, 100000, MarkerShape::CIRCLE);
+}
+
+BENCHMARK(pointchart_render_1e6) {
+  benchPointchartRender(state, 1000000, MarkerShape::CIRCLE);
+}
+
+BENCHMARK(pointchart_render_square_1e6) {
+  benchPointchartRender(state, 1000000, MarkerShape::SQUARE);
+}
+
+BENCHMARK(pointchart_render_density_1e6) {
+  benchPointchartRender(
+      state,
+      1000000,
+      MarkerShape::CIRCLE,
+      pointchart::PointchartMode::DENSITY);
+}
+
+BENCHMARK(pointchart_render_density_1e7) {
+  benchPointchartRender(
+      state,
+      10000000,
+      MarkerShape::CIRCLE,
+      pointchart::PointchartMode::DENSITY);
+}
+
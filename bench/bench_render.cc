@@ -0,0 +1,237 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <unistd.h>
+#include <graphics/brush.h>
+#include <graphics/layer.h>
+#include <graphics/layer_pool.h>
+#include <graphics/text_shaper.h>
+#include "benchmark.h"
+#include "synthetic_data.h"
+
+using namespace plotfx;
+using namespace plotfx::bench;
+
+/* same font as drawText */
+static const char kFontFile[] = "/usr/share/fonts/google-roboto/Roboto-Medium.ttf";
+
+static void benchStrokePath(BenchmarkState* state, size_t n) {
+  Layer layer(1200, 800);
+  Rectangle clip(0, 0, layer.width, layer.height);
+
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData gen;
+  gen.randomWalk(n, &xs, &ys);
+
+  Path path;
+  path.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    auto x = double(i) / n * layer.width;
+    auto y = layer.height / 2 + ys[i];
+    i == 0 ? path.moveTo(x, y) : path.lineTo(x, y);
+  }
+
+  StrokeStyle style;
+  state->setItemsPerIteration(n);
+  while (state->next()) {
+    strokePath(&layer, clip, path, style);
+  }
+}
+
+static void benchShapeText(BenchmarkState* state, bool cached) {
+  /* typical axis labels */
+  std::vector<std::string> labels;
+  for (size_t i = 0; i <= 100; ++i) {
+    labels.emplace_back(std::to_string(i * 20) + ".0");
+  }
+
+  FontInfo font_info;
+  font_info.font_file = kFontFile;
+  font_info.font_size = 12;
+
+  text::TextShaper shaper(96);
+  state->setItemsPerIteration(labels.size());
+  while (state->next()) {
+    if (!cached) {
+      text::ShapedRunCache::get()->clear();
+    }
+
+    for (const auto& l : labels) {
+      auto rc = shaper.shapeText(l, font_info, [] (const GlyphInfo& g) {
+        doNotOptimize(g.codepoint);
+      });
+
+      if (rc != OK) {
+        abort();
+      }
+    }
+  }
+}
+
+static void benchWritePNG(
+    BenchmarkState* state,
+    size_t n,
+    double width = 1200,
+    double height = 800,
+    const PNGOptions& png_opts = PNGOptions()) {
+  Layer layer(width, height);
+  layer.clear(Colour{1, 1, 1, 1});
+
+  std::vector<double> xs;
+  std::vector<double> ys;
+  SyntheticData gen;
+  gen.randomWalk(n, &xs, &ys);
+
+  Path path;
+  for (size_t i = 0; i < n; ++i) {
+    auto x = double(i) / n * layer.width;
+    auto y = layer.height / 2 + ys[i];
+    i == 0 ? path.moveTo(x, y) : path.lineTo(x, y);
+  }
+
+  StrokeStyle style;
+  strokePath(&layer, Rectangle(0, 0, layer.width, layer.height), path, style);
+
+  auto out_path = "/tmp/plotfx_bench_" + std::to_string(getpid()) + ".png";
+  state->setItemsPerIteration(1);
+  while (state->next()) {
+    if (layer.writeToFile(out_path, png_opts) != OK) {
+      abort();
+    }
+  }
+
+  unlink(out_path.c_str());
+}
+
+/* a rendered chart: opaque except for a sprinkle of translucent pixels */
+static void benchConvertPixels(
+    BenchmarkState* state,
+    PixelFormat pixel_format,
+    double translucent_fraction) {
+  const size_t width = 3840;
+  const size_t height = 2160;
+
+  SyntheticData gen;
+  std::vector<uint32_t> pixels(width * height);
+  for (auto& p : pixels) {
+    uint32_t a = gen.next() < translucent_fraction ? gen.next() * 255 : 255;
+    uint32_t c = gen.next() * a;
+    p = (a << 24) | (c << 16) | (c << 8) | c;
+  }
+
+  std::vector<unsigned char> row(width * getPixelSize(pixel_format));
+  state->setItemsPerIteration(pixels.size());
+  while (state->next()) {
+    for (size_t y = 0; y < height; ++y) {
+      convertPixels_ARGB32(pixel_format, &pixels[y * width], width, row.data());
+      doNotOptimize(row[0]);
+    }
+  }
+}
+
+static void benchAcquireLayer(BenchmarkState* state, bool pooled) {
+  LayerPool pool;
+  state->setItemsPerIteration(1);
+  while (state->next()) {
+    if (pooled) {
+      auto layer = pool.acquire(1200, 800);
+      layer->clear(Colour{1, 1, 1, 1});
+    } else {
+      Layer layer(1200, 800);
+      layer.clear(Colour{1, 1, 1, 1});
+    }
+  }
+}
+
+BENCHMARK(stroke_path_1e3) {
+  benchStrokePath(state, 1000);
+}
+
+BENCHMARK(stroke_path_1e5) {
+  benchStrokePath(state, 100000);
+}
+
+BENCHMARK(shape_text_uncached) {
+  benchShapeText(state, false);
+}
+
+BENCHMARK(shape_text_cached) {
+  benchShapeText(state, true);
+}
+
+BENCHMARK(write_png_1200x800) {
+  benchWritePNG(state, 10000);
+}
+
+BENCHMARK(acquire_layer_1200x800_new) {
+  benchAcquireLayer(state, false);
+}
+
+BENCHMARK(acquire_layer_1200x800_pooled) {
+  benchAcquireLayer(state, true);
+}
+
+BENCHMARK(convert_pixels_rgba8_3840x2160) {
+  benchConvertPixels(state, PixelFormat::RGBA8, 0.01);
+}
+
+BENCHMARK(convert_pixels_rgb8_opaque_3840x2160) {
+  benchConvertPixels(state, PixelFormat::RGB8, 0);
+}
+
+static PNGOptions mkPNGOptions(int level, size_t threads) {
+  PNGOptions opts;
+  opts.compression_level = level;
+  opts.threads = threads;
+  return opts;
+}
+
+BENCHMARK(write_png_1200x800_indexed) {
+  auto opts = mkPNGOptions(6, 1);
+  opts.indexed = true;
+  benchWritePNG(state, 10000, 1200, 800, opts);
+}
+
+BENCHMARK(write_png_3840x2160) {
+  benchWritePNG(state, 100000, 3840, 2160, mkPNGOptions(6, 1));
+}
+
+BENCHMARK(write_png_3840x2160_threads4) {
+  benchWritePNG(state, 100000, 3840, 2160, mkPNGOptions(6, 4));
+}
+
+BENCHMARK(write_png_3840x2160_level1) {
+  benchWritePNG(state, 100000, 3840, 2160, mkPNGOptions(1, 1));
+}
+
+BENCHMARK(write_png_3840x2160_level1_threads4) {
+  benchWritePNG(state, 100000, 3840, 2160, mkPNGOptions(1, 4));
+}
+
@@ -0,0 +1,100 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace plotfx {
+namespace bench {
+
+/**
+ * Passed to every benchmark. The benchmark body calls next() in a loop and
+ * does one unit of work per iteration until next() returns false
+ */
+class BenchmarkState {
+public:
+
+  BenchmarkState(uint64_t min_runtime_us);
+
+  bool next();
+
+  /**
+   * Set the number of items (points, bytes, glyphs, ...) processed per
+   * iteration; used to report throughput
+   */
+  void setItemsPerIteration(uint64_t items);
+
+  uint64_t getIterations() const;
+  uint64_t getRuntimeMicros() const;
+  uint64_t getItemsPerIteration() const;
+
+protected:
+  uint64_t min_runtime_us_;
+  uint64_t iterations_;
+  uint64_t items_per_iteration_;
+  uint64_t time_begin_;
+  uint64_t time_end_;
+};
+
+using BenchmarkFn = std::function<void (BenchmarkState*)>;
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFn fn;
+};
+
+std::vector<Benchmark>& getBenchmarks();
+
+struct BenchmarkRegistration {
+  BenchmarkRegistration(const char* name, BenchmarkFn fn);
+};
+
+/**
+ * Prevent the compiler from optimizing away a computation whose result is
+ * otherwise unused
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#define BENCHMARK(N) \
+    static void __bench_##N(plotfx::bench::BenchmarkState* state); \
+    static plotfx::bench::BenchmarkRegistration __bench_reg_##N( \
+        #N, \
+        &__bench_##N); \
+    static void __bench_##N(plotfx::bench::BenchmarkState* state)
+
+} // namespace bench
+} // namespace plotfx
+
@@ -0,0 +1,117 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace plotfx {
+namespace bench {
+
+/**
+ * Deterministic data generator for benchmarks; the same seed always yields
+ * the same data so results can be compared across commits
+ */
+class SyntheticData {
+public:
+
+  static const uint64_t kDefaultSeed = 0x2545f4914f6cdd1d;
+
+  SyntheticData(uint64_t seed = kDefaultSeed);
+
+  /**
+   * Returns a pseudo-random value in [0, 1)
+   */
+  double next();
+
+  /**
+   * Generate a random walk of n points with xs = 0, 1, 2, ...
+   */
+  void randomWalk(size_t n, std::vector<double>* xs, std::vector<double>* ys);
+
+  /**
+   * Generate a linechart spec with one series of n points
+   */
+  std::string linechartSpec(size_t n);
+
+protected:
+  uint64_t state_;
+};
+
+inline SyntheticData::SyntheticData(uint64_t seed) : state_(seed ? seed : 1) {}
+
+inline double SyntheticData::next() {
+  /* xorshift64 */
+  state_ ^= state_ << 13;
+  state_ ^= state_ >> 7;
+  state_ ^= state_ << 17;
+  return (state_ >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline void SyntheticData::randomWalk(
+    size_t n,
+    std::vector<double>* xs,
+    std::vector<double>* ys) {
+  xs->resize(n);
+  ys->resize(n);
+
+  double y = 0;
+  for (size_t i = 0; i < n; ++i) {
+    y += next() * 2.0 - 1.0;
+    (*xs)[i] = i;
+    (*ys)[i] = y;
+  }
+}
+
+inline std::string SyntheticData::linechartSpec(size_t n) {
+  std::vector<double> xs;
+  std::vector<double> ys;
+  randomWalk(n, &xs, &ys);
+
+  std::string spec = "linechart {\n  series {\n    xs:";
+  for (auto x : xs) {
+    spec += ' ';
+    spec += std::to_string(x);
+  }
+
+  spec += ";\n    ys:";
+  for (auto y : ys) {
+    spec += ' ';
+    spec += std::to_string(y);
+  }
+
+  spec += ";\n    colour: #06c;\n  }\n}\n";
+  return spec;
+}
+
+} // namespace bench
+} // namespace plotfx
+
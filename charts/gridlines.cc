@@ -49,7 +49,7 @@ void GridDefinition::addTick(double tick_position) {
   ticks_.push_back(tick_position);
 }
 
-const std::vector<double> GridDefinition::ticks() const {
+const std::vector<double>& GridDefinition::ticks() const {
   return ticks_;
 }
 
@@ -57,40 +57,41 @@ void renderGrid(
     const GridDefinition& grid,
     const Viewport& viewport,
     Layer* target) {
-  StrokeStyle style;
+  const auto& ticks = grid.ticks();
+
+  std::vector<StrokeSegment> segments;
+  segments.reserve(ticks.size());
 
   switch (grid.placement()) {
 
     case GridDefinition::GRID_HORIZONTAL:
-      for (const auto& tick : grid.ticks()) {
+      for (const auto& tick : ticks) {
         auto line_y = viewport.paddingTop() +
             viewport.innerHeight() * (1.0 - tick);
 
-        strokeLine(
-            target,
+        segments.push_back({
             viewport.paddingLeft(),
             line_y,
             viewport.paddingLeft() + viewport.innerWidth(),
-            line_y,
-            style);
+            line_y});
       }
       break;
 
     case GridDefinition::GRID_VERTICAL:
-      for (const auto& tick : grid.ticks()) {
+      for (const auto& tick : ticks) {
         auto line_x = viewport.paddingLeft() + viewport.innerWidth() * tick;
 
-        strokeLine(
-            target,
+        segments.push_back({
             line_x,
             viewport.paddingTop(),
             line_x,
-            viewport.paddingTop() + viewport.innerHeight(),
-            style);
+            viewport.paddingTop() + viewport.innerHeight()});
       }
       break;
 
   }
+
+  strokeSegments(target, segments, StrokeStyle{});
 }
 
 }
@@ -61,7 +61,7 @@ public:
 
   kPlacement placement() const;
 
-  const std::vector<double> ticks() const;
+  const std::vector<double>& ticks() const;
 
 protected:
   kPlacement placement_;
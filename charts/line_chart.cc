@@ -28,13 +28,16 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
 #include <plotfx.h>
 #include <graphics/path.h>
+#include <graphics/simplify.h>
 #include <graphics/brush.h>
 #include <graphics/text.h>
 #include <graphics/layout.h>
 #include "line_chart.h"
 #include "common/config_helpers.h"
+#include "utils/profile.h"
 
 namespace plotfx {
 namespace linechart {
@@ -48,7 +51,9 @@ char LineChart::kDefaultPointSize[] = "3";
 
 LinechartSeries::LinechartSeries() :
     line_width(from_pt(2)),
-    line_colour(Colour::fromRGB(0, 0, 0)) {}
+    line_colour(Colour::fromRGB(0, 0, 0)),
+    decimate(DecimationMode::OFF),
+    simplify(0) {}
 
 LinechartConfig::LinechartConfig() :
     margins({
@@ -70,24 +75,58 @@ ReturnCode drawSeries(
     return ERROR_INVALID_ARGUMENT;
   }
 
-  Path path;
-  for (size_t i = 0; i < series.xs.size(); ++i) {
-    auto x = series.xs[i];
-    auto y = series.ys[i];
-    auto sx = clip.x + domain_translate(domain_x, x) * clip.w;
-    auto sy = clip.y + (1.0 - domain_translate(domain_y, y)) * clip.h;
-
-    if (i == 0) {
-      path.moveTo(sx, sy);
-    } else {
-      path.lineTo(sx, sy);
+  PLOTFX_PROFILE_SCOPE("linechart::drawSeries");
+
+  auto point_count = series.xs.size();
+  profileCounter(ProfileCounter::POINTS_PROCESSED, point_count);
+
+  /* decimation is opt-in as it can move stroke joins by a sub-pixel amount;
+   * it only pays off with more than four points per pixel column */
+  auto decimate =
+      series.decimate == DecimationMode::AUTO &&
+      point_count > 4 * std::max(clip.w, 0.0);
+
+  /* device y grows downwards: clip.y + (1 - domain_translate(v)) * clip.h */
+  auto domain_y_device = domain_y;
+  domain_y_device.inverted = !domain_y.inverted;
+
+  /* translate points into device space in fixed-size blocks */
+  static const size_t kBlockSize = 4096;
+  double sx[kBlockSize];
+  double sy[kBlockSize];
+
+  CompactPath path(decimate ? 4 * (size_t(clip.w) + 2) : point_count);
+
+  DecimatorM4 decimator(&path);
+  for (size_t i = 0; i < point_count; i += kBlockSize) {
+    auto n = std::min(kBlockSize, point_count - i);
+    domain_translate_span(domain_x, &series.xs[i], sx, n, clip.w, clip.x);
+    domain_translate_span(domain_y_device, &series.ys[i], sy, n, clip.h, clip.y);
+
+    for (size_t j = 0; j < n; ++j) {
+      if (decimate) {
+        decimator.addPoint(sx[j], sy[j]);
+      } else if (i + j == 0) {
+        path.moveTo(sx[j], sy[j]);
+      } else {
+        path.lineTo(sx[j], sy[j]);
+      }
     }
   }
 
+  decimator.flush();
+
   StrokeStyle style;
   style.line_width = series.line_width;
   style.colour = series.line_colour;
-  strokePath(layer, clip, path, style);
+
+  if (series.simplify > 0) {
+    CompactPath simplified;
+    path_simplify(path, series.simplify, &simplified);
+    strokePath(layer, clip, simplified, style);
+  } else {
+    strokePath(layer, clip, path, style);
+  }
 
   return OK;
 }
@@ -100,9 +139,12 @@ ReturnCode draw(
   auto domain_x = config.domain_x;
   auto domain_y = config.domain_y;
 
-  for (const auto& s : config.series) {
-    domain_fit(s.xs, &domain_x);
-    domain_fit(s.ys, &domain_y);
+  {
+    PLOTFX_PROFILE_SCOPE("domain_fit");
+    for (const auto& s : config.series) {
+      domain_fit_span(s.xs.data(), s.xs.size(), &domain_x);
+      domain_fit_span(s.ys.data(), s.ys.size(), &domain_y);
+    }
   }
 
   // setup layout
@@ -159,15 +201,36 @@ ReturnCode draw(
   return ReturnCode::success();
 }
 
-ReturnCode configureSeries(const plist::Property& prop, LinechartConfig* config) {
+ReturnCode parseDecimationModeProp(
+    const plist::Property& prop,
+    DecimationMode* value) {
+  if (prop.size() != 1) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<DecimationMode> defs = {
+    { "auto", DecimationMode::AUTO },
+    { "off", DecimationMode::OFF },
+  };
+
+  return parseEnum(defs, prop[0], value);
+}
+
+ReturnCode configureSeries(
+    const plist::Property& prop,
+    DataContext* ctx,
+    LinechartConfig* config) {
   if (!prop.child) {
     return ERROR_INVALID_ARGUMENT;
   }
 
   LinechartSeries series;
-  static const ParserDefinitions pdefs = {
-    {"xs", std::bind(&parseDataSeries, std::placeholders::_1, &series.xs)},
-    {"ys", std::bind(&parseDataSeries, std::placeholders::_1, &series.ys)},
+  const ParserDefinitions pdefs = {
+    {"xs", std::bind(&configure_data_series, std::placeholders::_1, ctx, &series.xs)},
+    {"ys", std::bind(&configure_data_series, std::placeholders::_1, ctx, &series.ys)},
     {
       "colour",
       configure_multiprop({
@@ -176,6 +239,8 @@ ReturnCode configureSeries(const plist::Property& prop, LinechartConfig* config)
     },
     {"line-colour", std::bind(&configure_colour, std::placeholders::_1, &series.line_colour)},
     {"line-width", std::bind(&parseMeasureProp, std::placeholders::_1, &series.line_width)},
+    {"decimate", std::bind(&parseDecimationModeProp, std::placeholders::_1, &series.decimate)},
+    {"simplify", std::bind(&configure_float, std::placeholders::_1, &series.simplify)},
   };
 
   if (auto rc = parseAll(*prop.child, pdefs); !rc) {
@@ -186,9 +251,12 @@ ReturnCode configureSeries(const plist::Property& prop, LinechartConfig* config)
   return OK;
 }
 
-ReturnCode configure(const plist::PropertyList& plist, ElementRef* elem) {
+ReturnCode configure(
+    const plist::PropertyList& plist,
+    DataContext* ctx,
+    ElementRef* elem) {
   LinechartConfig config;
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {
       "margin",
       configure_multiprop({
@@ -212,7 +280,7 @@ ReturnCode configure(const plist::PropertyList& plist, ElementRef* elem) {
     {"xmax", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_x.max)},
     {"ymin", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_y.min)},
     {"ymax", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_y.max)},
-    {"series", std::bind(&configureSeries, std::placeholders::_1, &config)},
+    {"series", std::bind(&configureSeries, std::placeholders::_1, ctx, &config)},
   };
 
   if (auto rc = parseAll(plist, pdefs); !rc.isSuccess()) {
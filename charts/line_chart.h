@@ -32,12 +32,15 @@
 #include <stdlib.h>
 #include <plist/plist.h>
 #include <graphics/layer.h>
+#include <graphics/decimate.h>
 #include <graphics/viewport.h>
 #include <common/domain.h>
 #include <common/element.h>
 #include "plot_axis.h"
 
 namespace plotfx {
+struct DataContext;
+
 namespace linechart {
 
 struct LinechartSeries {
@@ -46,6 +49,8 @@ struct LinechartSeries {
   std::vector<double> ys;
   Measure line_width;
   Colour line_colour;
+  DecimationMode decimate;
+  double simplify;
 };
 
 struct LinechartConfig {
@@ -64,6 +69,7 @@ ReturnCode draw(const LinechartConfig& config, const Rectangle& clip, Layer* fra
 
 ReturnCode configure(
     const plist::PropertyList& plist,
+    DataContext* ctx,
     ElementRef* elem);
 
 } // namespace linechart
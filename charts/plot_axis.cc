@@ -35,6 +35,7 @@
 #include <graphics/text.h>
 #include <graphics/layout.h>
 #include <graphics/brush.h>
+#include <utils/profile.h>
 
 namespace plotfx {
 
@@ -75,11 +76,10 @@ static Status renderAxisVertical(
     double y0,
     double y1,
     Layer* target) {
-  /* draw axis line */ 
-  {
-    StrokeStyle style;
-    strokeLine(target, x, y0, x, y1, style);
-  }
+  /* draw axis line and ticks */
+  std::vector<StrokeSegment> segments;
+  segments.reserve(axis_config.ticks.size() + 1);
+  segments.push_back({x, y0, x, y1});
 
   double label_placement = 0;
   switch (axis_config.label_placement) {
@@ -93,19 +93,14 @@ static Status renderAxisVertical(
       break;
   }
 
-  /* draw ticks */
+  auto tick_length = from_rem(*target, axis_config.tick_length_rem);
   for (const auto& tick : axis_config.ticks) {
     auto y = y0 + (y1 - y0) * (1.0 - tick);
-    StrokeStyle style;
-    strokeLine(
-        target,
-        x,
-        y,
-        x + from_rem(*target, axis_config.tick_length_rem) * label_placement,
-        y,
-        style);
+    segments.push_back({x, y, x + tick_length * label_placement, y});
   }
 
+  strokeSegments(target, segments, StrokeStyle{});
+
   /* draw labels */
   auto label_padding = from_rem(*target, axis_config.label_padding_rem);
   for (const auto& label : axis_config.labels) {
@@ -130,11 +125,10 @@ static Status renderAxisHorizontal(
     double x0,
     double x1,
     Layer* target) {
-  /* draw axis line */ 
-  {
-    StrokeStyle style;
-    strokeLine(target, x0, y, x1, y, style);
-  }
+  /* draw axis line and ticks */
+  std::vector<StrokeSegment> segments;
+  segments.reserve(axis_config.ticks.size() + 1);
+  segments.push_back({x0, y, x1, y});
 
   double label_placement = 0;
   switch (axis_config.label_placement) {
@@ -148,19 +142,14 @@ static Status renderAxisHorizontal(
       break;
   }
 
-  /* draw ticks */
+  auto tick_length = from_rem(*target, axis_config.tick_length_rem);
   for (const auto& tick : axis_config.ticks) {
     auto x = x0 + (x1 - x0) * tick;
-    StrokeStyle style;
-    strokeLine(
-        target,
-        x,
-        y,
-        x,
-        y + from_rem(*target, axis_config.tick_length_rem) * label_placement,
-        style);
+    segments.push_back({x, y, x, y + tick_length * label_placement});
   }
 
+  strokeSegments(target, segments, StrokeStyle{});
+
   /* draw labels */
   auto label_padding = from_rem(*target, axis_config.label_padding_rem);
   for (const auto& label : axis_config.labels) {
@@ -257,6 +246,8 @@ ReturnCode axis_expand_auto(
     const AxisPosition& pos,
     const DomainConfig& domain,
     AxisDefinition* out) {
+  PLOTFX_PROFILE_SCOPE("axis_expand_auto");
+
   *out = in;
 
   switch (out->label_placement) {
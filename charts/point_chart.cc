@@ -0,0 +1,416 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *   Copyright (c) 2014 Paul Asmuth, Google Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <thread>
+#include <plotfx.h>
+#include <graphics/brush.h>
+#include <graphics/layout.h>
+#include "point_chart.h"
+#include "common/config_helpers.h"
+#include "utils/profile.h"
+
+namespace plotfx {
+namespace pointchart {
+
+/* binning is only split across threads in chunks of at least this size */
+static const size_t kDensityPointsPerThread = 1 << 18;
+
+PointchartSeries::PointchartSeries() :
+    mode(PointchartMode::MARKERS),
+    density_bin_size(from_px(1)),
+    density_scale(DensityScale::LOG),
+    density_colour_low(Colour::fromRGB(0.78, 0.86, 0.94)),
+    density_colour_high(Colour::fromRGB(0.03, 0.19, 0.42)) {
+  marker.size = from_pt(4);
+}
+
+PointchartConfig::PointchartConfig() :
+    margins({
+        Measure(Unit::REM, 4.0f),
+        Measure(Unit::REM, 4.0f),
+        Measure(Unit::REM, 4.0f),
+        Measure(Unit::REM, 4.0f)}) {
+  domain_x.padding = 0.1f;
+  domain_y.padding = 0.1f;
+}
+
+ReturnCode drawSeriesMarkers(
+    const PointchartSeries& series,
+    const DomainConfig& domain_x,
+    const DomainConfig& domain_y,
+    const Rectangle& clip,
+    Layer* layer) {
+  if (series.xs.size() != series.ys.size()) {
+    return ReturnCode::errorf(
+        "EARG",
+        "series has $0 x values but $1 y values",
+        series.xs.size(),
+        series.ys.size());
+  }
+
+  PLOTFX_PROFILE_SCOPE("pointchart::drawSeriesMarkers");
+
+  auto point_count = series.xs.size();
+  profileCounter(ProfileCounter::POINTS_PROCESSED, point_count);
+
+  /* device y grows downwards: clip.y + (1 - domain_translate(v)) * clip.h */
+  auto domain_y_device = domain_y;
+  domain_y_device.inverted = !domain_y.inverted;
+
+  /* translate points into device space in fixed-size blocks */
+  static const size_t kBlockSize = 4096;
+  double sx[kBlockSize];
+  double sy[kBlockSize];
+  double coords[kBlockSize * 2];
+
+  for (size_t i = 0; i < point_count; i += kBlockSize) {
+    auto n = std::min(kBlockSize, point_count - i);
+    domain_translate_span(domain_x, &series.xs[i], sx, n, clip.w, clip.x);
+    domain_translate_span(domain_y_device, &series.ys[i], sy, n, clip.h, clip.y);
+
+    for (size_t j = 0; j < n; ++j) {
+      coords[j * 2 + 0] = sx[j];
+      coords[j * 2 + 1] = sy[j];
+    }
+
+    drawMarkers(layer, clip, series.marker, coords, n);
+  }
+
+  return OK;
+}
+
+ReturnCode drawSeriesDensity(
+    const PointchartSeries& series,
+    const DomainConfig& domain_x,
+    const DomainConfig& domain_y,
+    const Rectangle& clip,
+    Layer* layer) {
+  if (series.xs.size() != series.ys.size()) {
+    return ReturnCode::errorf(
+        "EARG",
+        "series has $0 x values but $1 y values",
+        series.xs.size(),
+        series.ys.size());
+  }
+
+  PLOTFX_PROFILE_SCOPE("pointchart::drawSeriesDensity");
+
+  auto point_count = series.xs.size();
+  profileCounter(ProfileCounter::POINTS_PROCESSED, point_count);
+
+  DensityGrid grid(clip, to_px(layer->measures, series.density_bin_size));
+
+  /* device y grows downwards: clip.y + (1 - domain_translate(v)) * clip.h */
+  auto domain_y_device = domain_y;
+  domain_y_device.inverted = !domain_y.inverted;
+
+  /* translate and count a range of points in fixed-size blocks */
+  auto bin_range = [&series, &domain_x, &domain_y_device, &clip] (
+      size_t begin,
+      size_t end,
+      DensityGrid* range_grid) {
+    static const size_t kBlockSize = 4096;
+    double sx[kBlockSize];
+    double sy[kBlockSize];
+
+    for (size_t i = begin; i < end; i += kBlockSize) {
+      auto n = std::min(kBlockSize, end - i);
+      domain_translate_span(domain_x, &series.xs[i], sx, n, clip.w, clip.x);
+      domain_translate_span(domain_y_device, &series.ys[i], sy, n, clip.h, clip.y);
+      density_bin(sx, sy, n, range_grid);
+    }
+  };
+
+  /* each thread counts a contiguous range into its own grid */
+  size_t thread_count = std::clamp(
+      point_count / kDensityPointsPerThread,
+      size_t(1),
+      size_t(std::max(std::thread::hardware_concurrency(), 1u)));
+
+  auto range_size = (point_count + thread_count - 1) / thread_count;
+
+  std::vector<DensityGrid> thread_grids(thread_count - 1, grid);
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < thread_count; ++t) {
+    auto begin = std::min(t * range_size, point_count);
+    auto end = std::min(begin + range_size, point_count);
+    threads.emplace_back(bin_range, begin, end, &thread_grids[t - 1]);
+  }
+
+  bin_range(0, std::min(range_size, point_count), &grid);
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (const auto& g : thread_grids) {
+    density_merge(g, &grid);
+  }
+
+  std::vector<uint32_t> pixels;
+  density_colourize(
+      grid,
+      series.density_scale,
+      series.density_colour_low,
+      series.density_colour_high,
+      &pixels);
+
+  drawBitmap(
+      layer,
+      clip,
+      Rectangle(
+          grid.rect.x,
+          grid.rect.y,
+          grid.cols * grid.bin_size,
+          grid.rows * grid.bin_size),
+      pixels.data(),
+      grid.cols,
+      grid.rows);
+
+  return OK;
+}
+
+ReturnCode drawSeries(
+    const PointchartSeries& series,
+    const DomainConfig& domain_x,
+    const DomainConfig& domain_y,
+    const Rectangle& clip,
+    Layer* layer) {
+  switch (series.mode) {
+    case PointchartMode::DENSITY:
+      return drawSeriesDensity(series, domain_x, domain_y, clip, layer);
+    case PointchartMode::MARKERS:
+    default:
+      return drawSeriesMarkers(series, domain_x, domain_y, clip, layer);
+  }
+}
+
+ReturnCode draw(
+    const PointchartConfig& config,
+    const Rectangle& clip,
+    Layer* layer) {
+  // setup domains
+  auto domain_x = config.domain_x;
+  auto domain_y = config.domain_y;
+
+  {
+    PLOTFX_PROFILE_SCOPE("domain_fit");
+    for (const auto& s : config.series) {
+      domain_fit_span(s.xs.data(), s.xs.size(), &domain_x);
+      domain_fit_span(s.ys.data(), s.ys.size(), &domain_y);
+    }
+  }
+
+  // setup layout
+  auto border_box = layout_margin_box(
+      clip,
+      to_unit(layer->measures, config.margins[0]).value,
+      to_unit(layer->measures, config.margins[1]).value,
+      to_unit(layer->measures, config.margins[2]).value,
+      to_unit(layer->measures, config.margins[3]).value);
+
+  // render axes
+  AxisDefinition axis_top;
+  if (auto rc = axis_expand_auto(config.axis_top, AxisPosition::TOP, domain_x, &axis_top); !rc) {
+    return rc;
+  }
+
+  if (auto rc = renderAxis(axis_top, border_box, AxisPosition::TOP, layer); rc) {
+    return rc;
+  }
+
+  AxisDefinition axis_right;
+  if (auto rc = axis_expand_auto(config.axis_right, AxisPosition::RIGHT, domain_y, &axis_right); !rc) {
+    return rc;
+  }
+
+  if (auto rc = renderAxis(axis_right, border_box, AxisPosition::RIGHT, layer); rc) {
+    return rc;
+  }
+
+  AxisDefinition axis_bottom;
+  if (auto rc = axis_expand_auto(config.axis_bottom, AxisPosition::BOTTOM, domain_x, &axis_bottom); !rc) {
+    return rc;
+  }
+
+  if (auto rc = renderAxis(axis_bottom, border_box, AxisPosition::BOTTOM, layer); rc) {
+    return rc;
+  }
+
+  AxisDefinition axis_left;
+  if (auto rc = axis_expand_auto(config.axis_left, AxisPosition::LEFT, domain_y, &axis_left); !rc) {
+    return rc;
+  }
+
+  if (auto rc = renderAxis(axis_left, border_box, AxisPosition::LEFT, layer); rc) {
+    return rc;
+  }
+
+  for (const auto& s : config.series) {
+    if (auto rc = drawSeries(s, domain_x, domain_y, border_box, layer); !rc) {
+      return rc;
+    }
+  }
+
+  return ReturnCode::success();
+}
+
+ReturnCode parseMarkerShapeProp(
+    const plist::Property& prop,
+    MarkerShape* value) {
+  if (prop.size() != 1) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<MarkerShape> defs = {
+    { "circle", MarkerShape::CIRCLE },
+    { "square", MarkerShape::SQUARE },
+  };
+
+  return parseEnum(defs, prop[0], value);
+}
+
+ReturnCode parseModeProp(
+    const plist::Property& prop,
+    PointchartMode* value) {
+  if (prop.size() != 1) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<PointchartMode> defs = {
+    { "markers", PointchartMode::MARKERS },
+    { "density", PointchartMode::DENSITY },
+  };
+
+  return parseEnum(defs, prop[0], value);
+}
+
+ReturnCode parseDensityScaleProp(
+    const plist::Property& prop,
+    DensityScale* value) {
+  if (prop.size() != 1) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<DensityScale> defs = {
+    { "linear", DensityScale::LINEAR },
+    { "log", DensityScale::LOG },
+  };
+
+  return parseEnum(defs, prop[0], value);
+}
+
+ReturnCode configureSeries(
+    const plist::Property& prop,
+    DataContext* ctx,
+    PointchartConfig* config) {
+  if (!prop.child) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  PointchartSeries series;
+  const ParserDefinitions pdefs = {
+    {"xs", std::bind(&configure_data_series, std::placeholders::_1, ctx, &series.xs)},
+    {"ys", std::bind(&configure_data_series, std::placeholders::_1, ctx, &series.ys)},
+    {"colour", std::bind(&configure_colour, std::placeholders::_1, &series.marker.colour)},
+    {"marker-colour", std::bind(&configure_colour, std::placeholders::_1, &series.marker.colour)},
+    {"marker-size", std::bind(&parseMeasureProp, std::placeholders::_1, &series.marker.size)},
+    {"marker-shape", std::bind(&parseMarkerShapeProp, std::placeholders::_1, &series.marker.shape)},
+    {"mode", std::bind(&parseModeProp, std::placeholders::_1, &series.mode)},
+    {"density-bin-size", std::bind(&parseMeasureProp, std::placeholders::_1, &series.density_bin_size)},
+    {"density-scale", std::bind(&parseDensityScaleProp, std::placeholders::_1, &series.density_scale)},
+    {"density-colour-low", std::bind(&configure_colour, std::placeholders::_1, &series.density_colour_low)},
+    {"density-colour-high", std::bind(&configure_colour, std::placeholders::_1, &series.density_colour_high)},
+  };
+
+  if (auto rc = parseAll(*prop.child, pdefs); !rc) {
+    return rc;
+  }
+
+  config->series.emplace_back(std::move(series));
+  return OK;
+}
+
+ReturnCode configure(
+    const plist::PropertyList& plist,
+    DataContext* ctx,
+    ElementRef* elem) {
+  PointchartConfig config;
+  const ParserDefinitions pdefs = {
+    {
+      "margin",
+      configure_multiprop({
+          std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[0]),
+          std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[1]),
+          std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[2]),
+          std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[3])
+      })
+    },
+    {"margin-top", std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[0])},
+    {"margin-right", std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[1])},
+    {"margin-bottom", std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[2])},
+    {"margin-left", std::bind(&parseMeasureProp, std::placeholders::_1, &config.margins[3])},
+    {"axis-top", std::bind(&parseAxisModeProp, std::placeholders::_1, &config.axis_top.mode)},
+    {"axis-right", std::bind(&parseAxisModeProp, std::placeholders::_1, &config.axis_right.mode)},
+    {"axis-bottom", std::bind(&parseAxisModeProp, std::placeholders::_1, &config.axis_bottom.mode)},
+    {"axis-left", std::bind(&parseAxisModeProp, std::placeholders::_1, &config.axis_left.mode)},
+    {"xdomain-padding", std::bind(&configure_float, std::placeholders::_1, &config.domain_x.padding)},
+    {"ydomain-padding", std::bind(&configure_float, std::placeholders::_1, &config.domain_y.padding)},
+    {"xmin", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_x.min)},
+    {"xmax", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_x.max)},
+    {"ymin", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_y.min)},
+    {"ymax", std::bind(&configure_float_opt, std::placeholders::_1, &config.domain_y.max)},
+    {"series", std::bind(&configureSeries, std::placeholders::_1, ctx, &config)},
+  };
+
+  if (auto rc = parseAll(plist, pdefs); !rc.isSuccess()) {
+    return rc;
+  }
+
+  auto e = std::make_unique<Element>();
+  e->draw = std::bind(&draw, config, std::placeholders::_1, std::placeholders::_2);
+  *elem = std::move(e);
+
+  return ReturnCode::success();
+}
+
+} // namespace pointchart
+} // namespace plotfx
+
@@ -0,0 +1,85 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *   Copyright (c) 2014 Paul Asmuth, Google Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <plist/plist.h>
+#include <graphics/density.h>
+#include <graphics/layer.h>
+#include <graphics/marker.h>
+#include <graphics/viewport.h>
+#include <common/domain.h>
+#include <common/element.h>
+#include "plot_axis.h"
+
+namespace plotfx {
+struct DataContext;
+
+namespace pointchart {
+
+enum class PointchartMode {
+  MARKERS,
+  DENSITY
+};
+
+struct PointchartSeries {
+  PointchartSeries();
+  std::vector<double> xs;
+  std::vector<double> ys;
+  PointchartMode mode;
+  MarkerStyle marker;
+  Measure density_bin_size;
+  DensityScale density_scale;
+  Colour density_colour_low;
+  Colour density_colour_high;
+};
+
+struct PointchartConfig {
+  PointchartConfig();
+  DomainConfig domain_x;
+  DomainConfig domain_y;
+  AxisDefinition axis_top;
+  AxisDefinition axis_right;
+  AxisDefinition axis_bottom;
+  AxisDefinition axis_left;
+  Measure margins[4];
+  std::vector<PointchartSeries> series;
+};
+
+ReturnCode draw(const PointchartConfig& config, const Rectangle& clip, Layer* frame);
+
+ReturnCode configure(
+    const plist::PropertyList& plist,
+    DataContext* ctx,
+    ElementRef* elem);
+
+} // namespace pointchart
+} // namespace plotfx
+
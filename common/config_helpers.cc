@@ -28,6 +28,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "config_helpers.h"
+#include "data/data_context.h"
+#include <charconv>
 #include <iostream>
 
 namespace plotfx {
@@ -35,20 +37,87 @@ namespace plotfx {
 ReturnCode parseDataSeries(
     const plist::Property& prop,
     std::vector<double>* data) {
-  for (const auto& v : prop.values) {
-    double value;
-    try {
-      value = std::stod(v.data);
-    } catch (... ) {
-      return ERROR_INVALID_ARGUMENT;
+  auto offset = data->size();
+  data->resize(offset + prop.values.size());
+
+  auto out = data->data() + offset;
+  for (size_t i = 0; i < prop.values.size(); ++i) {
+    const auto& v = prop.values[i].data;
+    auto ec = StringUtil::parseDouble(v.data(), v.data() + v.size(), &out[i]);
+    if (ec != std::errc()) {
+      data->resize(offset);
+      return ReturnCode::errorf(
+          "EARG",
+          ec == std::errc::result_out_of_range
+              ? "value out of range at index $0: '$1'"
+              : "invalid number at index $0: '$1'",
+          i,
+          v);
     }
-
-    data->emplace_back(value);
   }
 
   return OK;
 }
 
+bool parseFunctionCall(
+    const plist::Property& prop,
+    std::string* fn,
+    std::vector<std::string>* args) {
+  const auto& v = prop.values;
+  if (v.size() < 3 ||
+      !v[0].is_literal ||
+      !v[1].is_literal || v[1].data != "(" ||
+      !v.back().is_literal || v.back().data != ")") {
+    return false;
+  }
+
+  *fn = v[0].data;
+  args->clear();
+
+  for (size_t i = 2; i + 1 < v.size(); ++i) {
+    if (v[i].is_literal && v[i].data == ",") {
+      continue;
+    }
+
+    args->emplace_back(v[i].data);
+  }
+
+  return true;
+}
+
+ReturnCode configure_data_series(
+    const plist::Property& prop,
+    DataContext* ctx,
+    std::vector<double>* data) {
+  std::string fn;
+  std::vector<std::string> args;
+  if (!parseFunctionCall(prop, &fn, &args)) {
+    return parseDataSeries(prop, data);
+  }
+
+  if (fn == "csv") {
+    if (args.size() < 2 || args.size() > 3) {
+      return ReturnCode::errorf(
+          "EARG",
+          "csv() expects 2 or 3 arguments (file, column[, row_limit]), got: $0",
+          args.size());
+    }
+
+    auto row_limit = CSVFile::kNoRowLimit;
+    if (args.size() == 3) {
+      const auto& a = args[2];
+      auto [ptr, ec] = std::from_chars(a.data(), a.data() + a.size(), row_limit);
+      if (ec != std::errc() || ptr != a.data() + a.size()) {
+        return ReturnCode::errorf("EARG", "csv(): invalid row limit '$0'", a);
+      }
+    }
+
+    return ctx->csv.readColumn(args[0], args[1], row_limit, data);
+  }
+
+  return ReturnCode::errorf("EARG", "unknown data source: $0()", fn);
+}
+
 ReturnCode parseMeasureProp(
     const plist::Property& prop,
     Measure* value) {
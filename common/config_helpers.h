@@ -36,6 +36,7 @@
 #include "utils/return_code.h"
 
 namespace plotfx {
+struct DataContext;
 
 using ParserFn = std::function<ReturnCode (const plist::Property&)>;
 
@@ -85,6 +86,26 @@ ReturnCode parseDataSeries(
     const plist::Property& prop,
     std::vector<double>* data);
 
+/**
+ * Parse a data series property. The property may either be a list of literal
+ * values or a reference to an external data source:
+ *
+ *   csv("file.csv", "column" [, row_limit])
+ */
+ReturnCode configure_data_series(
+    const plist::Property& prop,
+    DataContext* ctx,
+    std::vector<double>* data);
+
+/**
+ * Returns true if the property value is a function call of the form
+ * `fn(arg1, arg2, ...)` and stores the function name and arguments
+ */
+bool parseFunctionCall(
+    const plist::Property& prop,
+    std::string* fn,
+    std::vector<std::string>* args);
+
 ReturnCode parseMeasureProp(
     const plist::Property& prop,
     Measure* value);
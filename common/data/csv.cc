@@ -0,0 +1,304 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "csv.h"
+#include "utils/fileutil.h"
+#include "utils/stringutil.h"
+
+namespace plotfx {
+
+static const char kCSVDelimiter = ',';
+
+/**
+ * Read the next field from the current row. Returns false if there are no
+ * more fields in the row. Quoted fields that contain escaped quotes are
+ * unescaped into `buf`; all other fields are returned as a view into the
+ * input.
+ */
+static bool readField(
+    const char** cur,
+    const char* end,
+    std::string_view* field,
+    std::string* buf,
+    bool* end_of_row) {
+  auto c = *cur;
+  if (*end_of_row) {
+    return false;
+  }
+
+  if (c < end && *c == '"') {
+    auto begin = ++c;
+    bool escaped = false;
+    for (; c < end; ++c) {
+      if (*c != '"') {
+        continue;
+      }
+
+      if (c + 1 < end && c[1] == '"') {
+        escaped = true;
+        ++c;
+        continue;
+      }
+
+      break;
+    }
+
+    if (escaped) {
+      buf->clear();
+      for (auto p = begin; p < c; ++p) {
+        buf->push_back(*p);
+        if (*p == '"') {
+          ++p;
+        }
+      }
+
+      *field = *buf;
+    } else {
+      *field = std::string_view(begin, c - begin);
+    }
+
+    if (c < end) {
+      ++c; // closing quote
+    }
+
+    /* ignore anything between the closing quote and the delimiter */
+    while (c < end && *c != kCSVDelimiter && *c != '\n' && *c != '\r') {
+      ++c;
+    }
+  } else {
+    auto begin = c;
+    while (c < end && *c != kCSVDelimiter && *c != '\n' && *c != '\r') {
+      ++c;
+    }
+
+    *field = std::string_view(begin, c - begin);
+  }
+
+  if (c < end && *c == kCSVDelimiter) {
+    ++c;
+  } else {
+    *end_of_row = true;
+  }
+
+  *cur = c;
+  return true;
+}
+
+/**
+ * Advance to the beginning of the next row
+ */
+static void skipRow(const char** cur, const char* end) {
+  std::string_view field;
+  std::string buf;
+  bool end_of_row = false;
+  while (readField(cur, end, &field, &buf, &end_of_row));
+}
+
+static void skipNewline(const char** cur, const char* end) {
+  auto c = *cur;
+  if (c < end && *c == '\r') {
+    ++c;
+  }
+
+  if (c < end && *c == '\n') {
+    ++c;
+  }
+
+  *cur = c;
+}
+
+ReturnCode CSVFile::openFile(
+    const std::string& path,
+    std::unique_ptr<CSVFile>* file) {
+  std::unique_ptr<MappedFile> mapped;
+  if (auto rc = MappedFile::openFile(path, &mapped); !rc) {
+    return rc;
+  }
+
+  std::unique_ptr<CSVFile> csv(new CSVFile(path, std::move(mapped)));
+  if (auto rc = csv->readHeader(); !rc) {
+    return rc;
+  }
+
+  *file = std::move(csv);
+  return ReturnCode::success();
+}
+
+CSVFile::CSVFile(
+    const std::string& path,
+    std::unique_ptr<MappedFile> file) :
+    path_(path),
+    file_(std::move(file)),
+    data_offset_(0) {}
+
+ReturnCode CSVFile::readHeader() {
+  auto begin = file_->data();
+  auto end = begin + file_->size();
+  auto cur = begin;
+
+  std::string_view field;
+  std::string buf;
+  bool end_of_row = false;
+  while (readField(&cur, end, &field, &buf, &end_of_row)) {
+    header_.emplace_back(field);
+  }
+
+  if (header_.empty() || (header_.size() == 1 && header_[0].empty())) {
+    return ReturnCode::errorf("EARG", "CSV file '$0' has no header row", path_);
+  }
+
+  skipNewline(&cur, end);
+  data_offset_ = cur - begin;
+  return ReturnCode::success();
+}
+
+const std::vector<std::string>& CSVFile::getHeader() const {
+  return header_;
+}
+
+ReturnCode CSVFile::readColumn(
+    const std::string& column,
+    size_t row_limit,
+    std::vector<double>* data) {
+  auto cache_key = column;
+  if (row_limit != kNoRowLimit) {
+    cache_key += "@" + std::to_string(row_limit);
+  }
+
+  if (auto cached = columns_.find(cache_key); cached != columns_.end()) {
+    data->insert(data->end(), cached->second.begin(), cached->second.end());
+    return ReturnCode::success();
+  }
+
+  size_t column_idx = 0;
+  for (; column_idx < header_.size(); ++column_idx) {
+    if (header_[column_idx] == column) {
+      break;
+    }
+  }
+
+  if (column_idx == header_.size()) {
+    return ReturnCode::errorf(
+        "EARG",
+        "CSV file '$0' has no column named '$1'",
+        path_,
+        column);
+  }
+
+  std::vector<double> values;
+  auto end = file_->data() + file_->size();
+  auto cur = file_->data() + data_offset_;
+  std::string_view field;
+  std::string buf;
+  size_t row = 0;
+  while (row < row_limit && cur < end) {
+    /* skip blank lines */
+    if (*cur == '\n' || *cur == '\r') {
+      skipNewline(&cur, end);
+      continue;
+    }
+
+    ++row;
+
+    bool end_of_row = false;
+    size_t idx = 0;
+    bool found = false;
+    while (readField(&cur, end, &field, &buf, &end_of_row)) {
+      if (idx++ == column_idx) {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found) {
+      return ReturnCode::errorf(
+          "EARG",
+          "CSV file '$0', row $1: missing column '$2'",
+          path_,
+          row,
+          column);
+    }
+
+    double value;
+    auto ec = StringUtil::parseDouble(
+        field.data(),
+        field.data() + field.size(),
+        &value);
+
+    if (ec != std::errc()) {
+      return ReturnCode::errorf(
+          "EARG",
+          "CSV file '$0', row $1, column '$2': invalid number '$3'",
+          path_,
+          row,
+          column,
+          std::string(field));
+    }
+
+    values.emplace_back(value);
+
+    if (!end_of_row) {
+      skipRow(&cur, end);
+    }
+
+    skipNewline(&cur, end);
+  }
+
+  data->insert(data->end(), values.begin(), values.end());
+  columns_.emplace(cache_key, std::move(values));
+  return ReturnCode::success();
+}
+
+void CSVCache::setBasePath(const std::string& base_path) {
+  base_path_ = base_path;
+}
+
+ReturnCode CSVCache::readColumn(
+    const std::string& path,
+    const std::string& column,
+    size_t row_limit,
+    std::vector<double>* data) {
+  auto file_path = path;
+  if (!base_path_.empty() && !StringUtil::beginsWith(path, "/")) {
+    file_path = FileUtil::joinPaths(base_path_, path);
+  }
+
+  auto& file = files_[file_path];
+  if (!file) {
+    if (auto rc = CSVFile::openFile(file_path, &file); !rc) {
+      files_.erase(file_path);
+      return rc;
+    }
+  }
+
+  return file->readColumn(column, row_limit, data);
+}
+
+} // namespace plotfx
+
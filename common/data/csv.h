@@ -0,0 +1,109 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "utils/mapped_file.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+
+/**
+ * A memory-mapped CSV file with a header row. Columns are parsed on demand in
+ * a single forward pass over the mapped data; all other fields of a row are
+ * skipped without being converted or copied. Parsed columns are kept so that
+ * repeated requests for the same column do not re-read the file.
+ */
+class CSVFile {
+public:
+
+  static const size_t kNoRowLimit = size_t(-1);
+
+  static ReturnCode openFile(
+      const std::string& path,
+      std::unique_ptr<CSVFile>* file);
+
+  /**
+   * Parse the numeric column with the given header name, stopping after
+   * row_limit data rows
+   */
+  ReturnCode readColumn(
+      const std::string& column,
+      size_t row_limit,
+      std::vector<double>* data);
+
+  const std::vector<std::string>& getHeader() const;
+
+protected:
+
+  CSVFile(
+      const std::string& path,
+      std::unique_ptr<MappedFile> file);
+
+  ReturnCode readHeader();
+
+  std::string path_;
+  std::unique_ptr<MappedFile> file_;
+  std::vector<std::string> header_;
+  size_t data_offset_;
+  std::unordered_map<std::string, std::vector<double>> columns_;
+};
+
+/**
+ * Keeps every CSV file referenced from a spec open (and its parsed columns
+ * cached) for the duration of one element tree build
+ */
+class CSVCache {
+public:
+
+  /**
+   * Set the directory that relative file paths are resolved against (usually
+   * the directory of the spec file). By default relative paths are resolved
+   * against the working directory
+   */
+  void setBasePath(const std::string& base_path);
+
+  ReturnCode readColumn(
+      const std::string& path,
+      const std::string& column,
+      size_t row_limit,
+      std::vector<double>* data);
+
+protected:
+  std::string base_path_;
+  std::unordered_map<std::string, std::unique_ptr<CSVFile>> files_;
+};
+
+} // namespace plotfx
+
@@ -27,8 +27,14 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <limits>
 #include "domain.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#define PLOTFX_DOMAIN_X86 1
+#include <immintrin.h>
+#endif
+
 namespace plotfx {
 
 DomainConfig::DomainConfig() :
@@ -36,16 +42,224 @@ DomainConfig::DomainConfig() :
     inverted(false),
     padding(0.0f) {}
 
+using MinMaxKernel = void (*)(const double*, size_t, double*, double*);
+
+using TranslateKernel = void (*)(
+    const double*,
+    double*,
+    size_t,
+    double,
+    double,
+    bool,
+    double,
+    double);
+
+/* NaN values compare false and are skipped */
+static void minmax_scalar(
+    const double* data,
+    size_t size,
+    double* min,
+    double* max) {
+  auto vmin = *min;
+  auto vmax = *max;
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] < vmin) {
+      vmin = data[i];
+    }
+    if (data[i] > vmax) {
+      vmax = data[i];
+    }
+  }
+
+  *min = vmin;
+  *max = vmax;
+}
+
+/*
+ * out = offset + vt * scale with vt = (in - min) / range, or 1 - vt if
+ * inverted. This is exactly the sequence of operations of domain_translate,
+ * so span and per-point callers land on the same pixels
+ */
+static void translate_scalar(
+    const double* in,
+    double* out,
+    size_t size,
+    double min,
+    double range,
+    bool inverted,
+    double scale,
+    double offset) {
+  for (size_t i = 0; i < size; ++i) {
+    auto vt = (in[i] - min) / range;
+    if (inverted) {
+      vt = 1.0 - vt;
+    }
+
+    out[i] = offset + vt * scale;
+  }
+}
+
+#ifdef PLOTFX_DOMAIN_X86
+
+/*
+ * minpd/maxpd return the second operand if either operand is NaN, so passing
+ * the accumulator second skips NaN inputs just like the scalar kernel
+ */
+__attribute__((target("sse2")))
+static void minmax_sse2(
+    const double* data,
+    size_t size,
+    double* min,
+    double* max) {
+  auto vmin = _mm_set1_pd(*min);
+  auto vmax = _mm_set1_pd(*max);
+
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    auto v = _mm_loadu_pd(data + i);
+    vmin = _mm_min_pd(v, vmin);
+    vmax = _mm_max_pd(v, vmax);
+  }
+
+  double rmin[2];
+  double rmax[2];
+  _mm_storeu_pd(rmin, vmin);
+  _mm_storeu_pd(rmax, vmax);
+  *min = std::min(rmin[0], rmin[1]);
+  *max = std::max(rmax[0], rmax[1]);
+  minmax_scalar(data + i, size - i, min, max);
+}
+
+__attribute__((target("sse2")))
+static void translate_sse2(
+    const double* in,
+    double* out,
+    size_t size,
+    double min,
+    double range,
+    bool inverted,
+    double scale,
+    double offset) {
+  auto vmin = _mm_set1_pd(min);
+  auto vrange = _mm_set1_pd(range);
+  auto vscale = _mm_set1_pd(scale);
+  auto voffset = _mm_set1_pd(offset);
+  auto one = _mm_set1_pd(1.0);
+
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    auto vt = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(in + i), vmin), vrange);
+    if (inverted) {
+      vt = _mm_sub_pd(one, vt);
+    }
+
+    _mm_storeu_pd(out + i, _mm_add_pd(voffset, _mm_mul_pd(vt, vscale)));
+  }
+
+  translate_scalar(in + i, out + i, size - i, min, range, inverted, scale, offset);
+}
+
+__attribute__((target("avx2")))
+static void minmax_avx2(
+    const double* data,
+    size_t size,
+    double* min,
+    double* max) {
+  auto vmin = _mm256_set1_pd(*min);
+  auto vmax = _mm256_set1_pd(*max);
+
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    auto v = _mm256_loadu_pd(data + i);
+    vmin = _mm256_min_pd(v, vmin);
+    vmax = _mm256_max_pd(v, vmax);
+  }
+
+  double rmin[4];
+  double rmax[4];
+  _mm256_storeu_pd(rmin, vmin);
+  _mm256_storeu_pd(rmax, vmax);
+  *min = std::min(std::min(rmin[0], rmin[1]), std::min(rmin[2], rmin[3]));
+  *max = std::max(std::max(rmax[0], rmax[1]), std::max(rmax[2], rmax[3]));
+  minmax_scalar(data + i, size - i, min, max);
+}
+
+/* no FMA here; the result must match the scalar kernel exactly */
+__attribute__((target("avx2")))
+static void translate_avx2(
+    const double* in,
+    double* out,
+    size_t size,
+    double min,
+    double range,
+    bool inverted,
+    double scale,
+    double offset) {
+  auto vmin = _mm256_set1_pd(min);
+  auto vrange = _mm256_set1_pd(range);
+  auto vscale = _mm256_set1_pd(scale);
+  auto voffset = _mm256_set1_pd(offset);
+  auto one = _mm256_set1_pd(1.0);
+
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    auto vt = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(in + i), vmin), vrange);
+    if (inverted) {
+      vt = _mm256_sub_pd(one, vt);
+    }
+
+    _mm256_storeu_pd(out + i, _mm256_add_pd(voffset, _mm256_mul_pd(vt, vscale)));
+  }
+
+  translate_scalar(in + i, out + i, size - i, min, range, inverted, scale, offset);
+}
+
+#endif
+
+static MinMaxKernel getMinMaxKernel() {
+#ifdef PLOTFX_DOMAIN_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return &minmax_avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return &minmax_sse2;
+  }
+#endif
+  return &minmax_scalar;
+}
+
+static TranslateKernel getTranslateKernel() {
+#ifdef PLOTFX_DOMAIN_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return &translate_avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return &translate_sse2;
+  }
+#endif
+  return &translate_scalar;
+}
+
 void domain_fit(const std::vector<double>& data, DomainConfig* domain) {
+  domain_fit_span(data.data(), data.size(), domain);
+}
+
+void domain_fit_span(const double* data, size_t size, DomainConfig* domain) {
+  static const auto kernel = getMinMaxKernel();
+
   bool fit_min = !domain->min;
   bool fit_max = !domain->max;
 
-  for (const auto& d : data) {
-    if (fit_min && (!domain->min || *domain->min > d)) {
-      domain->min = std::optional<double>(d);
+  if (fit_min || fit_max) {
+    auto min = std::numeric_limits<double>::infinity();
+    auto max = -std::numeric_limits<double>::infinity();
+    kernel(data, size, &min, &max);
+
+    if (fit_min && min <= max) {
+      domain->min = std::optional<double>(min);
     }
-    if (fit_max && (!domain->max || *domain->max < d)) {
-      domain->max = std::optional<double>(d);
+    if (fit_max && min <= max) {
+      domain->max = std::optional<double>(max);
     }
   }
 
@@ -79,6 +293,25 @@ double domain_translate(const DomainConfig& domain, double v) {
   return vt;
 }
 
+void domain_translate_span(
+    const DomainConfig& domain,
+    const double* in,
+    double* out,
+    size_t size,
+    double scale,
+    double offset) {
+  static const auto kernel = getTranslateKernel();
+
+  auto min = domain.min.value_or(0.0f);
+  auto max = domain.max.value_or(0.0f);
+
+  switch (domain.kind) {
+    case DomainKind::LINEAR:
+      kernel(in, out, size, min, max - min, domain.inverted, scale, offset);
+      break;
+  }
+}
+
 double domain_untranslate(const DomainConfig& domain, double vt) {
   auto min = domain.min.value_or(0.0f);
   auto max = domain.max.value_or(0.0f);
@@ -54,8 +54,31 @@ struct DomainConfig {
 
 void domain_fit(const std::vector<double>& data, DomainConfig* domain);
 
+/**
+ * Same as domain_fit, but operates on a contiguous span of values. NaN values
+ * are ignored. Uses SSE2/AVX2 min/max kernels where the CPU supports them.
+ */
+void domain_fit_span(const double* data, size_t size, DomainConfig* domain);
+
 double domain_translate(const DomainConfig& domain, double v);
 
+/**
+ * Translate a span of values into the domain and map the result onto an
+ * output range in one pass:
+ *
+ *   out[i] = offset + domain_translate(domain, in[i]) * scale
+ *
+ * The in and out spans may be identical. All kernels (scalar, SSE2, AVX2)
+ * produce bit-identical results.
+ */
+void domain_translate_span(
+    const DomainConfig& domain,
+    const double* in,
+    double* out,
+    size_t size,
+    double scale = 1.0,
+    double offset = 0.0);
+
 double domain_untranslate(const DomainConfig& domain, double v);
 
 namespace chart {
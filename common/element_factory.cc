@@ -29,26 +29,32 @@
  */
 #include "element_factory.h"
 #include "charts/line_chart.h"
+#include "charts/point_chart.h"
 #include <unordered_map>
 
 namespace plotfx {
 
-using ElementConfigureFn = std::function<ReturnCode (const PropertyList&, ElementRef*)>;
+using ElementConfigureFn = std::function<ReturnCode (
+    const PropertyList&,
+    DataContext*,
+    ElementRef*)>;
 
 static std::unordered_map<std::string, ElementConfigureFn> elems = {
-  {"linechart", &linechart::configure}
+  {"linechart", &linechart::configure},
+  {"pointchart", &pointchart::configure},
 };
 
 ReturnCode buildElement(
     const std::string& name,
     const PropertyList& plist,
+    DataContext* ctx,
     std::unique_ptr<Element>* elem) {
   const auto& elem_entry = elems.find(name);
   if (elem_entry == elems.end()) {
     return ReturnCode::errorf("NOTFOUND", "no such element: $0", name);
   }
 
-  return elem_entry->second(plist, elem);
+  return elem_entry->second(plist, ctx, elem);
 }
 
 } // namespace plotfx
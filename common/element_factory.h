@@ -32,10 +32,12 @@
 #include "element.h"
 
 namespace plotfx {
+struct DataContext;
 
 ReturnCode buildElement(
     const std::string& name,
     const plist::PropertyList& plist,
+    DataContext* ctx,
     std::unique_ptr<Element>* elem);
 
 } // namespace plotfx
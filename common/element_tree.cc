@@ -30,20 +30,27 @@
 #include "plist/plist_parser.h"
 #include "element_factory.h"
 #include "element_tree.h"
+#include "data/data_context.h"
 #include "graphics/layer.h"
 #include "graphics/layout.h"
+#include "graphics/display_list.h"
+#include "graphics/tiled_render.h"
+#include "utils/profile.h"
 
 namespace plotfx {
 
 ReturnCode buildElementTree(
     const PropertyList& plist,
-    ElementTree* tree) {
+    ElementTree* tree,
+    const std::string& base_path) {
+  DataContext ctx;
+  ctx.csv.setBasePath(base_path);
   for (size_t i = 0; i < plist.size(); ++i) {
     const auto& elem_name = plist[i].name;
     const auto& elem_config = plist[i].child.get();
 
     std::unique_ptr<Element> elem;
-    if (auto rc = buildElement(elem_name, *elem_config, &elem); !rc.isSuccess()) {
+    if (auto rc = buildElement(elem_name, *elem_config, &ctx, &elem); !rc.isSuccess()) {
       return rc;
     }
 
@@ -54,10 +61,13 @@ ReturnCode buildElementTree(
 }
 
 ReturnCode buildElementTree(
-    const std::string& spec,
-    ElementTree* tree) {
+    std::string_view spec,
+    ElementTree* tree,
+    const std::string& base_path) {
+  PLOTFX_PROFILE_SCOPE("buildElementTree");
+
   PropertyList plist;
-  plist::PropertyListParser plist_parser(spec.data(), spec.size());
+  plist::PropertyListParser plist_parser(spec);
   if (!plist_parser.parse(&plist)) {
     return ReturnCode::errorf(
         "EPARSE",
@@ -65,12 +75,14 @@ ReturnCode buildElementTree(
         plist_parser.get_error());
   }
 
-  return buildElementTree(plist, tree);
+  return buildElementTree(plist, tree, base_path);
 }
 
 ReturnCode renderElements(
     const ElementTree& tree,
     Layer* frame) {
+  PLOTFX_PROFILE_SCOPE("renderElements");
+
   Rectangle clip(0, 0, frame->width, frame->height);
 
   for (const auto& e : tree.roots) {
@@ -82,6 +94,30 @@ ReturnCode renderElements(
   return ReturnCode::success();
 }
 
+ReturnCode renderElements(
+    const ElementTree& tree,
+    Layer* frame,
+    size_t thread_count) {
+  if (thread_count <= 1) {
+    return renderElements(tree, frame);
+  }
+
+  DisplayList display_list;
+  frame->rasterizer.beginRecording(&display_list);
+  auto rc = renderElements(tree, frame);
+  frame->rasterizer.endRecording();
+
+  if (!rc.isSuccess()) {
+    return rc;
+  }
+
+  PLOTFX_PROFILE_SCOPE("rasterizeTiled");
+  if (auto rc = rasterizeTiled(display_list, &frame->rasterizer, thread_count); rc != OK) {
+    return rc;
+  }
+
+  return ReturnCode::success();
+}
 
 } // namespace plotfx
 
@@ -28,6 +28,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include <string>
+#include <string_view>
 #include "utils/return_code.h"
 #include "element.h"
 
@@ -38,17 +40,34 @@ struct ElementTree {
   std::vector<ElementRef> roots;
 };
 
+/**
+ * Build the element tree. Relative file paths in the spec (e.g. csv()
+ * references) are resolved against `base_path`, usually the directory of the
+ * spec file; if it is empty they are resolved against the working directory
+ */
 ReturnCode buildElementTree(
     const PropertyList& plist,
-    ElementTree* tree);
+    ElementTree* tree,
+    const std::string& base_path = std::string());
 
 ReturnCode buildElementTree(
-    const std::string& spec,
-    ElementTree* tree);
+    std::string_view spec,
+    ElementTree* tree,
+    const std::string& base_path = std::string());
 
 ReturnCode renderElements(
     const ElementTree& tree,
     Layer* frame);
 
+/**
+ * Render the tree using tiled rasterization on `thread_count` threads. The
+ * draw calls are recorded once and then replayed into horizontal bands of
+ * the frame in parallel, each clipped to its rows
+ */
+ReturnCode renderElements(
+    const ElementTree& tree,
+    Layer* frame,
+    size_t thread_count);
+
 } // namespace plotfx
 
@@ -62,6 +62,14 @@ void strokePath(
   layer->rasterizer.strokePath(clip, point_data, point_count, style);
 }
 
+void strokePath(
+    Layer* layer,
+    const Rectangle& clip,
+    const CompactPath& path,
+    const StrokeStyle& style) {
+  layer->rasterizer.strokePath(clip, path, style);
+}
+
 void strokeLine(
     Layer* layer,
     double x1,
@@ -79,5 +87,57 @@ void strokeLine(
   strokePath(layer, clip, p.data(), p.size(), style);
 }
 
+void strokeSegments(
+    Layer* layer,
+    const Rectangle& clip,
+    const StrokeSegment* segments,
+    size_t segment_count,
+    const StrokeStyle& style) {
+  if (segment_count == 0) {
+    return;
+  }
+
+  Path p;
+  p.reserve(segment_count * 2);
+  for (size_t i = 0; i < segment_count; ++i) {
+    const auto& s = segments[i];
+    p.moveTo(s.x1, s.y1);
+    p.lineTo(s.x2, s.y2);
+  }
+
+  strokePath(layer, clip, p.data(), p.size(), style);
+}
+
+void strokeSegments(
+    Layer* layer,
+    const std::vector<StrokeSegment>& segments,
+    const StrokeStyle& style) {
+  strokeSegments(
+      layer,
+      Rectangle(0, 0, layer->width, layer->height),
+      segments.data(),
+      segments.size(),
+      style);
+}
+
+void drawMarkers(
+    Layer* layer,
+    const Rectangle& clip,
+    const MarkerStyle& style,
+    const double* coords,
+    size_t count) {
+  layer->rasterizer.drawMarkers(clip, style, coords, count);
+}
+
+void drawBitmap(
+    Layer* layer,
+    const Rectangle& clip,
+    const Rectangle& rect,
+    const uint32_t* pixels,
+    uint32_t width,
+    uint32_t height) {
+  layer->rasterizer.drawBitmap(clip, rect, pixels, width, height);
+}
+
 } // namespace plotfx
 
@@ -31,10 +31,13 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <vector>
 #include "colour.h"
 #include "path.h"
+#include "compact_path.h"
 #include "measure.h"
 #include "layout.h"
+#include "marker.h"
 
 namespace plotfx {
 class Layer;
@@ -55,6 +58,13 @@ struct StrokeStyle {
   Colour colour;
 };
 
+struct StrokeSegment {
+  double x1;
+  double y1;
+  double x2;
+  double y2;
+};
+
 void strokePath(
     Layer* layer,
     const Path& path,
@@ -73,6 +83,12 @@ void strokePath(
     size_t path_data_count,
     const StrokeStyle& style);
 
+void strokePath(
+    Layer* layer,
+    const Rectangle& clip,
+    const CompactPath& path,
+    const StrokeStyle& style);
+
 void strokeLine(
     Layer* layer,
     double x1,
@@ -81,5 +97,44 @@ void strokeLine(
     double y2,
     const StrokeStyle& style);
 
+/**
+ * Stroke a number of independent line segments with the same style. The
+ * segments are drawn as the subpaths of a single path, i.e. using one stroke
+ * operation instead of one per segment
+ */
+void strokeSegments(
+    Layer* layer,
+    const Rectangle& clip,
+    const StrokeSegment* segments,
+    size_t segment_count,
+    const StrokeStyle& style);
+
+void strokeSegments(
+    Layer* layer,
+    const std::vector<StrokeSegment>& segments,
+    const StrokeStyle& style);
+
+/**
+ * Draw one marker centered at each point. The points are given as interleaved
+ * x/y pairs
+ */
+void drawMarkers(
+    Layer* layer,
+    const Rectangle& clip,
+    const MarkerStyle& style,
+    const double* coords,
+    size_t count);
+
+/**
+ * Draw a bitmap of premultiplied ARGB32 pixels scaled to fill the rectangle
+ */
+void drawBitmap(
+    Layer* layer,
+    const Rectangle& clip,
+    const Rectangle& rect,
+    const uint32_t* pixels,
+    uint32_t width,
+    uint32_t height);
+
 } // namespace plotfx
 
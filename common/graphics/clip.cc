@@ -0,0 +1,276 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include "clip.h"
+
+namespace plotfx {
+
+/* cairo's default miter limit */
+static const double kMiterLimit = 10;
+
+Rectangle clip_rect_intersect(const Rectangle& a, const Rectangle& b) {
+  auto x0 = std::max(a.x, b.x);
+  auto y0 = std::max(a.y, b.y);
+  auto x1 = std::min(a.x + a.w, b.x + b.w);
+  auto y1 = std::min(a.y + a.h, b.y + b.h);
+  return Rectangle(x0, y0, std::max(x1 - x0, 0.0), std::max(y1 - y0, 0.0));
+}
+
+double clip_stroke_margin(double line_width) {
+  return line_width * kMiterLimit * 0.5 + 1;
+}
+
+/* Liang-Barsky: find the parameter range [t0, t1] of the segment that lies
+ * inside the rectangle */
+static bool clip_line_param(
+    const Rectangle& clip,
+    double x0,
+    double y0,
+    double dx,
+    double dy,
+    double* t0,
+    double* t1) {
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {
+    x0 - clip.x,
+    clip.x + clip.w - x0,
+    y0 - clip.y,
+    clip.y + clip.h - y0
+  };
+
+  *t0 = 0;
+  *t1 = 1;
+  for (size_t i = 0; i < 4; ++i) {
+    if (p[i] == 0) {
+      if (q[i] < 0) {
+        return false;
+      }
+
+      continue;
+    }
+
+    auto r = q[i] / p[i];
+    if (p[i] < 0) {
+      if (r > *t1) {
+        return false;
+      }
+
+      *t0 = std::max(*t0, r);
+    } else {
+      if (r < *t0) {
+        return false;
+      }
+
+      *t1 = std::min(*t1, r);
+    }
+  }
+
+  return true;
+}
+
+bool clip_line_segment(
+    const Rectangle& clip,
+    double* x0,
+    double* y0,
+    double* x1,
+    double* y1) {
+  auto dx = *x1 - *x0;
+  auto dy = *y1 - *y0;
+
+  double t0;
+  double t1;
+  if (!clip_line_param(clip, *x0, *y0, dx, dy, &t0, &t1)) {
+    return false;
+  }
+
+  *x1 = *x0 + t1 * dx;
+  *y1 = *y0 + t1 * dy;
+  *x0 += t0 * dx;
+  *y0 += t0 * dy;
+  return true;
+}
+
+static bool clip_contains(const Rectangle& clip, double x, double y) {
+  return
+      x >= clip.x &&
+      x <= clip.x + clip.w &&
+      y >= clip.y &&
+      y <= clip.y + clip.h;
+}
+
+namespace {
+
+struct PathDataCursor {
+  const PathData* data;
+  size_t size;
+  size_t pos;
+
+  bool next(PathCommand* cmd, double* x, double* y) {
+    if (pos == size) {
+      return false;
+    }
+
+    const auto& d = data[pos++];
+    *cmd = d.command;
+    if (d.command == PathCommand::MOVE_TO || d.command == PathCommand::LINE_TO) {
+      *x = d[0];
+      *y = d[1];
+    }
+
+    return true;
+  }
+};
+
+struct CompactPathCursor {
+  const CompactPath* path;
+  size_t pos;
+  size_t coord;
+
+  bool next(PathCommand* cmd, double* x, double* y) {
+    if (pos == path->size()) {
+      return false;
+    }
+
+    *cmd = path->command(pos++);
+    if (*cmd == PathCommand::MOVE_TO || *cmd == PathCommand::LINE_TO) {
+      *x = path->coords()[coord++];
+      *y = path->coords()[coord++];
+    }
+
+    return true;
+  }
+};
+
+} // namespace
+
+template <typename Cursor, typename PathType>
+static bool clip_polyline_impl(
+    const Rectangle& clip,
+    const Cursor& begin,
+    PathType* out) {
+  PathCommand cmd;
+  double x = 0;
+  double y = 0;
+
+  /* the common case: nothing to clip, keep the path as it is. Paths that
+   * are not polylines are never clipped */
+  {
+    auto cursor = begin;
+    bool inside = true;
+    while (cursor.next(&cmd, &x, &y)) {
+      if (cmd != PathCommand::MOVE_TO && cmd != PathCommand::LINE_TO) {
+        return false;
+      }
+
+      inside = inside && clip_contains(clip, x, y);
+    }
+
+    if (inside) {
+      return false;
+    }
+  }
+
+  out->clear();
+
+  double cx = 0;
+  double cy = 0;
+  bool has_point = false;
+  bool pen_down = false;
+  for (auto cursor = begin; cursor.next(&cmd, &x, &y); ) {
+    switch (cmd) {
+
+      case PathCommand::LINE_TO:
+        if (has_point) {
+          auto dx = x - cx;
+          auto dy = y - cy;
+
+          double t0;
+          double t1;
+          /* segments that only touch the border are dropped, zero-length
+           * segments (dots) are kept */
+          auto visible =
+              clip_line_param(clip, cx, cy, dx, dy, &t0, &t1) &&
+              (t0 < t1 || (dx == 0 && dy == 0));
+
+          if (visible) {
+            if (!pen_down || t0 > 0) {
+              out->moveTo(cx + t0 * dx, cy + t0 * dy);
+            }
+
+            out->lineTo(cx + t1 * dx, cy + t1 * dy);
+            pen_down = t1 >= 1;
+          } else {
+            pen_down = false;
+          }
+
+          cx = x;
+          cy = y;
+          break;
+        }
+
+        /* a lineto without a current point acts as a moveto */
+        [[fallthrough]];
+
+      case PathCommand::MOVE_TO:
+        cx = x;
+        cy = y;
+        has_point = true;
+        pen_down = false;
+        break;
+
+      default:
+        /* rejected by the scan above */
+        break;
+
+    }
+  }
+
+  return true;
+}
+
+bool clip_polyline(
+    const Rectangle& clip,
+    const PathData* path_data,
+    size_t path_data_count,
+    Path* out) {
+  return clip_polyline_impl(
+      clip,
+      PathDataCursor{path_data, path_data_count, 0},
+      out);
+}
+
+bool clip_polyline(
+    const Rectangle& clip,
+    const CompactPath& path,
+    CompactPath* out) {
+  return clip_polyline_impl(clip, CompactPathCursor{&path, 0, 0}, out);
+}
+
+} // namespace plotfx
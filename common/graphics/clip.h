@@ -0,0 +1,87 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include "compact_path.h"
+#include "layout.h"
+#include "path.h"
+
+namespace plotfx {
+
+/**
+ * Return the intersection of two rectangles. Disjoint rectangles result in
+ * a rectangle with zero width and/or height
+ */
+Rectangle clip_rect_intersect(const Rectangle& a, const Rectangle& b);
+
+/**
+ * Return the largest distance from its centerline that a stroke of the given
+ * width can cover with cairo's default miter joins. Pre-clipping a path
+ * against a rectangle grown by this margin leaves the stroke unchanged
+ * inside the rectangle
+ */
+double clip_stroke_margin(double line_width);
+
+/**
+ * Clip the line segment (x0, y0) - (x1, y1) against the rectangle using the
+ * Liang-Barsky algorithm. Returns false if the segment lies completely
+ * outside of the rectangle, otherwise the end points are moved onto the
+ * rectangle's border where required
+ */
+bool clip_line_segment(
+    const Rectangle& clip,
+    double* x0,
+    double* y0,
+    double* x1,
+    double* y1);
+
+/**
+ * Clip a polyline path (only MOVE_TO/LINE_TO commands) against the
+ * rectangle. Segments that leave and re-enter the rectangle start a new
+ * subpath.
+ *
+ * Returns false, without touching `out`, if all points already lie inside
+ * the rectangle or if the path contains any other command (curves, arcs and
+ * closes are left for the caller to draw unclipped); otherwise the clipped
+ * path is written to `out`
+ */
+bool clip_polyline(
+    const Rectangle& clip,
+    const PathData* path_data,
+    size_t path_data_count,
+    Path* out);
+
+bool clip_polyline(
+    const Rectangle& clip,
+    const CompactPath& path,
+    CompactPath* out);
+
+} // namespace plotfx
+
@@ -0,0 +1,119 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include "path.h"
+
+namespace plotfx {
+
+/**
+ * A path made of MOVE_TO, LINE_TO and CLOSE commands only, stored as
+ * separate command and coordinate arrays with float32 device space
+ * coordinates. Takes 9 bytes per point compared to sizeof(PathData) for a
+ * Path, which matters for series with millions of points
+ */
+class CompactPath {
+public:
+
+  CompactPath();
+
+  /**
+   * Create an empty path with room for size_hint points
+   */
+  explicit CompactPath(size_t size_hint);
+
+  void moveTo(float x, float y);
+  void lineTo(float x, float y);
+  void closePath();
+
+  void reserve(size_t size);
+  void clear();
+
+  /**
+   * Number of commands
+   */
+  size_t size() const;
+  bool empty() const;
+
+  PathCommand command(size_t idx) const;
+
+  /**
+   * The command array (PathCommand values) and the coordinate array, which
+   * holds one (x, y) pair for each MOVE_TO and LINE_TO command in order
+   */
+  const uint8_t* commands() const;
+  const float* coords() const;
+  size_t coordCount() const;
+
+protected:
+  std::vector<uint8_t> commands_;
+  std::vector<float> coords_;
+};
+
+inline void CompactPath::moveTo(float x, float y) {
+  commands_.push_back(static_cast<uint8_t>(PathCommand::MOVE_TO));
+  coords_.push_back(x);
+  coords_.push_back(y);
+}
+
+inline void CompactPath::lineTo(float x, float y) {
+  commands_.push_back(static_cast<uint8_t>(PathCommand::LINE_TO));
+  coords_.push_back(x);
+  coords_.push_back(y);
+}
+
+inline size_t CompactPath::size() const {
+  return commands_.size();
+}
+
+inline bool CompactPath::empty() const {
+  return commands_.empty();
+}
+
+inline PathCommand CompactPath::command(size_t idx) const {
+  return static_cast<PathCommand>(commands_[idx]);
+}
+
+inline const uint8_t* CompactPath::commands() const {
+  return commands_.data();
+}
+
+inline const float* CompactPath::coords() const {
+  return coords_.data();
+}
+
+inline size_t CompactPath::coordCount() const {
+  return coords_.size();
+}
+
+} // namespace plotfx
+
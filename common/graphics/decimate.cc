@@ -0,0 +1,75 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include "decimate.h"
+
+namespace plotfx {
+
+DecimatorM4::DecimatorM4(
+    CompactPath* path) :
+    path_(path),
+    count_(0),
+    emitted_(0),
+    column_open_(false),
+    column_(0) {}
+
+void DecimatorM4::emit(const Vertex& v) {
+  if (emitted_++ == 0) {
+    path_->moveTo(v.x, v.y);
+  } else {
+    path_->lineTo(v.x, v.y);
+  }
+}
+
+void DecimatorM4::flush() {
+  if (!column_open_) {
+    return;
+  }
+
+  column_open_ = false;
+
+  /* emit first, min, max and last in index order, skipping duplicates */
+  Vertex vertices[4] = { first_, min_, max_, last_ };
+  std::sort(
+      vertices,
+      vertices + 4,
+      [] (const Vertex& a, const Vertex& b) { return a.idx < b.idx; });
+
+  for (size_t i = 0; i < 4; ++i) {
+    if (i > 0 && vertices[i].idx == vertices[i - 1].idx) {
+      continue;
+    }
+
+    emit(vertices[i]);
+  }
+}
+
+} // namespace plotfx
+
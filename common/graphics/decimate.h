@@ -0,0 +1,113 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <math.h>
+#include <stdlib.h>
+#include "compact_path.h"
+
+namespace plotfx {
+
+enum class DecimationMode {
+  AUTO,
+  OFF
+};
+
+/**
+ * Streaming M4 decimation of a polyline in device space: for each run of
+ * consecutive points that fall into the same pixel column, only the first,
+ * last, minimum and maximum point are kept (in their original order). This
+ * bounds the output to at most four vertices per pixel column while
+ * preserving the extent of the line in each column. The output is not pixel
+ * exact: with anti-aliasing and thick strokes the joins at dropped interior
+ * vertices can differ at the sub-pixel level, so decimation is opt-in.
+ *
+ * Points are appended to the target path; the first emitted point starts a
+ * new subpath.
+ */
+class DecimatorM4 {
+public:
+
+  DecimatorM4(CompactPath* path);
+
+  void addPoint(double x, double y);
+
+  /**
+   * Emit the points of the last open column. Must be called after the last
+   * addPoint call
+   */
+  void flush();
+
+protected:
+
+  struct Vertex {
+    size_t idx;
+    double x;
+    double y;
+  };
+
+  void emit(const Vertex& v);
+
+  CompactPath* path_;
+  size_t count_;
+  size_t emitted_;
+  bool column_open_;
+  double column_;
+  Vertex first_;
+  Vertex last_;
+  Vertex min_;
+  Vertex max_;
+};
+
+inline void DecimatorM4::addPoint(double x, double y) {
+  Vertex v = { count_++, x, y };
+  auto column = floor(x);
+
+  if (column_open_ && column == column_) {
+    last_ = v;
+    if (y < min_.y) {
+      min_ = v;
+    }
+    if (y > max_.y) {
+      max_ = v;
+    }
+    return;
+  }
+
+  flush();
+  column_open_ = true;
+  column_ = column;
+  first_ = v;
+  last_ = v;
+  min_ = v;
+  max_ = v;
+}
+
+} // namespace plotfx
+
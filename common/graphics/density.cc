@@ -0,0 +1,150 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <math.h>
+#include <algorithm>
+#include "density.h"
+
+namespace plotfx {
+
+DensityGrid::DensityGrid() :
+    bin_size(1),
+    cols(0),
+    rows(0) {}
+
+DensityGrid::DensityGrid(
+    const Rectangle& r,
+    double b) :
+    rect(r),
+    bin_size(std::max(b, 1.0)),
+    cols(uint32_t(ceil(std::max(r.w, 0.0) / bin_size))),
+    rows(uint32_t(ceil(std::max(r.h, 0.0) / bin_size))),
+    counts(size_t(cols) * rows, 0) {}
+
+void density_bin(
+    const double* xs,
+    const double* ys,
+    size_t count,
+    DensityGrid* grid) {
+  auto scale = 1.0 / grid->bin_size;
+  auto cols = grid->cols;
+  auto rows = grid->rows;
+  auto counts = grid->counts.data();
+
+  for (size_t i = 0; i < count; ++i) {
+    auto fx = (xs[i] - grid->rect.x) * scale;
+    auto fy = (ys[i] - grid->rect.y) * scale;
+
+    /* also rejects NaN */
+    if (!(fx >= 0 && fx < cols && fy >= 0 && fy < rows)) {
+      continue;
+    }
+
+    ++counts[size_t(fy) * cols + size_t(fx)];
+  }
+}
+
+void density_merge(const DensityGrid& other, DensityGrid* grid) {
+  auto n = std::min(grid->counts.size(), other.counts.size());
+  for (size_t i = 0; i < n; ++i) {
+    grid->counts[i] += other.counts[i];
+  }
+}
+
+static uint32_t packPixel(const Colour& c) {
+  auto a = std::clamp(c.alpha(), 0.0, 1.0);
+  auto r = std::clamp(c.red(), 0.0, 1.0) * a;
+  auto g = std::clamp(c.green(), 0.0, 1.0) * a;
+  auto b = std::clamp(c.blue(), 0.0, 1.0) * a;
+
+  return
+      (uint32_t(a * 255 + 0.5) << 24) |
+      (uint32_t(r * 255 + 0.5) << 16) |
+      (uint32_t(g * 255 + 0.5) << 8) |
+      (uint32_t(b * 255 + 0.5));
+}
+
+void density_colourize(
+    const DensityGrid& grid,
+    DensityScale scale,
+    const Colour& colour_low,
+    const Colour& colour_high,
+    std::vector<uint32_t>* pixels) {
+  pixels->assign(grid.counts.size(), 0);
+
+  uint32_t max_count = 0;
+  for (auto c : grid.counts) {
+    max_count = std::max(max_count, c);
+  }
+
+  if (max_count == 0) {
+    return;
+  }
+
+  /* one precomputed colour per ramp step */
+  static const size_t kRampSteps = 256;
+  uint32_t ramp[kRampSteps];
+  for (size_t i = 0; i < kRampSteps; ++i) {
+    auto t = double(i) / (kRampSteps - 1);
+    Colour c;
+    for (size_t j = 0; j < Colour::kMaxComponents; ++j) {
+      c[j] = colour_low[j] + (colour_high[j] - colour_low[j]) * t;
+    }
+
+    ramp[i] = packPixel(c);
+  }
+
+  auto range = scale == DensityScale::LOG ?
+      log(double(max_count)) :
+      double(max_count - 1);
+
+  for (size_t i = 0; i < grid.counts.size(); ++i) {
+    auto count = grid.counts[i];
+    if (count == 0) {
+      continue;
+    }
+
+    double t = 1;
+    if (range > 0) {
+      switch (scale) {
+        case DensityScale::LINEAR:
+          t = (count - 1) / range;
+          break;
+        case DensityScale::LOG:
+          t = log(double(count)) / range;
+          break;
+      }
+    }
+
+    (*pixels)[i] = ramp[size_t(t * (kRampSteps - 1) + 0.5)];
+  }
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,88 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include "colour.h"
+#include "layout.h"
+
+namespace plotfx {
+
+enum class DensityScale {
+  LINEAR,
+  LOG
+};
+
+/**
+ * A grid of per-bucket point counts covering a rectangle of the canvas. Each
+ * bucket is a square of bin_size pixels; the last row and column may extend
+ * beyond the rectangle
+ */
+struct DensityGrid {
+  DensityGrid();
+  DensityGrid(const Rectangle& rect, double bin_size);
+
+  Rectangle rect;
+  double bin_size;
+  uint32_t cols;
+  uint32_t rows;
+  std::vector<uint32_t> counts;
+};
+
+/**
+ * Count the points (device coordinates) into the grid. Points outside of the
+ * grid's rectangle and NaN points are ignored
+ */
+void density_bin(
+    const double* xs,
+    const double* ys,
+    size_t count,
+    DensityGrid* grid);
+
+/**
+ * Add the counts of another grid of the same dimensions
+ */
+void density_merge(const DensityGrid& other, DensityGrid* grid);
+
+/**
+ * Map the counts to premultiplied ARGB32 pixels (one per bucket) by
+ * interpolating between the low colour (one point) and the high colour (the
+ * maximum count). Empty buckets are transparent
+ */
+void density_colourize(
+    const DensityGrid& grid,
+    DensityScale scale,
+    const Colour& colour_low,
+    const Colour& colour_high,
+    std::vector<uint32_t>* pixels);
+
+} // namespace plotfx
+
@@ -0,0 +1,906 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "clip.h"
+#include "display_list.h"
+#include "rasterize.h"
+#include "svg.h"
+
+namespace plotfx {
+
+static const char kSerializationMagic[] = "PFXDL\x05";
+static const size_t kSerializationMagicSize = sizeof(kSerializationMagic) - 1;
+
+static size_t getCoefficientCount(PathCommand cmd) {
+  switch (cmd) {
+    case PathCommand::MOVE_TO:
+    case PathCommand::LINE_TO:
+      return 2;
+    case PathCommand::QUADRATIC_CURVE_TO:
+      return 4;
+    case PathCommand::CUBIC_CURVE_TO:
+      return 6;
+    case PathCommand::ARC_TO:
+      return 5;
+    case PathCommand::CLOSE:
+      return 0;
+  }
+
+  return 0;
+}
+
+static bool operator==(const Rectangle& a, const Rectangle& b) {
+  return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static bool operator==(const StrokeStyle& a, const StrokeStyle& b) {
+  for (size_t i = 0; i < Colour::kMaxComponents; ++i) {
+    if (a.colour[i] != b.colour[i]) {
+      return false;
+    }
+  }
+
+  return
+      a.line_width.unit == b.line_width.unit &&
+      a.line_width.value == b.line_width.value &&
+      a.line_join == b.line_join &&
+      a.line_cap == b.line_cap;
+}
+
+static bool operator==(const FontInfo& a, const FontInfo& b) {
+  return a.font_file == b.font_file && a.font_size == b.font_size;
+}
+
+static bool operator==(const MarkerStyle& a, const MarkerStyle& b) {
+  for (size_t i = 0; i < Colour::kMaxComponents; ++i) {
+    if (a.colour[i] != b.colour[i]) {
+      return false;
+    }
+  }
+
+  return
+      a.shape == b.shape &&
+      a.size.unit == b.size.unit &&
+      a.size.value == b.size.value;
+}
+
+template <typename T>
+static uint32_t intern(std::vector<T>* table, const T& value) {
+  /* tables are small and most lookups hit one of the last entries */
+  for (size_t i = table->size(); i-- > 0; ) {
+    if ((*table)[i] == value) {
+      return i;
+    }
+  }
+
+  table->emplace_back(value);
+  return table->size() - 1;
+}
+
+DisplayListReplayOptions::DisplayListReplayOptions() :
+    coalesce_strokes(false),
+    coalesce_disjoint_strokes(true) {}
+
+/*
+ * Returns the whole-pixel rectangle that a polyline stroke can touch, grown
+ * by the same margin the rasterizer uses for pre-clipping. Returns false for
+ * paths with curves or closes, which are never merged
+ */
+static bool getStrokeFootprint(
+    const uint8_t* ops,
+    const double* coords,
+    size_t count,
+    double scale,
+    double line_width,
+    Rectangle* footprint) {
+  auto x0 = std::numeric_limits<double>::infinity();
+  auto y0 = std::numeric_limits<double>::infinity();
+  auto x1 = -std::numeric_limits<double>::infinity();
+  auto y1 = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < count; ++i) {
+    auto cmd = static_cast<PathCommand>(ops[i]);
+    if (cmd != PathCommand::MOVE_TO && cmd != PathCommand::LINE_TO) {
+      return false;
+    }
+
+    auto x = coords[i * 2] * scale;
+    auto y = coords[i * 2 + 1] * scale;
+    x0 = std::min(x0, x);
+    y0 = std::min(y0, y);
+    x1 = std::max(x1, x);
+    y1 = std::max(y1, y);
+  }
+
+  auto margin = clip_stroke_margin(line_width);
+  x0 = floor(x0 - margin);
+  y0 = floor(y0 - margin);
+  x1 = ceil(x1 + margin);
+  y1 = ceil(y1 + margin);
+  if (!std::isfinite(x0) || !std::isfinite(y0) ||
+      !std::isfinite(x1) || !std::isfinite(y1)) {
+    return false;
+  }
+
+  *footprint = Rectangle(x0, y0, x1 - x0, y1 - y0);
+  return true;
+}
+
+static bool footprintsOverlap(const Rectangle& a, const Rectangle& b) {
+  return
+      a.x < b.x + b.w &&
+      b.x < a.x + a.w &&
+      a.y < b.y + b.h &&
+      b.y < a.y + a.h;
+}
+
+DisplayList::DisplayList() : dpi_(96) {}
+
+uint32_t DisplayList::internClip(const Rectangle& clip) {
+  return intern(&clips_, clip);
+}
+
+uint32_t DisplayList::internStyle(const StrokeStyle& style) {
+  return intern(&styles_, style);
+}
+
+uint32_t DisplayList::internFont(const FontInfo& font_info) {
+  return intern(&fonts_, font_info);
+}
+
+uint32_t DisplayList::internMarkerStyle(const MarkerStyle& style) {
+  return intern(&marker_styles_, style);
+}
+
+void DisplayList::addStrokePath(
+    const Rectangle& clip,
+    const PathData* path_data,
+    size_t path_data_count,
+    const StrokeStyle& style) {
+  DrawCommand cmd;
+  cmd.type = DrawCommandType::STROKE_PATH;
+  cmd.style_idx = internStyle(style);
+  cmd.clip_idx = internClip(clip);
+  cmd.data_begin = path_ops_.size();
+  cmd.data_size = path_data_count;
+  cmd.coord_begin = path_coords_.size();
+  cmd.text_begin = 0;
+  cmd.text_size = 0;
+
+  for (size_t i = 0; i < path_data_count; ++i) {
+    const auto& d = path_data[i];
+    path_ops_.emplace_back(static_cast<uint8_t>(d.command));
+    path_coords_.insert(
+        path_coords_.end(),
+        d.coefficients,
+        d.coefficients + getCoefficientCount(d.command));
+  }
+
+  commands_.emplace_back(cmd);
+}
+
+void DisplayList::addStrokePath(
+    const Rectangle& clip,
+    const CompactPath& path,
+    const StrokeStyle& style) {
+  DrawCommand cmd;
+  cmd.type = DrawCommandType::STROKE_PATH;
+  cmd.style_idx = internStyle(style);
+  cmd.clip_idx = internClip(clip);
+  cmd.data_begin = path_ops_.size();
+  cmd.data_size = path.size();
+  cmd.coord_begin = path_coords_.size();
+  cmd.text_begin = 0;
+  cmd.text_size = 0;
+
+  path_ops_.insert(path_ops_.end(), path.commands(), path.commands() + path.size());
+
+  path_coords_.insert(
+      path_coords_.end(),
+      path.coords(),
+      path.coords() + path.coordCount());
+
+  commands_.emplace_back(cmd);
+}
+
+void DisplayList::addTextGlyphs(
+    const FontInfo& font_info,
+    const GlyphPlacement* glyphs,
+    size_t glyph_count,
+    std::string_view text /* = std::string_view() */) {
+  DrawCommand cmd;
+  cmd.type = DrawCommandType::TEXT_GLYPHS;
+  cmd.style_idx = internFont(font_info);
+  cmd.clip_idx = 0;
+  cmd.data_begin = glyphs_.size();
+  cmd.data_size = glyph_count;
+  cmd.coord_begin = 0;
+  cmd.text_begin = text_data_.size();
+  cmd.text_size = text.size();
+  text_data_.append(text);
+  glyphs_.insert(glyphs_.end(), glyphs, glyphs + glyph_count);
+  commands_.emplace_back(cmd);
+}
+
+void DisplayList::addMarkers(
+    const Rectangle& clip,
+    const MarkerStyle& style,
+    const double* coords,
+    size_t count) {
+  DrawCommand cmd;
+  cmd.type = DrawCommandType::MARKERS;
+  cmd.style_idx = internMarkerStyle(style);
+  cmd.clip_idx = internClip(clip);
+  cmd.data_begin = 0;
+  cmd.data_size = count;
+  cmd.coord_begin = path_coords_.size();
+  cmd.text_begin = 0;
+  cmd.text_size = 0;
+  path_coords_.insert(path_coords_.end(), coords, coords + count * 2);
+  commands_.emplace_back(cmd);
+}
+
+void DisplayList::addBitmap(
+    const Rectangle& clip,
+    const Rectangle& rect,
+    const uint32_t* pixels,
+    uint32_t width,
+    uint32_t height) {
+  DrawCommand cmd;
+  cmd.type = DrawCommandType::BITMAP;
+  cmd.style_idx = 0;
+  cmd.clip_idx = internClip(clip);
+  cmd.data_begin = bitmap_data_.size();
+  cmd.data_size = width * height;
+  cmd.coord_begin = path_coords_.size();
+  cmd.text_begin = 0;
+  cmd.text_size = 0;
+  path_coords_.push_back(rect.x);
+  path_coords_.push_back(rect.y);
+  path_coords_.push_back(rect.w);
+  path_coords_.push_back(rect.h);
+  path_coords_.push_back(width);
+  path_coords_.push_back(height);
+  bitmap_data_.insert(bitmap_data_.end(), pixels, pixels + width * height);
+  commands_.emplace_back(cmd);
+}
+
+Status DisplayList::replay(Rasterizer* target) const {
+  return replay(target, DisplayListReplayOptions{});
+}
+
+Status DisplayList::replay(
+    Rasterizer* target,
+    const DisplayListReplayOptions& opts) const {
+  return replayInto(target, opts);
+}
+
+Status DisplayList::replay(
+    SVGWriter* target,
+    const DisplayListReplayOptions& opts) const {
+  return replayInto(target, opts);
+}
+
+template <typename T>
+Status DisplayList::replayInto(
+    T* target,
+    const DisplayListReplayOptions& opts) const {
+  auto scale = target->measures.dpi / dpi_;
+
+  std::vector<PathData> path;
+  std::vector<Rectangle> footprints;
+  std::vector<GlyphPlacement> glyphs;
+  std::vector<double> marker_coords;
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    const auto& cmd = commands_[i];
+
+    Status rc = OK;
+    switch (cmd.type) {
+
+      case DrawCommandType::STROKE_PATH: {
+        const auto& style = styles_[cmd.style_idx];
+        auto coalesce_disjoint =
+            !opts.coalesce_strokes &&
+            opts.coalesce_disjoint_strokes &&
+            style.colour.alpha() >= 1.0;
+
+        auto line_width = double(to_px(target->measures, style.line_width));
+
+        path.clear();
+        footprints.clear();
+
+        for (auto j = i; j < commands_.size(); ++j) {
+          const auto& c = commands_[j];
+          if (j > i && (
+                !(opts.coalesce_strokes || coalesce_disjoint) ||
+                c.type != DrawCommandType::STROKE_PATH ||
+                c.style_idx != cmd.style_idx ||
+                c.clip_idx != cmd.clip_idx)) {
+            break;
+          }
+
+          /* a stroke only joins the group if none of its pixels can be
+           * covered by a stroke already in the group */
+          if (coalesce_disjoint) {
+            Rectangle footprint;
+            auto polyline = getStrokeFootprint(
+                path_ops_.data() + c.data_begin,
+                path_coords_.data() + c.coord_begin,
+                c.data_size,
+                scale,
+                line_width,
+                &footprint);
+
+            if (j > i) {
+              auto disjoint = polyline && std::none_of(
+                  footprints.begin(),
+                  footprints.end(),
+                  [&footprint] (const Rectangle& f) {
+                    return footprintsOverlap(f, footprint);
+                  });
+
+              if (!disjoint) {
+                break;
+              }
+            }
+
+            if (!polyline) {
+              coalesce_disjoint = false;
+            }
+
+            footprints.emplace_back(footprint);
+          }
+
+          auto coord = path_coords_.data() + c.coord_begin;
+          for (size_t k = 0; k < c.data_size; ++k) {
+            PathData d;
+            d.command = static_cast<PathCommand>(path_ops_[c.data_begin + k]);
+            auto coord_count = getCoefficientCount(d.command);
+            for (size_t n = 0; n < coord_count; ++n) {
+              d.coefficients[n] = *coord++ * scale;
+            }
+
+            /* a merged stroke must not connect to the previous subpath */
+            if (k == 0 && j > i && d.command == PathCommand::LINE_TO) {
+              d.command = PathCommand::MOVE_TO;
+            }
+
+            path.emplace_back(d);
+          }
+
+          i = j;
+        }
+
+        auto clip = clips_[cmd.clip_idx];
+        clip.x *= scale;
+        clip.y *= scale;
+        clip.w *= scale;
+        clip.h *= scale;
+
+        rc = target->strokePath(clip, path.data(), path.size(), style);
+        break;
+      }
+
+      case DrawCommandType::TEXT_GLYPHS:
+        glyphs.assign(
+            glyphs_.begin() + cmd.data_begin,
+            glyphs_.begin() + cmd.data_begin + cmd.data_size);
+
+        for (auto& g : glyphs) {
+          g.x *= scale;
+          g.y *= scale;
+        }
+
+        rc = target->drawTextGlyphs(
+            fonts_[cmd.style_idx],
+            glyphs.data(),
+            glyphs.size(),
+            std::string_view(text_data_).substr(cmd.text_begin, cmd.text_size));
+        break;
+
+      case DrawCommandType::MARKERS: {
+        auto coords = path_coords_.data() + cmd.coord_begin;
+        if (scale != 1) {
+          marker_coords.assign(coords, coords + cmd.data_size * 2);
+          for (auto& v : marker_coords) {
+            v *= scale;
+          }
+
+          coords = marker_coords.data();
+        }
+
+        auto clip = clips_[cmd.clip_idx];
+        clip.x *= scale;
+        clip.y *= scale;
+        clip.w *= scale;
+        clip.h *= scale;
+
+        rc = target->drawMarkers(
+            clip,
+            marker_styles_[cmd.style_idx],
+            coords,
+            cmd.data_size);
+        break;
+      }
+
+      case DrawCommandType::BITMAP: {
+        auto coords = path_coords_.data() + cmd.coord_begin;
+        auto width = uint32_t(coords[4]);
+        auto height = uint32_t(coords[5]);
+
+        auto clip = clips_[cmd.clip_idx];
+        clip.x *= scale;
+        clip.y *= scale;
+        clip.w *= scale;
+        clip.h *= scale;
+
+        rc = target->drawBitmap(
+            clip,
+            Rectangle(
+                coords[0] * scale,
+                coords[1] * scale,
+                coords[2] * scale,
+                coords[3] * scale),
+            bitmap_data_.data() + cmd.data_begin,
+            width,
+            height);
+        break;
+      }
+
+    }
+
+    if (rc != OK) {
+      return rc;
+    }
+  }
+
+  return OK;
+}
+
+double DisplayList::getDPI() const {
+  return dpi_;
+}
+
+void DisplayList::setDPI(double dpi) {
+  dpi_ = dpi;
+}
+
+namespace {
+
+class Writer {
+public:
+
+  Writer(std::string* data) : data_(data) {}
+
+  template <typename T>
+  void write(T value) {
+    data_->append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeString(const std::string& str) {
+    write<uint32_t>(str.size());
+    data_->append(str);
+  }
+
+protected:
+  std::string* data_;
+};
+
+class Reader {
+public:
+
+  Reader(std::string_view data) : data_(data), pos_(0) {}
+
+  template <typename T>
+  bool read(T* value) {
+    if (data_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+
+    memcpy(value, data_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string* str) {
+    uint32_t len;
+    if (!read(&len) || data_.size() - pos_ < len) {
+      return false;
+    }
+
+    str->assign(data_.data() + pos_, len);
+    pos_ += len;
+    return true;
+  }
+
+  bool eof() const {
+    return pos_ == data_.size();
+  }
+
+  size_t remaining() const {
+    return data_.size() - pos_;
+  }
+
+protected:
+  std::string_view data_;
+  size_t pos_;
+};
+
+} // namespace
+
+/* all values are stored in host byte order */
+void DisplayList::serialize(std::string* data) const {
+  data->assign(kSerializationMagic, kSerializationMagicSize);
+
+  Writer w(data);
+  w.write<double>(dpi_);
+
+  w.write<uint32_t>(clips_.size());
+  for (const auto& c : clips_) {
+    w.write<double>(c.x);
+    w.write<double>(c.y);
+    w.write<double>(c.w);
+    w.write<double>(c.h);
+  }
+
+  w.write<uint32_t>(styles_.size());
+  for (const auto& s : styles_) {
+    w.write<uint8_t>(static_cast<uint8_t>(s.line_width.unit));
+    w.write<double>(s.line_width.value);
+    w.write<uint8_t>(static_cast<uint8_t>(s.line_join));
+    w.write<uint8_t>(static_cast<uint8_t>(s.line_cap));
+    for (size_t i = 0; i < Colour::kMaxComponents; ++i) {
+      w.write<double>(s.colour[i]);
+    }
+  }
+
+  w.write<uint32_t>(fonts_.size());
+  for (const auto& f : fonts_) {
+    w.writeString(f.font_file);
+    w.write<double>(f.font_size);
+  }
+
+  w.write<uint32_t>(marker_styles_.size());
+  for (const auto& m : marker_styles_) {
+    w.write<uint8_t>(static_cast<uint8_t>(m.shape));
+    w.write<uint8_t>(static_cast<uint8_t>(m.size.unit));
+    w.write<double>(m.size.value);
+    for (size_t i = 0; i < Colour::kMaxComponents; ++i) {
+      w.write<double>(m.colour[i]);
+    }
+  }
+
+  w.write<uint32_t>(commands_.size());
+  for (const auto& c : commands_) {
+    w.write<uint8_t>(static_cast<uint8_t>(c.type));
+    w.write<uint32_t>(c.style_idx);
+    w.write<uint32_t>(c.clip_idx);
+    w.write<uint32_t>(c.data_begin);
+    w.write<uint32_t>(c.data_size);
+    w.write<uint32_t>(c.coord_begin);
+    w.write<uint32_t>(c.text_begin);
+    w.write<uint32_t>(c.text_size);
+  }
+
+  w.write<uint32_t>(path_ops_.size());
+  data->append(reinterpret_cast<const char*>(path_ops_.data()), path_ops_.size());
+
+  w.write<uint32_t>(path_coords_.size());
+  for (auto v : path_coords_) {
+    w.write<double>(v);
+  }
+
+  w.write<uint32_t>(glyphs_.size());
+  for (const auto& g : glyphs_) {
+    w.write<uint32_t>(g.codepoint);
+    w.write<double>(g.x);
+    w.write<double>(g.y);
+  }
+
+  w.writeString(text_data_);
+
+  w.write<uint32_t>(bitmap_data_.size());
+  data->append(
+      reinterpret_cast<const char*>(bitmap_data_.data()),
+      bitmap_data_.size() * sizeof(uint32_t));
+}
+
+ReturnCode DisplayList::deserialize(std::string_view data, DisplayList* list) {
+  auto invalid = [] (const char* what) {
+    return ReturnCode::errorf("EPARSE", "invalid display list: $0", what);
+  };
+
+  if (data.substr(0, kSerializationMagicSize) !=
+      std::string_view(kSerializationMagic, kSerializationMagicSize)) {
+    return invalid("bad magic bytes");
+  }
+
+  Reader r(data.substr(kSerializationMagicSize));
+  DisplayList l;
+  uint32_t n;
+
+  if (!r.read(&l.dpi_) || !(l.dpi_ > 0)) {
+    return invalid("bad dpi");
+  }
+
+  if (!r.read(&n)) {
+    return invalid("truncated clip table");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    Rectangle c;
+    if (!r.read(&c.x) || !r.read(&c.y) || !r.read(&c.w) || !r.read(&c.h)) {
+      return invalid("truncated clip table");
+    }
+    l.clips_.emplace_back(c);
+  }
+
+  if (!r.read(&n)) {
+    return invalid("truncated style table");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    StrokeStyle s;
+    uint8_t unit, join, cap;
+    if (!r.read(&unit) ||
+        !r.read(&s.line_width.value) ||
+        !r.read(&join) ||
+        !r.read(&cap)) {
+      return invalid("truncated style table");
+    }
+    for (size_t j = 0; j < Colour::kMaxComponents; ++j) {
+      if (!r.read(&s.colour[j])) {
+        return invalid("truncated style table");
+      }
+    }
+    if (unit > static_cast<uint8_t>(Unit::REM) ||
+        join > static_cast<uint8_t>(StrokeLineJoin::BEVEL) ||
+        cap > static_cast<uint8_t>(StrokeLineCap::ROUND)) {
+      return invalid("bad stroke style");
+    }
+    s.line_width.unit = static_cast<Unit>(unit);
+    s.line_join = static_cast<StrokeLineJoin>(join);
+    s.line_cap = static_cast<StrokeLineCap>(cap);
+    l.styles_.emplace_back(s);
+  }
+
+  if (!r.read(&n)) {
+    return invalid("truncated font table");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    FontInfo f;
+    if (!r.readString(&f.font_file) || !r.read(&f.font_size)) {
+      return invalid("truncated font table");
+    }
+    l.fonts_.emplace_back(f);
+  }
+
+  if (!r.read(&n)) {
+    return invalid("truncated marker style table");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    MarkerStyle m;
+    uint8_t shape, unit;
+    if (!r.read(&shape) || !r.read(&unit) || !r.read(&m.size.value)) {
+      return invalid("truncated marker style table");
+    }
+    for (size_t j = 0; j < Colour::kMaxComponents; ++j) {
+      if (!r.read(&m.colour[j])) {
+        return invalid("truncated marker style table");
+      }
+    }
+    if (shape > static_cast<uint8_t>(MarkerShape::SQUARE)) {
+      return invalid("bad marker shape");
+    }
+    if (unit > static_cast<uint8_t>(Unit::REM)) {
+      return invalid("bad marker size");
+    }
+    m.shape = static_cast<MarkerShape>(shape);
+    m.size.unit = static_cast<Unit>(unit);
+    l.marker_styles_.emplace_back(m);
+  }
+
+  if (!r.read(&n)) {
+    return invalid("truncated command list");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    DrawCommand c;
+    uint8_t type;
+    if (!r.read(&type) ||
+        !r.read(&c.style_idx) ||
+        !r.read(&c.clip_idx) ||
+        !r.read(&c.data_begin) ||
+        !r.read(&c.data_size) ||
+        !r.read(&c.coord_begin) ||
+        !r.read(&c.text_begin) ||
+        !r.read(&c.text_size)) {
+      return invalid("truncated command list");
+    }
+    c.type = static_cast<DrawCommandType>(type);
+    l.commands_.emplace_back(c);
+  }
+
+  /* check every element count against the remaining input before
+   * allocating, so a corrupt count can't trigger a huge allocation */
+  if (!r.read(&n) || n > r.remaining() / sizeof(uint8_t)) {
+    return invalid("truncated path data");
+  }
+  l.path_ops_.resize(n);
+  for (auto& op : l.path_ops_) {
+    if (!r.read(&op)) {
+      return invalid("truncated path data");
+    }
+  }
+
+  if (!r.read(&n) || n > r.remaining() / sizeof(double)) {
+    return invalid("truncated path data");
+  }
+  l.path_coords_.resize(n);
+  for (auto& v : l.path_coords_) {
+    if (!r.read(&v)) {
+      return invalid("truncated path data");
+    }
+  }
+
+  static const size_t kGlyphSize = sizeof(uint32_t) + 2 * sizeof(double);
+  if (!r.read(&n) || n > r.remaining() / kGlyphSize) {
+    return invalid("truncated glyph data");
+  }
+  l.glyphs_.resize(n);
+  for (auto& g : l.glyphs_) {
+    if (!r.read(&g.codepoint) || !r.read(&g.x) || !r.read(&g.y)) {
+      return invalid("truncated glyph data");
+    }
+  }
+
+  if (!r.readString(&l.text_data_)) {
+    return invalid("truncated text data");
+  }
+
+  if (!r.read(&n) || n > r.remaining() / sizeof(uint32_t)) {
+    return invalid("truncated bitmap data");
+  }
+  l.bitmap_data_.resize(n);
+  for (auto& v : l.bitmap_data_) {
+    if (!r.read(&v)) {
+      return invalid("truncated bitmap data");
+    }
+  }
+
+  if (!r.eof()) {
+    return invalid("trailing data");
+  }
+
+  /* validate all references so replay never reads out of bounds */
+  for (const auto& c : l.commands_) {
+    switch (c.type) {
+      case DrawCommandType::STROKE_PATH: {
+        if (c.style_idx >= l.styles_.size() ||
+            c.clip_idx >= l.clips_.size() ||
+            uint64_t(c.data_begin) + c.data_size > l.path_ops_.size()) {
+          return invalid("bad stroke command");
+        }
+
+        uint64_t coords = 0;
+        for (size_t k = 0; k < c.data_size; ++k) {
+          auto op = l.path_ops_[c.data_begin + k];
+          if (op > static_cast<uint8_t>(PathCommand::CLOSE)) {
+            return invalid("bad path command");
+          }
+          coords += getCoefficientCount(static_cast<PathCommand>(op));
+        }
+
+        if (c.coord_begin + coords > l.path_coords_.size()) {
+          return invalid("bad stroke command");
+        }
+        break;
+      }
+
+      case DrawCommandType::TEXT_GLYPHS:
+        if (c.style_idx >= l.fonts_.size() ||
+            uint64_t(c.data_begin) + c.data_size > l.glyphs_.size() ||
+            uint64_t(c.text_begin) + c.text_size > l.text_data_.size()) {
+          return invalid("bad text command");
+        }
+        break;
+
+      case DrawCommandType::MARKERS:
+        if (c.style_idx >= l.marker_styles_.size() ||
+            c.clip_idx >= l.clips_.size() ||
+            uint64_t(c.coord_begin) + uint64_t(c.data_size) * 2 >
+                l.path_coords_.size()) {
+          return invalid("bad marker command");
+        }
+        break;
+
+      case DrawCommandType::BITMAP: {
+        if (c.clip_idx >= l.clips_.size() ||
+            uint64_t(c.coord_begin) + 6 > l.path_coords_.size() ||
+            uint64_t(c.data_begin) + c.data_size > l.bitmap_data_.size()) {
+          return invalid("bad bitmap command");
+        }
+
+        auto width = l.path_coords_[c.coord_begin + 4];
+        auto height = l.path_coords_[c.coord_begin + 5];
+        if (!(width >= 1 && width <= c.data_size) ||
+            !(height >= 1 && height <= c.data_size) ||
+            width != uint32_t(width) ||
+            height != uint32_t(height) ||
+            uint64_t(width) * uint64_t(height) != c.data_size) {
+          return invalid("bad bitmap command");
+        }
+        break;
+      }
+
+      default:
+        return invalid("bad command type");
+    }
+  }
+
+  *list = std::move(l);
+  return ReturnCode::success();
+}
+
+uint64_t DisplayList::hash() const {
+  std::string data;
+  serialize(&data);
+
+  uint64_t h = 0xcbf29ce484222325;
+  for (auto c : data) {
+    h ^= static_cast<uint8_t>(c);
+    h *= 0x100000001b3;
+  }
+
+  return h;
+}
+
+void DisplayList::clear() {
+  commands_.clear();
+  clips_.clear();
+  styles_.clear();
+  fonts_.clear();
+  marker_styles_.clear();
+  path_ops_.clear();
+  path_coords_.clear();
+  glyphs_.clear();
+  bitmap_data_.clear();
+  text_data_.clear();
+}
+
+size_t DisplayList::size() const {
+  return commands_.size();
+}
+
+bool DisplayList::empty() const {
+  return commands_.empty();
+}
+
+} // namespace plotfx
+
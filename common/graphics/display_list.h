@@ -0,0 +1,187 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "brush.h"
+#include "compact_path.h"
+#include "layout.h"
+#include "marker.h"
+#include "path.h"
+#include "text.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+class Rasterizer;
+class SVGWriter;
+
+enum class DrawCommandType : uint8_t {
+  STROKE_PATH,
+  TEXT_GLYPHS,
+  MARKERS,
+  BITMAP
+};
+
+/**
+ * A single recorded draw call. Styles, fonts and clip rectangles are interned
+ * in per-list tables and referenced by index; the path vertices and glyphs
+ * live in shared arenas. Bitmap commands keep their rectangle, width and
+ * height in the coordinate arena and their rows of pixels, without padding,
+ * in the bitmap arena.
+ */
+struct DrawCommand {
+  DrawCommandType type;
+  uint32_t style_idx;
+  uint32_t clip_idx;
+  uint32_t data_begin;
+  uint32_t data_size;
+  uint32_t coord_begin;
+  uint32_t text_begin;
+  uint32_t text_size;
+};
+
+struct DisplayListReplayOptions {
+  DisplayListReplayOptions();
+
+  /**
+   * Merge consecutive strokes that share the same style and clip into a
+   * single cairo path. This saves a lot of per-stroke overhead for axes and
+   * grids, but overlapping anti-aliased edges (and translucent colours) are
+   * composited once instead of per stroke, so the output can differ slightly
+   * from an unmerged replay
+   */
+  bool coalesce_strokes;
+
+  /**
+   * Merge consecutive opaque polyline strokes with the same style and clip
+   * only while the pixels they can touch do not overlap. No pixel is then
+   * covered by more than one of the merged strokes, so the output is
+   * identical to an unmerged replay. Enabled by default
+   */
+  bool coalesce_disjoint_strokes;
+};
+
+/**
+ * A retained list of rasterizer draw calls (see Rasterizer::beginRecording).
+ * The list can be replayed into any number of rasterizers, optionally at a
+ * different resolution, serialized to a compact binary form and hashed for
+ * caching.
+ */
+class DisplayList {
+public:
+
+  DisplayList();
+
+  void addStrokePath(
+      const Rectangle& clip,
+      const PathData* path_data,
+      size_t path_data_count,
+      const StrokeStyle& style);
+
+  void addStrokePath(
+      const Rectangle& clip,
+      const CompactPath& path,
+      const StrokeStyle& style);
+
+  void addTextGlyphs(
+      const FontInfo& font_info,
+      const GlyphPlacement* glyphs,
+      size_t glyph_count,
+      std::string_view text = std::string_view());
+
+  void addMarkers(
+      const Rectangle& clip,
+      const MarkerStyle& style,
+      const double* coords,
+      size_t count);
+
+  void addBitmap(
+      const Rectangle& clip,
+      const Rectangle& rect,
+      const uint32_t* pixels,
+      uint32_t width,
+      uint32_t height);
+
+  /**
+   * Replay all commands in order into the target rasterizer. Coordinates are
+   * scaled by the ratio of the target's dpi to the recorded dpi; line widths
+   * and font sizes are resolved against the target's measures. The plain
+   * variant reproduces the pixels of the original draw calls exactly
+   */
+  Status replay(Rasterizer* target) const;
+  Status replay(Rasterizer* target, const DisplayListReplayOptions& opts) const;
+  Status replay(SVGWriter* target, const DisplayListReplayOptions& opts) const;
+
+  /**
+   * The resolution the commands were recorded at
+   */
+  double getDPI() const;
+  void setDPI(double dpi);
+
+  void serialize(std::string* data) const;
+  static ReturnCode deserialize(std::string_view data, DisplayList* list);
+
+  /**
+   * 64-bit FNV-1a hash of the serialized list
+   */
+  uint64_t hash() const;
+
+  void clear();
+  size_t size() const;
+  bool empty() const;
+
+protected:
+
+  uint32_t internClip(const Rectangle& clip);
+  uint32_t internStyle(const StrokeStyle& style);
+  uint32_t internFont(const FontInfo& font_info);
+  uint32_t internMarkerStyle(const MarkerStyle& style);
+
+  template <typename T>
+  Status replayInto(T* target, const DisplayListReplayOptions& opts) const;
+
+  double dpi_;
+  std::vector<DrawCommand> commands_;
+  std::vector<Rectangle> clips_;
+  std::vector<StrokeStyle> styles_;
+  std::vector<FontInfo> fonts_;
+  std::vector<MarkerStyle> marker_styles_;
+  std::vector<uint8_t> path_ops_;
+  std::vector<double> path_coords_;
+  std::vector<GlyphPlacement> glyphs_;
+  std::vector<uint32_t> bitmap_data_;
+  std::string text_data_;
+};
+
+} // namespace plotfx
+
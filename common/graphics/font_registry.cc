@@ -0,0 +1,200 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cairo-ft.h>
+#include <harfbuzz/hb-ft.h>
+#include "font_registry.h"
+
+namespace plotfx {
+namespace text {
+
+static const cairo_user_data_key_t kCairoFaceKey = {};
+
+/*
+ * FreeType requires creating and destroying faces of one library to be
+ * serialized. Faces are released from FontEntry destructors and from cairo's
+ * font cache on any thread, so every FT_New_Face/FT_Done_Face call holds this
+ * lock. It is never held while calling into cairo: cairo may run
+ * releaseFTFace with its own font map lock held. Intentionally leaked, like
+ * the registry itself
+ */
+static std::mutex& getLibraryLock() {
+  static auto lock = new std::mutex();
+  return *lock;
+}
+
+static void releaseFTFace(void* face) {
+  std::lock_guard<std::mutex> guard(getLibraryLock());
+  FT_Done_Face(static_cast<FT_Face>(face));
+}
+
+FontEntry::FontEntry() :
+    ft_face(nullptr),
+    hb_font(nullptr),
+    cairo_face(nullptr),
+    metrics_ascender(0),
+    metrics_descender(0) {}
+
+FontEntry::~FontEntry() {
+  /* may drop cairo's reference through releaseFTFace, which takes the lock */
+  if (cairo_face) {
+    cairo_font_face_destroy(cairo_face);
+  }
+
+  std::lock_guard<std::mutex> guard(getLibraryLock());
+
+  /* the HarfBuzz font holds its own reference to the FreeType face */
+  if (hb_font) {
+    hb_font_destroy(hb_font);
+  }
+
+  if (ft_face) {
+    FT_Done_Face(ft_face);
+  }
+}
+
+FontRegistry* FontRegistry::get() {
+  /* intentionally leaked; cairo may release font faces during shutdown */
+  static auto registry = new FontRegistry();
+  return registry;
+}
+
+FontRegistry::FontRegistry() :
+    ft_ready_(false),
+    hits_(0),
+    misses_(0) {
+  std::lock_guard<std::mutex> guard(getLibraryLock());
+  if (!FT_Init_FreeType(&ft_)) {
+    ft_ready_ = true;
+  }
+}
+
+FontRegistry::~FontRegistry() {
+  fonts_.clear();
+
+  std::lock_guard<std::mutex> guard(getLibraryLock());
+  if (ft_ready_) {
+    FT_Done_FreeType(ft_);
+  }
+}
+
+Status FontRegistry::getFont(
+    const std::string& font_file,
+    double font_size,
+    double dpi,
+    FontRef* font) {
+  auto key = font_file;
+  key += '\0';
+  key.append(reinterpret_cast<const char*>(&font_size), sizeof(font_size));
+  key.append(reinterpret_cast<const char*>(&dpi), sizeof(dpi));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  auto iter = fonts_.find(key);
+  if (iter != fonts_.end()) {
+    ++hits_;
+    *font = iter->second;
+    return OK;
+  }
+
+  ++misses_;
+  if (auto rc = loadFont(font_file, font_size, dpi, font); rc != OK) {
+    return rc;
+  }
+
+  fonts_.emplace(key, *font);
+  return OK;
+}
+
+Status FontRegistry::loadFont(
+    const std::string& font_file,
+    double font_size,
+    double dpi,
+    FontRef* font) {
+  if (!ft_ready_) {
+    return ERROR;
+  }
+
+  auto entry = std::make_shared<FontEntry>();
+
+  {
+    std::lock_guard<std::mutex> guard(getLibraryLock());
+    if (FT_New_Face(ft_, font_file.c_str(), 0, &entry->ft_face)) {
+      entry->ft_face = nullptr;
+      return ERROR;
+    }
+
+    if (FT_Set_Char_Size(entry->ft_face, 0, font_size * 64, dpi, dpi)) {
+      return ERROR;
+    }
+
+    entry->metrics_ascender = entry->ft_face->size->metrics.ascender / 64.0;
+    entry->metrics_descender = entry->ft_face->size->metrics.descender / 64.0;
+    entry->hb_font = hb_ft_font_create_referenced(entry->ft_face);
+
+    /* released by releaseFTFace */
+    FT_Reference_Face(entry->ft_face);
+  }
+
+  /* cairo may keep the face alive after we drop it, so it holds its own
+   * reference to the FreeType face */
+  entry->cairo_face = cairo_ft_font_face_create_for_ft_face(entry->ft_face, 0);
+  auto cairo_rc = cairo_font_face_set_user_data(
+      entry->cairo_face,
+      &kCairoFaceKey,
+      entry->ft_face,
+      &releaseFTFace);
+
+  if (cairo_rc != CAIRO_STATUS_SUCCESS) {
+    releaseFTFace(entry->ft_face);
+    return ERROR;
+  }
+
+  *font = std::move(entry);
+  return OK;
+}
+
+void FontRegistry::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  fonts_.clear();
+}
+
+FontRegistryStats FontRegistry::getStats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  FontRegistryStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.entries = fonts_.size();
+  return stats;
+}
+
+} // namespace text
+} // namespace plotfx
+
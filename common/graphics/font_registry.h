@@ -0,0 +1,126 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <cairo.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <harfbuzz/hb.h>
+
+#include "plotfx.h"
+
+namespace plotfx {
+namespace text {
+
+/**
+ * A loaded font at a fixed size and resolution. The FreeType face is shared
+ * by the HarfBuzz and cairo font objects; all three are released when the
+ * last reference to the entry (and cairo's own references to the font face)
+ * go away.
+ *
+ * FreeType faces are not thread-safe: callers must hold `lock` while shaping
+ * or drawing with the font.
+ */
+struct FontEntry {
+  FontEntry();
+  ~FontEntry();
+  FontEntry(const FontEntry&) = delete;
+  FontEntry& operator=(const FontEntry&) = delete;
+
+  FT_Face ft_face;
+  hb_font_t* hb_font;
+  cairo_font_face_t* cairo_face;
+  double metrics_ascender;
+  double metrics_descender;
+  std::mutex lock;
+};
+
+using FontRef = std::shared_ptr<FontEntry>;
+
+struct FontRegistryStats {
+  uint64_t hits;
+  uint64_t misses;
+  size_t entries;
+};
+
+/**
+ * Process-wide cache of loaded fonts keyed by (font_file, font_size, dpi)
+ * shared by the text shaper and the rasterizer. Safe to use from multiple
+ * threads.
+ */
+class FontRegistry {
+public:
+
+  static FontRegistry* get();
+
+  FontRegistry();
+  ~FontRegistry();
+  FontRegistry(const FontRegistry&) = delete;
+  FontRegistry& operator=(const FontRegistry&) = delete;
+
+  /**
+   * Look up a font, loading it on the first request
+   */
+  Status getFont(
+      const std::string& font_file,
+      double font_size,
+      double dpi,
+      FontRef* font);
+
+  /**
+   * Drop all cached fonts; fonts still referenced by callers stay valid
+   */
+  void clear();
+
+  FontRegistryStats getStats() const;
+
+protected:
+
+  Status loadFont(
+      const std::string& font_file,
+      double font_size,
+      double dpi,
+      FontRef* font);
+
+  mutable std::mutex mutex_;
+  FT_Library ft_;
+  bool ft_ready_;
+  std::unordered_map<std::string, FontRef> fonts_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+} // namespace text
+} // namespace plotfx
+
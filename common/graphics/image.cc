@@ -29,8 +29,14 @@
  */
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 #include "image.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#define PLOTFX_IMAGE_X86 1
+#include <immintrin.h>
+#endif
+
 namespace plotfx {
 
 Image::Image(
@@ -212,24 +218,361 @@ Image convertImage_RGB8_RGBA8(const Image& img) {
   auto src = ((const unsigned char*) img.getData());
   auto dst = ((unsigned char*) newimg.getData());
   for (size_t i = 0; i < img.getWidth() * img.getHeight(); ++i) {
-    memcpy(dst + i * 4, src + i * 3, 3); 
+    dst[i * 4 + 0] = src[i * 3 + 0];
+    dst[i * 4 + 1] = src[i * 3 + 1];
+    dst[i * 4 + 2] = src[i * 3 + 2];
     dst[i * 4 + 3] = 0xff;
   }
 
   return newimg;
 }
 
-Image convertImage_RGB8A_RGB8(const Image& img) {
+Image convertImage_RGBA8_RGB8(const Image& img) {
   Image newimg(PixelFormat::RGB8, img.getWidth(), img.getHeight());
 
   auto src = ((const unsigned char*) img.getData());
   auto dst = ((unsigned char*) newimg.getData());
   for (size_t i = 0; i < img.getWidth() * img.getHeight(); ++i) {
-    memcpy(dst + i * 3, src + i * 4, 3); 
+    dst[i * 3 + 0] = src[i * 4 + 0];
+    dst[i * 3 + 1] = src[i * 4 + 1];
+    dst[i * 3 + 2] = src[i * 4 + 2];
   }
 
   return newimg;
 }
 
-} // namespace plotfx
+using ConvertKernel = void (*)(const uint32_t*, size_t, unsigned char*);
+
+/* unpremultiply one channel; a > 0 */
+static inline uint8_t unpremultiply(uint32_t c, uint32_t a) {
+  return std::min((c * 255 + a / 2) / a, uint32_t(255));
+}
+
+static void convert_ARGB32_RGBA8_scalar(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  for (size_t i = 0; i < count; ++i, dst += 4) {
+    auto p = src[i];
+    auto a = p >> 24;
+    if (a == 0) {
+      dst[0] = dst[1] = dst[2] = dst[3] = 0;
+    } else if (a == 255) {
+      dst[0] = (p >> 16) & 0xff;
+      dst[1] = (p >> 8) & 0xff;
+      dst[2] = p & 0xff;
+      dst[3] = 255;
+    } else {
+      dst[0] = unpremultiply((p >> 16) & 0xff, a);
+      dst[1] = unpremultiply((p >> 8) & 0xff, a);
+      dst[2] = unpremultiply(p & 0xff, a);
+      dst[3] = a;
+    }
+  }
+}
+
+static void convert_ARGB32_RGB8_scalar(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  for (size_t i = 0; i < count; ++i, dst += 3) {
+    auto p = src[i];
+    auto a = p >> 24;
+    if (a == 0) {
+      dst[0] = dst[1] = dst[2] = 0;
+    } else if (a == 255) {
+      dst[0] = (p >> 16) & 0xff;
+      dst[1] = (p >> 8) & 0xff;
+      dst[2] = p & 0xff;
+    } else {
+      dst[0] = unpremultiply((p >> 16) & 0xff, a);
+      dst[1] = unpremultiply((p >> 8) & 0xff, a);
+      dst[2] = unpremultiply(p & 0xff, a);
+    }
+  }
+}
+
+#ifdef PLOTFX_IMAGE_X86
+
+/*
+ * The SIMD kernels load native endian ARGB32 pixels, i.e. BGRA in memory, and
+ * reorder the bytes with a single shuffle. Blocks of opaque pixels (all of
+ * them when rendering over an opaque background) skip the unpremultiply step
+ */
+#define PLOTFX_SHUFFLE_RGBA8 \
+    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+
+#define PLOTFX_SHUFFLE_RGB8 \
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+/*
+ * Divide in single precision: the numerator c * 255 + a / 2 is below 2^16, so
+ * the truncated quotient is exact and matches the scalar kernel
+ */
+__attribute__((target("sse4.1")))
+static inline __m128i unpremultiply_sse41(__m128i c, __m128 a, __m128 half) {
+  auto n = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(255)), half);
+  auto q = _mm_cvttps_epi32(_mm_div_ps(n, a));
+  return _mm_min_epi32(q, _mm_set1_epi32(255));
+}
+
+/* returns the pixels in the same BGRA layout, with straight alpha */
+__attribute__((target("sse4.1")))
+static inline __m128i unpremultiplyPixels_sse41(__m128i p) {
+  auto mask = _mm_set1_epi32(0xff);
+  auto a = _mm_srli_epi32(p, 24);
+  auto af = _mm_cvtepi32_ps(_mm_max_epi32(a, _mm_set1_epi32(1)));
+  auto half = _mm_cvtepi32_ps(_mm_srli_epi32(a, 1));
+
+  auto r = unpremultiply_sse41(_mm_and_si128(_mm_srli_epi32(p, 16), mask), af, half);
+  auto g = unpremultiply_sse41(_mm_and_si128(_mm_srli_epi32(p, 8), mask), af, half);
+  auto b = unpremultiply_sse41(_mm_and_si128(p, mask), af, half);
+
+  auto out = _mm_or_si128(
+      _mm_or_si128(b, _mm_slli_epi32(g, 8)),
+      _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(a, 24)));
 
+  return _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), out);
+}
+
+__attribute__((target("sse4.1")))
+static void convert_ARGB32_RGBA8_sse41(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  auto alpha = _mm_set1_epi32(0xff000000);
+  auto shuffle = _mm_setr_epi8(PLOTFX_SHUFFLE_RGBA8);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4, dst += 16) {
+    auto p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (!_mm_testc_si128(p, alpha)) {
+      p = unpremultiplyPixels_sse41(p);
+    }
+
+    p = _mm_shuffle_epi8(p, shuffle);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), p);
+  }
+
+  convert_ARGB32_RGBA8_scalar(src + i, count - i, dst);
+}
+
+__attribute__((target("sse4.1")))
+static void convert_ARGB32_RGB8_sse41(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  auto alpha = _mm_set1_epi32(0xff000000);
+  auto shuffle = _mm_setr_epi8(PLOTFX_SHUFFLE_RGB8);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4, dst += 12) {
+    auto p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (!_mm_testc_si128(p, alpha)) {
+      p = unpremultiplyPixels_sse41(p);
+    }
+
+    p = _mm_shuffle_epi8(p, shuffle);
+    uint32_t tail = _mm_extract_epi32(p, 2);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), p);
+    memcpy(dst + 8, &tail, 4);
+  }
+
+  convert_ARGB32_RGB8_scalar(src + i, count - i, dst);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i unpremultiply_avx2(__m256i c, __m256 a, __m256 half) {
+  auto n = _mm256_add_ps(
+      _mm256_mul_ps(_mm256_cvtepi32_ps(c), _mm256_set1_ps(255)),
+      half);
+
+  auto q = _mm256_cvttps_epi32(_mm256_div_ps(n, a));
+  return _mm256_min_epi32(q, _mm256_set1_epi32(255));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i unpremultiplyPixels_avx2(__m256i p) {
+  auto mask = _mm256_set1_epi32(0xff);
+  auto a = _mm256_srli_epi32(p, 24);
+  auto af = _mm256_cvtepi32_ps(_mm256_max_epi32(a, _mm256_set1_epi32(1)));
+  auto half = _mm256_cvtepi32_ps(_mm256_srli_epi32(a, 1));
+
+  auto r = unpremultiply_avx2(_mm256_and_si256(_mm256_srli_epi32(p, 16), mask), af, half);
+  auto g = unpremultiply_avx2(_mm256_and_si256(_mm256_srli_epi32(p, 8), mask), af, half);
+  auto b = unpremultiply_avx2(_mm256_and_si256(p, mask), af, half);
+
+  auto out = _mm256_or_si256(
+      _mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+      _mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(a, 24)));
+
+  return _mm256_andnot_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()), out);
+}
+
+__attribute__((target("avx2")))
+static void convert_ARGB32_RGBA8_avx2(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  auto alpha = _mm256_set1_epi32(0xff000000);
+  auto shuffle = _mm256_setr_epi8(PLOTFX_SHUFFLE_RGBA8, PLOTFX_SHUFFLE_RGBA8);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8, dst += 32) {
+    auto p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    if (!_mm256_testc_si256(p, alpha)) {
+      p = unpremultiplyPixels_avx2(p);
+    }
+
+    p = _mm256_shuffle_epi8(p, shuffle);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), p);
+  }
+
+  convert_ARGB32_RGBA8_scalar(src + i, count - i, dst);
+}
+
+/* the shuffle works within 128 bit lanes; each lane yields 12 bytes */
+__attribute__((target("avx2")))
+static void convert_ARGB32_RGB8_avx2(
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  auto alpha = _mm256_set1_epi32(0xff000000);
+  auto shuffle = _mm256_setr_epi8(PLOTFX_SHUFFLE_RGB8, PLOTFX_SHUFFLE_RGB8);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8, dst += 24) {
+    auto p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    if (!_mm256_testc_si256(p, alpha)) {
+      p = unpremultiplyPixels_avx2(p);
+    }
+
+    p = _mm256_shuffle_epi8(p, shuffle);
+    auto lo = _mm256_castsi256_si128(p);
+    auto hi = _mm256_extracti128_si256(p, 1);
+    uint32_t lo_tail = _mm_extract_epi32(lo, 2);
+    uint32_t hi_tail = _mm_extract_epi32(hi, 2);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), lo);
+    memcpy(dst + 8, &lo_tail, 4);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 12), hi);
+    memcpy(dst + 20, &hi_tail, 4);
+  }
+
+  convert_ARGB32_RGB8_scalar(src + i, count - i, dst);
+}
+
+#undef PLOTFX_SHUFFLE_RGBA8
+#undef PLOTFX_SHUFFLE_RGB8
+
+#endif
+
+static ConvertKernel getConvertKernel(
+    PixelKernel kernel,
+    PixelFormat dst_format) {
+  bool rgb8 = dst_format == PixelFormat::RGB8;
+  switch (kernel) {
+    case PixelKernel::SCALAR:
+      return rgb8 ? &convert_ARGB32_RGB8_scalar : &convert_ARGB32_RGBA8_scalar;
+#ifdef PLOTFX_IMAGE_X86
+    case PixelKernel::SSE41:
+      if (!__builtin_cpu_supports("sse4.1")) {
+        return nullptr;
+      }
+      return rgb8 ? &convert_ARGB32_RGB8_sse41 : &convert_ARGB32_RGBA8_sse41;
+    case PixelKernel::AVX2:
+      if (!__builtin_cpu_supports("avx2")) {
+        return nullptr;
+      }
+      return rgb8 ? &convert_ARGB32_RGB8_avx2 : &convert_ARGB32_RGBA8_avx2;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+static ConvertKernel getBestConvertKernel(PixelFormat dst_format) {
+  for (auto kernel : {PixelKernel::AVX2, PixelKernel::SSE41}) {
+    if (auto fn = getConvertKernel(kernel, dst_format); fn) {
+      return fn;
+    }
+  }
+
+  return getConvertKernel(PixelKernel::SCALAR, dst_format);
+}
+
+void convertPixels_ARGB32(
+    PixelFormat dst_format,
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  static const auto kernel_rgba8 = getBestConvertKernel(PixelFormat::RGBA8);
+  static const auto kernel_rgb8 = getBestConvertKernel(PixelFormat::RGB8);
+
+  switch (dst_format) {
+    case PixelFormat::RGB8:
+      kernel_rgb8(src, count, dst);
+      break;
+    case PixelFormat::RGBA8:
+      kernel_rgba8(src, count, dst);
+      break;
+  }
+}
+
+bool hasPixelKernel(PixelKernel kernel) {
+  return getConvertKernel(kernel, PixelFormat::RGBA8) != nullptr;
+}
+
+void convertPixels_ARGB32(
+    PixelKernel kernel,
+    PixelFormat dst_format,
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst) {
+  auto fn = getConvertKernel(kernel, dst_format);
+  if (!fn) {
+    fn = getConvertKernel(PixelKernel::SCALAR, dst_format);
+  }
+
+  fn(src, count, dst);
+}
+
+/*
+ * Colours with four equal bytes (transparent black, opaque white) are a
+ * memset. Otherwise the first row is filled by repeatedly doubling the filled
+ * prefix and then copied to the other rows, so that all the work is done by
+ * the (vectorized) libc memset/memcpy
+ */
+void fillPixels_ARGB32(
+    uint32_t pixel,
+    unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    size_t stride) {
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  auto row_len = size_t(width) * 4;
+  if (pixel == (pixel & 0xff) * 0x01010101u) {
+    if (stride == row_len) {
+      memset(data, pixel & 0xff, row_len * height);
+    } else {
+      for (uint32_t y = 0; y < height; ++y) {
+        memset(data + y * stride, pixel & 0xff, row_len);
+      }
+    }
+
+    return;
+  }
+
+  memcpy(data, &pixel, 4);
+  for (size_t filled = 4; filled < row_len; filled *= 2) {
+    memcpy(data + filled, data, std::min(filled, row_len - filled));
+  }
+
+  for (uint32_t y = 1; y < height; ++y) {
+    memcpy(data + y * stride, data, row_len);
+  }
+}
+
+} // namespace plotfx
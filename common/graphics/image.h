@@ -29,6 +29,7 @@
  */
 #pragma once
 #include <stdlib.h>
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include "colour.h"
@@ -79,6 +80,36 @@ Image convertImage_RGBA8_RGB8(const Image& img);
 
 size_t getPixelSize(PixelFormat pixel_format);
 
+/**
+ * Convert a run of premultiplied, native endian ARGB32 pixels (the cairo image
+ * surface format) to straight alpha RGBA8 or RGB8. Opaque pixels are only
+ * swizzled; converting to RGB8 drops the alpha channel
+ */
+void convertPixels_ARGB32(
+    PixelFormat dst_format,
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst);
+
+/**
+ * The instruction set variants of convertPixels_ARGB32. All variants produce
+ * identical output; convertPixels_ARGB32 picks the fastest one supported by
+ * the CPU. The explicit variants exist so tests and benchmarks can compare
+ * them against the scalar kernel
+ */
+enum class PixelKernel {
+  SCALAR, SSE41, AVX2
+};
+
+bool hasPixelKernel(PixelKernel kernel);
+
+void convertPixels_ARGB32(
+    PixelKernel kernel,
+    PixelFormat dst_format,
+    const uint32_t* src,
+    size_t count,
+    unsigned char* dst);
+
 void encodePixel(
     PixelFormat pixel_format,
     const Colour& colour,
@@ -90,5 +121,15 @@ Colour decodePixel(
     char* data,
     size_t size);
 
+/**
+ * Set every pixel of a 32 bit per pixel buffer to the given value
+ */
+void fillPixels_ARGB32(
+    uint32_t pixel,
+    unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    size_t stride);
+
 } // namespace plotfx
 
@@ -29,6 +29,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "layer.h"
+#include <utils/outputstream.h>
+#include <utils/profile.h>
 #include <utils/stringutil.h>
 #include "png.h"
 
@@ -41,24 +43,63 @@ Layer::Layer(
     double dpi /* = 96 */) :
     width(w),
     height(h),
+    opaque(false),
     measures{.dpi = dpi, .rem = rem},
     //pixmap(PixelFormat::RGBA8, w, h),
     text_shaper(dpi),
     rasterizer(w, h, measures) {}
 
+Layer::Layer(
+    DisplayList* recording,
+    double w,
+    double h,
+    double rem /* = 12 */,
+    double dpi /* = 96 */) :
+    width(w),
+    height(h),
+    opaque(false),
+    measures{.dpi = dpi, .rem = rem},
+    text_shaper(dpi),
+    rasterizer(1, 1, measures) {
+  rasterizer.beginRecording(recording);
+}
+
 Layer::~Layer() {}
 
-Status Layer::writeToFile(const std::string& path) {
-  if (StringUtil::endsWith(path, ".png")) {
-    auto rc = cairo_surface_write_to_png(rasterizer.cr_surface, path.c_str());
-    if (rc == CAIRO_STATUS_SUCCESS) {
-      return OK;
-    } else {
-      return ERROR_IO;
-    }
+Status Layer::writeToFile(
+    const std::string& path,
+    const PNGOptions& png_opts /* = PNGOptions() */) {
+  if (!StringUtil::endsWith(path, ".png")) {
+    return ERROR_INVALID_ARGUMENT;
   }
 
-  return ERROR_INVALID_ARGUMENT;
+  std::unique_ptr<FileOutputStream> os;
+  try {
+    os = FileOutputStream::openFile(path);
+  } catch (const std::exception& e) {
+    return ERROR_IO;
+  }
+
+  return writePNG(os.get(), png_opts);
+}
+
+Status Layer::writePNG(
+    OutputStream* os,
+    const PNGOptions& png_opts /* = PNGOptions() */) {
+  cairo_surface_flush(rasterizer.cr_surface);
+
+  CountingOutputStream counting_os(os);
+  auto rc = pngWriteARGB32(
+      cairo_image_surface_get_data(rasterizer.cr_surface),
+      cairo_image_surface_get_width(rasterizer.cr_surface),
+      cairo_image_surface_get_height(rasterizer.cr_surface),
+      cairo_image_surface_get_stride(rasterizer.cr_surface),
+      opaque ? PixelFormat::RGB8 : PixelFormat::RGBA8,
+      png_opts,
+      &counting_os);
+
+  profileCounter(ProfileCounter::BYTES_WRITTEN, counting_os.getCount());
+  return rc;
 }
 
 Status Layer::loadFromFile(const std::string& path) const {
@@ -66,14 +107,11 @@ Status Layer::loadFromFile(const std::string& path) const {
 }
 
 void Layer::clear(const Colour& c) {
-  cairo_set_source_rgba(
-      rasterizer.cr_ctx,
-      c.red(),
-      c.green(),
-      c.blue(),
-      c.alpha());
-
-  cairo_paint(rasterizer.cr_ctx);
+  /* layers may be reused across frames; start from a clean clip and replace
+   * the previous contents instead of blending over them */
+  rasterizer.resetClip();
+  rasterizer.clear(c);
+  opaque = c.alpha() >= 1.0;
 }
 
 double from_rem(const Layer& l, double v) {
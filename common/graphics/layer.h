@@ -39,23 +39,55 @@
 #include "rasterize.h"
 #include "image.h"
 #include "measure.h"
+#include "png.h"
 
 namespace plotfx {
+class DisplayList;
+class OutputStream;
 
 struct Layer {
   Layer();
   Layer(double width, double height, double rem = 12, double dpi = 96);
+
+  /**
+   * Create a layer of the given size that records all draw calls into the
+   * display list. No pixel buffer of the layer's size is allocated
+   */
+  Layer(
+      DisplayList* recording,
+      double width,
+      double height,
+      double rem = 12,
+      double dpi = 96);
+
   ~Layer();
   Layer(const Layer&) = delete;
   Layer& operator=(const Layer&) = delete;
 
-  Status writeToFile(const std::string& path);
+  Status writeToFile(
+      const std::string& path,
+      const PNGOptions& png_opts = PNGOptions());
+
+  /**
+   * Encode the layer's pixels as a PNG into the output stream
+   */
+  Status writePNG(
+      OutputStream* os,
+      const PNGOptions& png_opts = PNGOptions());
+
   Status loadFromFile(const std::string& path) const;
 
   void clear(const Colour& c);
 
   double width;
   double height;
+
+  /**
+   * Set if the layer was last cleared with an opaque colour. Drawing can not
+   * make any pixel transparent again, so PNG exports skip the alpha channel
+   */
+  bool opaque;
+
   MeasureTable measures;
   //Image pixmap;
   text::TextShaper text_shaper;
@@ -0,0 +1,159 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iterator>
+#include "layer_pool.h"
+
+namespace plotfx {
+
+void LayerPoolRelease::operator()(Layer* layer) const {
+  pool->release(layer);
+}
+
+LayerPool* LayerPool::get() {
+  static LayerPool pool;
+  return &pool;
+}
+
+LayerPool::LayerPool(
+    size_t max_idle /* = kDefaultMaxIdle */,
+    size_t memory_limit /* = kDefaultMemoryLimit */) :
+    max_idle_(max_idle),
+    memory_used_(0),
+    memory_limit_(memory_limit),
+    hits_(0),
+    misses_(0) {}
+
+LayerRef LayerPool::acquire(
+    double width,
+    double height,
+    double rem /* = 12 */,
+    double dpi /* = 96 */) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    /* prefer the most recently released layer; its pixels are still cached */
+    for (auto iter = idle_.rbegin(); iter != idle_.rend(); ++iter) {
+      if (iter->width == width &&
+          iter->height == height &&
+          iter->rem == rem &&
+          iter->dpi == dpi) {
+        auto layer = iter->layer.release();
+        memory_used_ -= iter->size;
+        idle_.erase(std::next(iter).base());
+        ++hits_;
+        return LayerRef(layer, LayerPoolRelease{this});
+      }
+    }
+
+    ++misses_;
+  }
+
+  return LayerRef(new Layer(width, height, rem, dpi), LayerPoolRelease{this});
+}
+
+void LayerPool::release(Layer* layer) {
+  std::unique_ptr<Layer> owned(layer);
+
+  /* don't hold on to huge surfaces (e.g. a poster sized export) for the
+   * lifetime of the process */
+  auto surface = owned->rasterizer.cr_surface;
+  size_t size =
+      size_t(cairo_image_surface_get_stride(surface)) *
+      cairo_image_surface_get_height(surface);
+
+  if (size > memory_limit_) {
+    return;
+  }
+
+  /* undo per-frame state so that the next user starts from a clean layer */
+  if (owned->rasterizer.recording) {
+    owned->rasterizer.endRecording();
+  }
+
+  owned->rasterizer.resetClip();
+  owned->rasterizer.setOrigin(0, 0);
+
+  /* text is drawn with the current cairo source; start from cairo's default
+   * as a fresh layer would */
+  cairo_new_path(owned->rasterizer.cr_ctx);
+  cairo_set_source_rgb(owned->rasterizer.cr_ctx, 0, 0, 0);
+
+  IdleLayer idle;
+  idle.width = owned->width;
+  idle.height = owned->height;
+  idle.rem = owned->measures.rem;
+  idle.dpi = owned->measures.dpi;
+  idle.size = size;
+  idle.layer = std::move(owned);
+
+  /* evicted layers are destroyed outside the lock */
+  std::vector<IdleLayer> evicted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_used_ += idle.size;
+    idle_.emplace_back(std::move(idle));
+
+    size_t evict_count = 0;
+    while (idle_.size() - evict_count > max_idle_ ||
+           memory_used_ > memory_limit_) {
+      memory_used_ -= idle_[evict_count].size;
+      ++evict_count;
+    }
+
+    evicted.insert(
+        evicted.end(),
+        std::make_move_iterator(idle_.begin()),
+        std::make_move_iterator(idle_.begin() + evict_count));
+    idle_.erase(idle_.begin(), idle_.begin() + evict_count);
+  }
+}
+
+void LayerPool::clear() {
+  std::vector<IdleLayer> idle;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle.swap(idle_);
+    memory_used_ = 0;
+  }
+}
+
+LayerPoolStats LayerPool::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LayerPoolStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.idle = idle_.size();
+  stats.memory_used = memory_used_;
+  stats.memory_limit = memory_limit_;
+  return stats;
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,122 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "layer.h"
+
+namespace plotfx {
+class LayerPool;
+
+/**
+ * Returns the layer to the pool it was acquired from
+ */
+struct LayerPoolRelease {
+  void operator()(Layer* layer) const;
+  LayerPool* pool;
+};
+
+using LayerRef = std::unique_ptr<Layer, LayerPoolRelease>;
+
+struct LayerPoolStats {
+  uint64_t hits;
+  uint64_t misses;
+  size_t idle;
+  size_t memory_used;
+  size_t memory_limit;
+};
+
+/**
+ * Pool of idle layers keyed by (width, height, rem, dpi). Acquiring a layer
+ * that matches an idle one reuses its pixel buffer and cairo context instead
+ * of allocating new ones. A reused layer keeps the pixels of its previous
+ * frame; callers are expected to clear() it before drawing. At most
+ * `max_idle` layers and `memory_limit` bytes of pixel data are kept idle;
+ * the least recently released layers are evicted first and layers larger
+ * than the memory limit are never pooled. Safe to use from multiple threads;
+ * the pool must outlive all layers acquired from it
+ */
+class LayerPool {
+public:
+
+  static const size_t kDefaultMaxIdle = 8;
+  static const size_t kDefaultMemoryLimit = 64 * 1024 * 1024;
+
+  /**
+   * Process-wide pool used by the render functions
+   */
+  static LayerPool* get();
+
+  explicit LayerPool(
+      size_t max_idle = kDefaultMaxIdle,
+      size_t memory_limit = kDefaultMemoryLimit);
+  LayerPool(const LayerPool&) = delete;
+  LayerPool& operator=(const LayerPool&) = delete;
+
+  LayerRef acquire(
+      double width,
+      double height,
+      double rem = 12,
+      double dpi = 96);
+
+  /**
+   * Drop all idle layers
+   */
+  void clear();
+
+  LayerPoolStats getStats() const;
+
+protected:
+  friend struct LayerPoolRelease;
+
+  struct IdleLayer {
+    double width;
+    double height;
+    double rem;
+    double dpi;
+    size_t size;
+    std::unique_ptr<Layer> layer;
+  };
+
+  void release(Layer* layer);
+
+  size_t max_idle_;
+  size_t memory_used_;
+  size_t memory_limit_;
+  mutable std::mutex mutex_;
+  std::vector<IdleLayer> idle_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+} // namespace plotfx
+
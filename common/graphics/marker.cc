@@ -0,0 +1,227 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <math.h>
+#include <algorithm>
+#include "marker.h"
+
+namespace plotfx {
+
+/* supersampling factor per axis when rendering the masks */
+static const uint32_t kMarkerSupersampling = 8;
+
+/* sprite sizes are quantized to 1/16 px for caching */
+static const double kMarkerSizeQuantum = 16;
+
+MarkerStyle::MarkerStyle() :
+    shape(MarkerShape::CIRCLE),
+    size(Unit::PT, 4),
+    colour(Colour::fromRGB(0, 0, 0)) {}
+
+MarkerSprite::MarkerSprite(
+    MarkerShape shape,
+    double size) :
+    size_(std::max(size, 0.0)) {
+  /* one extra pixel for the sub-pixel offset and one for rounding */
+  mask_size_ = uint32_t(ceil(size_)) + 2;
+
+  auto mask_len = mask_size_ * mask_size_;
+  masks_.resize(mask_len * kMarkerSubpixelSteps * kMarkerSubpixelSteps);
+
+  auto radius = size_ / 2;
+  auto samples = kMarkerSupersampling * kMarkerSupersampling;
+  for (uint32_t oy = 0; oy < kMarkerSubpixelSteps; ++oy) {
+    for (uint32_t ox = 0; ox < kMarkerSubpixelSteps; ++ox) {
+      auto mask = &masks_[(oy * kMarkerSubpixelSteps + ox) * mask_len];
+
+      /* the marker's bounding box starts at the sub-pixel offset */
+      auto cx = double(ox) / kMarkerSubpixelSteps + radius;
+      auto cy = double(oy) / kMarkerSubpixelSteps + radius;
+
+      for (uint32_t py = 0; py < mask_size_; ++py) {
+        for (uint32_t px = 0; px < mask_size_; ++px) {
+          uint32_t hits = 0;
+          for (uint32_t sy = 0; sy < kMarkerSupersampling; ++sy) {
+            for (uint32_t sx = 0; sx < kMarkerSupersampling; ++sx) {
+              auto x = px + (sx + 0.5) / kMarkerSupersampling - cx;
+              auto y = py + (sy + 0.5) / kMarkerSupersampling - cy;
+
+              bool inside = false;
+              switch (shape) {
+                case MarkerShape::CIRCLE:
+                  inside = x * x + y * y <= radius * radius;
+                  break;
+                case MarkerShape::SQUARE:
+                  inside = fabs(x) <= radius && fabs(y) <= radius;
+                  break;
+              }
+
+              hits += inside;
+            }
+          }
+
+          mask[py * mask_size_ + px] = (hits * 255 + samples / 2) / samples;
+        }
+      }
+    }
+  }
+}
+
+uint32_t MarkerSprite::getMaskSize() const {
+  return mask_size_;
+}
+
+const uint8_t* MarkerSprite::getMask(uint32_t offset_x, uint32_t offset_y) const {
+  auto mask_len = mask_size_ * mask_size_;
+  return &masks_[(offset_y * kMarkerSubpixelSteps + offset_x) * mask_len];
+}
+
+double MarkerSprite::getSize() const {
+  return size_;
+}
+
+MarkerSpriteCache* MarkerSpriteCache::get() {
+  static MarkerSpriteCache cache;
+  return &cache;
+}
+
+MarkerSpriteRef MarkerSpriteCache::getSprite(MarkerShape shape, double size) {
+  auto size_key = int64_t(llround(size * kMarkerSizeQuantum));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& sprite = sprites_[std::make_pair(shape, size_key)];
+  if (!sprite) {
+    sprite = std::make_shared<MarkerSprite>(shape, size_key / kMarkerSizeQuantum);
+  }
+
+  return sprite;
+}
+
+void MarkerSpriteCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sprites_.clear();
+}
+
+/* x / 255, rounded, for x in [0, 255 * 255] */
+static inline uint32_t div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+void blitMarkers(
+    const MarkerSprite& sprite,
+    const Colour& colour,
+    const double* coords,
+    size_t count,
+    const Rectangle& clip,
+    double origin_x,
+    double origin_y,
+    unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t stride,
+    uint32_t row_begin,
+    uint32_t row_end) {
+  /* pixel bounds of the clip (pixels whose center is inside) */
+  auto clip_x0 = std::max(
+      int64_t(ceil(clip.x - origin_x - 0.5)),
+      int64_t(0));
+  auto clip_y0 = std::max(
+      int64_t(ceil(clip.y - origin_y - 0.5)),
+      int64_t(row_begin));
+  auto clip_x1 = std::min(
+      int64_t(ceil(clip.x + clip.w - origin_x - 0.5)),
+      int64_t(width));
+  auto clip_y1 = std::min(
+      int64_t(ceil(clip.y + clip.h - origin_y - 0.5)),
+      int64_t(std::min(row_end, height)));
+
+  if (clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+    return;
+  }
+
+  /* premultiplied source colour */
+  auto alpha = std::clamp(colour.alpha(), 0.0, 1.0);
+  uint32_t src[4] = {
+    uint32_t(lround(std::clamp(colour.blue(), 0.0, 1.0) * alpha * 255)),
+    uint32_t(lround(std::clamp(colour.green(), 0.0, 1.0) * alpha * 255)),
+    uint32_t(lround(std::clamp(colour.red(), 0.0, 1.0) * alpha * 255)),
+    uint32_t(lround(alpha * 255)),
+  };
+
+  auto mask_size = int64_t(sprite.getMaskSize());
+  auto radius = sprite.getSize() / 2;
+  for (size_t i = 0; i < count; ++i) {
+    auto left = coords[i * 2] - origin_x - radius;
+    auto top = coords[i * 2 + 1] - origin_y - radius;
+    if (!(left > -1e9 && left < 1e9 && top > -1e9 && top < 1e9)) {
+      continue; // NaN or far out of range
+    }
+
+    /* integer position and quantized sub-pixel offset of the mask */
+    auto qx = llround(left * kMarkerSubpixelSteps);
+    auto qy = llround(top * kMarkerSubpixelSteps);
+    auto ox = int64_t(floor(double(qx) / kMarkerSubpixelSteps));
+    auto oy = int64_t(floor(double(qy) / kMarkerSubpixelSteps));
+    auto mask = sprite.getMask(
+        uint32_t(qx - ox * kMarkerSubpixelSteps),
+        uint32_t(qy - oy * kMarkerSubpixelSteps));
+
+    auto x0 = std::max(ox, clip_x0);
+    auto x1 = std::min(ox + mask_size, clip_x1);
+    auto y0 = std::max(oy, clip_y0);
+    auto y1 = std::min(oy + mask_size, clip_y1);
+
+    for (auto y = y0; y < y1; ++y) {
+      auto mask_row = mask + (y - oy) * mask_size - ox;
+      auto row = reinterpret_cast<uint32_t*>(data + y * stride);
+      for (auto x = x0; x < x1; ++x) {
+        uint32_t m = mask_row[x];
+        if (m == 0) {
+          continue;
+        }
+
+        auto sa = div255(src[3] * m);
+        auto inv = 255 - sa;
+        auto d = row[x];
+        uint32_t out = 0;
+        for (uint32_t c = 0; c < 4; ++c) {
+          auto dc = (d >> (c * 8)) & 0xff;
+          auto sc = c == 3 ? sa : div255(src[c] * m);
+          out |= std::min(sc + div255(dc * inv), 255u) << (c * 8);
+        }
+
+        row[x] = out;
+      }
+    }
+  }
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,137 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "colour.h"
+#include "layout.h"
+#include "measure.h"
+
+namespace plotfx {
+
+enum class MarkerShape : uint8_t {
+  CIRCLE,
+  SQUARE
+};
+
+struct MarkerStyle {
+  MarkerStyle();
+  MarkerShape shape;
+  Measure size;
+  Colour colour;
+};
+
+/**
+ * Number of quantized sub-pixel positions per axis at which markers are
+ * pre-rasterized
+ */
+const uint32_t kMarkerSubpixelSteps = 4;
+
+/**
+ * Anti-aliased coverage masks of one marker shape and size, rendered once for
+ * each of the kMarkerSubpixelSteps^2 sub-pixel offsets. Markers are drawn by
+ * blending the mask for the marker's (quantized) position into the surface
+ */
+class MarkerSprite {
+public:
+
+  MarkerSprite(MarkerShape shape, double size);
+
+  /**
+   * Width and height of each mask in pixels
+   */
+  uint32_t getMaskSize() const;
+
+  /**
+   * The mask for the given sub-pixel offset (in 1/kMarkerSubpixelSteps px)
+   */
+  const uint8_t* getMask(uint32_t offset_x, uint32_t offset_y) const;
+
+  /**
+   * Diameter (circles) or edge length (squares) in pixels
+   */
+  double getSize() const;
+
+protected:
+  double size_;
+  uint32_t mask_size_;
+  std::vector<uint8_t> masks_;
+};
+
+using MarkerSpriteRef = std::shared_ptr<const MarkerSprite>;
+
+/**
+ * Process-wide cache of marker sprites keyed by shape and size. Safe to use
+ * from multiple threads
+ */
+class MarkerSpriteCache {
+public:
+
+  static MarkerSpriteCache* get();
+
+  MarkerSpriteRef getSprite(MarkerShape shape, double size);
+
+  void clear();
+
+protected:
+  std::mutex mutex_;
+  std::map<std::pair<MarkerShape, int64_t>, MarkerSpriteRef> sprites_;
+};
+
+/**
+ * Blend one marker sprite centered at each of the given points into an
+ * ARGB32 (premultiplied, native endian) pixel buffer, in point order. Points
+ * are given as interleaved x/y pairs; the top-left pixel of the buffer is at
+ * (origin_x, origin_y). Nothing outside the clip rectangle is touched.
+ *
+ * Only the rows in [row_begin, row_end) are written so that disjoint row
+ * ranges of the same buffer can be processed in parallel
+ */
+void blitMarkers(
+    const MarkerSprite& sprite,
+    const Colour& colour,
+    const double* coords,
+    size_t count,
+    const Rectangle& clip,
+    double origin_x,
+    double origin_y,
+    unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t stride,
+    uint32_t row_begin,
+    uint32_t row_end);
+
+} // namespace plotfx
+
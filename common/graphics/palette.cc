@@ -0,0 +1,338 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <algorithm>
+#include "palette.h"
+
+namespace plotfx {
+
+static const size_t kHistogramBits = 5;
+static const size_t kHistogramSize = size_t(1) << (kHistogramBits * 4);
+
+static inline uint32_t loadColour(const unsigned char* rgba) {
+  uint32_t c;
+  memcpy(&c, rgba, 4);
+  return c;
+}
+
+static inline uint32_t getBucket(const unsigned char* rgba) {
+  return
+      uint32_t(rgba[0] >> 3) |
+      uint32_t(rgba[1] >> 3) << 5 |
+      uint32_t(rgba[2] >> 3) << 10 |
+      uint32_t(rgba[3] >> 3) << 15;
+}
+
+static inline uint32_t getBucketChannel(uint32_t bucket, size_t channel) {
+  return (bucket >> (channel * kHistogramBits)) & 0x1f;
+}
+
+/* maps 0 to 0 and 31 to 255 so that opaque colours stay opaque */
+static inline uint32_t expandChannel(uint32_t v) {
+  return (v << 3) | (v >> 2);
+}
+
+static inline bool isTranslucent(uint32_t colour) {
+  unsigned char rgba[4];
+  memcpy(rgba, &colour, 4);
+  return rgba[3] != 255;
+}
+
+ColourHistogram::ColourHistogram() : counts(kHistogramSize, 0) {}
+
+void ColourHistogram::add(const unsigned char* rgba, size_t count) {
+  for (size_t i = 0; i < count; ++i, rgba += 4) {
+    ++counts[getBucket(rgba)];
+  }
+}
+
+Palette::Palette() :
+    table_keys_(kTableSize, 0),
+    table_indices_(kTableSize, -1) {}
+
+static inline size_t hashColour(uint32_t colour) {
+  return (colour * 0x9e3779b1u) >> 22;
+}
+
+bool Palette::insert(uint32_t colour) {
+  for (auto slot = hashColour(colour); ; slot = (slot + 1) % kTableSize) {
+    if (table_indices_[slot] < 0) {
+      if (colours_.size() == kMaxColours) {
+        return false;
+      }
+
+      table_keys_[slot] = colour;
+      table_indices_[slot] = colours_.size();
+      colours_.push_back(colour);
+      return true;
+    }
+
+    if (table_keys_[slot] == colour) {
+      return true;
+    }
+  }
+}
+
+uint8_t Palette::lookup(uint32_t colour) const {
+  for (auto slot = hashColour(colour); ; slot = (slot + 1) % kTableSize) {
+    if (table_indices_[slot] < 0 || table_keys_[slot] == colour) {
+      return std::max(table_indices_[slot], int16_t(0));
+    }
+  }
+}
+
+bool Palette::addColours(const unsigned char* rgba, size_t count) {
+  /* most pixels repeat their left neighbour; skip the table for those */
+  uint32_t last = 0;
+  for (size_t i = 0; i < count; ++i, rgba += 4) {
+    auto colour = loadColour(rgba);
+    if (i > 0 && colour == last) {
+      continue;
+    }
+
+    if (!insert(colour)) {
+      return false;
+    }
+
+    last = colour;
+  }
+
+  return true;
+}
+
+bool Palette::merge(const Palette& other) {
+  for (auto colour : other.colours_) {
+    if (!insert(colour)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Palette::finish() {
+  std::vector<uint8_t> order(colours_.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+
+  std::stable_sort(order.begin(), order.end(), [this] (uint8_t a, uint8_t b) {
+    return isTranslucent(colours_[a]) && !isTranslucent(colours_[b]);
+  });
+
+  std::vector<uint8_t> new_index(colours_.size());
+  std::vector<uint32_t> colours(colours_.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    new_index[order[i]] = i;
+    colours[i] = colours_[order[i]];
+  }
+
+  colours_.swap(colours);
+
+  for (auto& idx : table_indices_) {
+    if (idx >= 0) {
+      idx = new_index[idx];
+    }
+  }
+
+  for (auto& idx : bucket_indices_) {
+    idx = new_index[idx];
+  }
+}
+
+void Palette::mapPixels(
+    const unsigned char* rgba,
+    size_t count,
+    uint8_t* indices) const {
+  if (!bucket_indices_.empty()) {
+    for (size_t i = 0; i < count; ++i, rgba += 4) {
+      indices[i] = bucket_indices_[getBucket(rgba)];
+    }
+
+    return;
+  }
+
+  uint32_t last = 0;
+  uint8_t last_index = 0;
+  for (size_t i = 0; i < count; ++i, rgba += 4) {
+    auto colour = loadColour(rgba);
+    if (i == 0 || colour != last) {
+      last = colour;
+      last_index = lookup(colour);
+    }
+
+    indices[i] = last_index;
+  }
+}
+
+size_t Palette::size() const {
+  return colours_.size();
+}
+
+const std::vector<uint32_t>& Palette::getColours() const {
+  return colours_;
+}
+
+size_t Palette::getTranslucentCount() const {
+  return std::count_if(colours_.begin(), colours_.end(), isTranslucent);
+}
+
+bool Palette::isQuantized() const {
+  return !bucket_indices_.empty();
+}
+
+namespace {
+
+struct HistogramBucket {
+  uint32_t bucket;
+  uint32_t count;
+};
+
+struct MedianCutBox {
+  size_t begin;
+  size_t end;
+  uint64_t count;
+  size_t channel;
+  uint32_t range;
+};
+
+} // namespace
+
+static void computeBox(
+    const std::vector<HistogramBucket>& buckets,
+    MedianCutBox* box) {
+  uint32_t min[4] = {31, 31, 31, 31};
+  uint32_t max[4] = {0, 0, 0, 0};
+  box->count = 0;
+  for (auto i = box->begin; i < box->end; ++i) {
+    box->count += buckets[i].count;
+    for (size_t c = 0; c < 4; ++c) {
+      auto v = getBucketChannel(buckets[i].bucket, c);
+      min[c] = std::min(min[c], v);
+      max[c] = std::max(max[c], v);
+    }
+  }
+
+  box->channel = 0;
+  box->range = 0;
+  for (size_t c = 0; c < 4; ++c) {
+    if (max[c] - min[c] > box->range) {
+      box->channel = c;
+      box->range = max[c] - min[c];
+    }
+  }
+}
+
+void palette_median_cut(
+    const ColourHistogram& histogram,
+    size_t max_colours,
+    Palette* palette) {
+  max_colours = std::clamp(max_colours, size_t(1), Palette::kMaxColours);
+
+  std::vector<HistogramBucket> buckets;
+  for (size_t i = 0; i < histogram.counts.size(); ++i) {
+    if (histogram.counts[i] > 0) {
+      buckets.emplace_back(HistogramBucket{uint32_t(i), histogram.counts[i]});
+    }
+  }
+
+  std::vector<MedianCutBox> boxes;
+  boxes.emplace_back(MedianCutBox{0, buckets.size(), 0, 0, 0});
+  computeBox(buckets, &boxes[0]);
+
+  while (boxes.size() < max_colours) {
+    /* split the box with the most pixels times the widest spread */
+    size_t split = boxes.size();
+    uint64_t split_score = 0;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      auto score = boxes[i].count * boxes[i].range;
+      if (score > split_score) {
+        split = i;
+        split_score = score;
+      }
+    }
+
+    if (split == boxes.size()) {
+      break;
+    }
+
+    auto box = boxes[split];
+    auto channel = box.channel;
+    std::sort(
+        buckets.begin() + box.begin,
+        buckets.begin() + box.end,
+        [channel] (const HistogramBucket& a, const HistogramBucket& b) {
+          return
+              getBucketChannel(a.bucket, channel) <
+              getBucketChannel(b.bucket, channel);
+        });
+
+    /* weighted median; both halves keep at least one bucket */
+    auto mid = box.begin;
+    uint64_t acc = 0;
+    while (mid + 1 < box.end && (acc += buckets[mid].count) < box.count / 2) {
+      ++mid;
+    }
+
+    mid = std::clamp(mid + 1, box.begin + 1, box.end - 1);
+
+    MedianCutBox lower{box.begin, mid, 0, 0, 0};
+    MedianCutBox upper{mid, box.end, 0, 0, 0};
+    computeBox(buckets, &lower);
+    computeBox(buckets, &upper);
+    boxes[split] = lower;
+    boxes.emplace_back(upper);
+  }
+
+  palette->colours_.clear();
+  palette->bucket_indices_.assign(kHistogramSize, 0);
+  for (const auto& box : boxes) {
+    uint64_t sums[4] = {0, 0, 0, 0};
+    for (auto i = box.begin; i < box.end; ++i) {
+      for (size_t c = 0; c < 4; ++c) {
+        sums[c] +=
+            uint64_t(expandChannel(getBucketChannel(buckets[i].bucket, c))) *
+            buckets[i].count;
+      }
+
+      palette->bucket_indices_[buckets[i].bucket] = palette->colours_.size();
+    }
+
+    unsigned char rgba[4];
+    for (size_t c = 0; c < 4; ++c) {
+      rgba[c] = box.count ? (sums[c] + box.count / 2) / box.count : 0;
+    }
+
+    palette->colours_.emplace_back(loadColour(rgba));
+  }
+}
+
+} // namespace plotfx
+
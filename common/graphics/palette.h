@@ -0,0 +1,128 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+namespace plotfx {
+
+/**
+ * Histogram of straight alpha RGBA8 colours with each channel reduced to its
+ * top five bits (2^20 buckets)
+ */
+struct ColourHistogram {
+  ColourHistogram();
+
+  void add(const unsigned char* rgba, size_t count);
+
+  std::vector<uint32_t> counts;
+};
+
+/**
+ * An indexed colour table of at most 256 straight alpha RGBA8 colours and the
+ * mapping from pixels to palette indices. Colours are stored as the four
+ * RGBA8 bytes of a pixel, in memory order, loaded into a uint32_t.
+ *
+ * A palette is either exact (built from the distinct colours of an image
+ * with addColours) or quantized (built from a histogram with
+ * palette_median_cut), in which case pixels map to the nearby colour chosen
+ * for their histogram bucket
+ */
+class Palette {
+public:
+
+  static constexpr size_t kMaxColours = 256;
+
+  Palette();
+
+  /**
+   * Add the distinct colours of a run of RGBA8 pixels. Returns false once
+   * the run would bring the palette above kMaxColours colours; the palette
+   * must not be used after that
+   */
+  bool addColours(const unsigned char* rgba, size_t count);
+
+  /**
+   * Add the colours of another exact palette; same return value as
+   * addColours
+   */
+  bool merge(const Palette& other);
+
+  /**
+   * Reorder the colours so that all translucent colours come first (so that
+   * the PNG tRNS chunk can stop at the last translucent entry). Must be
+   * called once all colours have been added and before mapping pixels
+   */
+  void finish();
+
+  /**
+   * Map a run of RGBA8 pixels to palette indices. Every pixel of an exact
+   * palette must have been added before
+   */
+  void mapPixels(const unsigned char* rgba, size_t count, uint8_t* indices) const;
+
+  size_t size() const;
+  const std::vector<uint32_t>& getColours() const;
+
+  /**
+   * Number of leading colours that are not fully opaque
+   */
+  size_t getTranslucentCount() const;
+
+  bool isQuantized() const;
+
+protected:
+  friend void palette_median_cut(const ColourHistogram&, size_t, Palette*);
+
+  static constexpr size_t kTableSize = 1024;
+
+  bool insert(uint32_t colour);
+  uint8_t lookup(uint32_t colour) const;
+
+  std::vector<uint32_t> colours_;
+  std::vector<uint32_t> table_keys_;
+  std::vector<int16_t> table_indices_;
+  std::vector<uint8_t> bucket_indices_;
+};
+
+/**
+ * Build a quantized palette of at most max_colours colours from the
+ * histogram using median cut: the bucket set is repeatedly split at the
+ * weighted median of its widest channel, then each box is represented by the
+ * weighted mean of its buckets
+ */
+void palette_median_cut(
+    const ColourHistogram& histogram,
+    size_t max_colours,
+    Palette* palette);
+
+} // namespace plotfx
+
@@ -46,6 +46,14 @@ Path::Path(const PathData* data, size_t size) {
   }
 }
 
+void Path::reserve(size_t size) {
+  data_.reserve(size);
+}
+
+void Path::clear() {
+  data_.clear();
+}
+
 void Path::moveTo(double x, double y) {
   PathData d;
   d.command = PathCommand::MOVE_TO;
@@ -65,6 +65,9 @@ public:
   void arcTo(double cx, double cy, double r, double a1, double a2);
   void closePath();
 
+  void reserve(size_t size);
+  void clear();
+
   const PathData& operator[](size_t idx) const;
   PathData& operator[](size_t idx);
 
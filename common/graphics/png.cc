@@ -28,78 +28,757 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include <png.h>
 #include <string.h>
+#include <zlib.h>
+#include "palette.h"
 #include "png.h"
 #include "utils/file.h"
 #include "utils/fileutil.h"
+#include "utils/outputstream.h"
+#include "utils/profile.h"
 
 namespace plotfx {
 
-Status pngWriteImageFile(
-    const Image& image,
-    const std::string& filename) {
+PNGOptions::PNGOptions() :
+    compression_level(6),
+    threads(1),
+    indexed(false) {}
+
+PNGWriter::PNGWriter(
+    OutputStream* os,
+    const PNGOptions& opts /* = PNGOptions() */) :
+    os_(os),
+    opts_(opts),
+    png_(nullptr),
+    png_info_(nullptr),
+    width_(0),
+    height_(0),
+    rows_written_(0),
+    pixel_format_(PixelFormat::RGBA8) {}
+
+PNGWriter::~PNGWriter() {
+  destroy();
+}
+
+void PNGWriter::destroy() {
+  if (png_) {
+    png_destroy_write_struct(&png_, png_info_ ? &png_info_ : nullptr);
+  }
+
+  png_ = nullptr;
+  png_info_ = nullptr;
+}
+
+/* libpng emits many small writes (chunk headers, crcs); batch them up */
+static const size_t kFlushThreshold = 1 << 16;
+
+void PNGWriter::writeCallback(png_structp png, png_bytep data, size_t size) {
+  auto writer = static_cast<PNGWriter*>(png_get_io_ptr(png));
+  writer->out_buf_.append(reinterpret_cast<const char*>(data), size);
+  if (writer->out_buf_.size() >= kFlushThreshold && !writer->flushOutput()) {
+    png_error(png, "write error");
+  }
+}
+
+void PNGWriter::flushCallback(png_structp /* png */) {}
+
+bool PNGWriter::flushOutput() {
+  try {
+    for (size_t pos = 0; pos < out_buf_.size(); ) {
+      auto n = os_->write(out_buf_.data() + pos, out_buf_.size() - pos);
+      if (n == 0) {
+        return false;
+      }
+
+      pos += n;
+    }
+  } catch (const std::exception& e) {
+    return false;
+  }
+
+  out_buf_.clear();
+  return true;
+}
+
+Status PNGWriter::begin(
+    uint32_t width,
+    uint32_t height,
+    PixelFormat pixel_format) {
   int color_type;
-  int bit_depth;
-  switch (image.getPixelFormat()) {
+  switch (pixel_format) {
     case PixelFormat::RGB8:
-      bit_depth = 8;
       color_type = PNG_COLOR_TYPE_RGB;
       break;
     case PixelFormat::RGBA8:
-      bit_depth = 8;
       color_type = PNG_COLOR_TYPE_RGB_ALPHA;
       break;
     default:
       return ERROR_INVALID_ARGUMENT;
   }
 
-  FILE* file = fopen(filename.c_str(), "wb");
+  if (png_ || width == 0 || height == 0) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  png_ = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (!png_) {
+    return ERROR_IO;
+  }
 
-  auto png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-  if (!png) {
-    fclose(file);
+  png_info_ = png_create_info_struct(png_);
+  if (!png_info_) {
+    destroy();
     return ERROR_IO;
   }
 
-  auto png_info = png_create_info_struct(png);
-  if (!png_info) {
-    fclose(file);
-    png_destroy_write_struct(&png, NULL);
+  width_ = width;
+  height_ = height;
+  rows_written_ = 0;
+  pixel_format_ = pixel_format;
+  out_buf_.clear();
+  row_buf_.resize(size_t(width) * getPixelSize(pixel_format));
+
+  if (setjmp(png_jmpbuf(png_))) {
+    destroy();
     return ERROR_IO;
   }
 
-  png_init_io(png, file);
+  png_set_write_fn(png_, this, &PNGWriter::writeCallback, &PNGWriter::flushCallback);
+  png_set_compression_level(png_, std::clamp(opts_.compression_level, 0, 9));
 
   png_set_IHDR(
-      png,
-      png_info,
-      image.getWidth(),
-      image.getHeight(),
-      bit_depth,
+      png_,
+      png_info_,
+      width,
+      height,
+      8,
       color_type,
       PNG_INTERLACE_NONE,
       PNG_COMPRESSION_TYPE_BASE,
       PNG_FILTER_TYPE_BASE);
 
-  png_write_info(png, png_info);
+  png_write_info(png_, png_info_);
+  return OK;
+}
+
+Status PNGWriter::writeRows(
+    const void* data,
+    uint32_t row_count,
+    size_t stride) {
+  if (!png_ || row_count > height_ - rows_written_) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  if (setjmp(png_jmpbuf(png_))) {
+    destroy();
+    return ERROR_IO;
+  }
+
+  auto row = static_cast<const unsigned char*>(data);
+  for (uint32_t y = 0; y < row_count; ++y, row += stride) {
+    png_write_row(png_, row);
+  }
+
+  rows_written_ += row_count;
+  return OK;
+}
+
+Status PNGWriter::writeRowsARGB32(
+    const unsigned char* data,
+    uint32_t row_count,
+    size_t stride) {
+  if (!png_ || row_count > height_ - rows_written_) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  if (setjmp(png_jmpbuf(png_))) {
+    destroy();
+    return ERROR_IO;
+  }
+
+  for (uint32_t y = 0; y < row_count; ++y, data += stride) {
+    convertPixels_ARGB32(
+        pixel_format_,
+        reinterpret_cast<const uint32_t*>(data),
+        width_,
+        row_buf_.data());
+
+    png_write_row(png_, row_buf_.data());
+  }
+
+  rows_written_ += row_count;
+  return OK;
+}
+
+Status PNGWriter::finish() {
+  if (!png_ || rows_written_ != height_) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  if (setjmp(png_jmpbuf(png_))) {
+    destroy();
+    return ERROR_IO;
+  }
+
+  png_write_end(png_, NULL);
+  destroy();
+  return flushOutput() ? OK : ERROR_IO;
+}
+
+/* branch-free so that the filter loop can be vectorized */
+static inline int paethPredictor(int a, int b, int c) {
+  auto pa = abs(b - c);
+  auto pb = abs(a - c);
+  auto pc = abs(a + b - 2 * c);
+  auto bc = pb <= pc ? b : c;
+  return pa <= pb && pa <= pc ? a : bc;
+}
+
+static inline uint32_t filterCost(uint8_t v) {
+  return abs(int(int8_t(v)));
+}
+
+/**
+ * Filter one row. With `adaptive` set, every filter type is tried and the one
+ * with the smallest sum of absolute values is kept (the heuristic recommended
+ * by the PNG spec); otherwise the row is stored unfiltered. The output is the
+ * filter type byte followed by `len` filtered bytes
+ */
+static void filterRow(
+    const uint8_t* row,
+    const uint8_t* prev,
+    size_t len,
+    size_t bpp,
+    bool adaptive,
+    uint8_t* out,
+    uint8_t* scratch) {
+  if (!adaptive) {
+    out[0] = PNG_FILTER_VALUE_NONE;
+    memcpy(out + 1, row, len);
+    return;
+  }
+
+  /* repeated rows (background, flat areas) are common in plots */
+  if (memcmp(row, prev, len) == 0) {
+    out[0] = PNG_FILTER_VALUE_UP;
+    memset(out + 1, 0, len);
+    return;
+  }
+
+  auto sub = scratch;
+  auto up = scratch + len;
+  auto avg = scratch + len * 2;
+  auto paeth = scratch + len * 3;
+
+  /* the first pixel has no left neighbour */
+  auto head = std::min(bpp, len);
+  for (size_t i = 0; i < head; ++i) {
+    int b = prev[i];
+    sub[i] = row[i];
+    up[i] = row[i] - b;
+    avg[i] = row[i] - (b >> 1);
+    paeth[i] = row[i] - b;
+  }
+
+  for (size_t i = head; i < len; ++i) {
+    int a = row[i - bpp];
+    int b = prev[i];
+    int c = prev[i - bpp];
+    sub[i] = row[i] - a;
+    up[i] = row[i] - b;
+    avg[i] = row[i] - ((a + b) >> 1);
+    paeth[i] = row[i] - paethPredictor(a, b, c);
+  }
+
+  uint32_t cost[5] = {0, 0, 0, 0, 0};
+  for (size_t i = 0; i < len; ++i) {
+    cost[0] += filterCost(row[i]);
+    cost[1] += filterCost(sub[i]);
+    cost[2] += filterCost(up[i]);
+    cost[3] += filterCost(avg[i]);
+    cost[4] += filterCost(paeth[i]);
+  }
+
+  const uint8_t* candidates[] = {row, sub, up, avg, paeth};
+  size_t best = 0;
+  for (size_t f = 1; f < 5; ++f) {
+    if (cost[f] < cost[best]) {
+      best = f;
+    }
+  }
+
+  out[0] = best;
+  memcpy(out + 1, candidates[best], len);
+}
+
+/* run fn(0) .. fn(task_count - 1) on up to thread_count threads */
+template <typename F>
+static void runParallel(size_t thread_count, size_t task_count, F fn) {
+  std::atomic<size_t> next_task(0);
+  auto worker = [&next_task, task_count, &fn] () {
+    for (;;) {
+      auto i = next_task++;
+      if (i >= task_count) {
+        break;
+      }
+
+      fn(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(thread_count, task_count); ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+/* chunks smaller than this compress noticeably worse than one stream */
+static const size_t kMinDeflateChunkSize = 1 << 18;
+static const size_t kDeflateWindowSize = 1 << 15;
+static const size_t kMaxDeflateInput = 1 << 30;
+static const size_t kMaxIDATSize = 1 << 30;
+
+/**
+ * Deflate one chunk of the filtered image data as a raw deflate stream. All
+ * chunks but the last end with a sync flush (so they can be concatenated)
+ * and are primed with the preceding 32KiB as a dictionary (so the ratio is
+ * almost as good as that of a single stream)
+ */
+static bool deflateChunk(
+    const uint8_t* data,
+    size_t len,
+    size_t dict_len,
+    int level,
+    bool last,
+    std::vector<uint8_t>* out) {
+  z_stream z;
+  memset(&z, 0, sizeof(z));
+  if (deflateInit2(&z, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  bool ok = true;
+  if (dict_len > 0) {
+    ok = deflateSetDictionary(&z, data - dict_len, dict_len) == Z_OK;
+  }
+
+  out->resize(deflateBound(&z, std::min(len, kMaxDeflateInput)) + 64);
+  size_t out_len = 0;
+  for (size_t pos = 0; ok; ) {
+    auto n = std::min(len - pos, kMaxDeflateInput);
+    auto final_input = pos + n == len;
+    z.next_in = const_cast<Bytef*>(data + pos);
+    z.avail_in = n;
+
+    int flush = Z_NO_FLUSH;
+    if (final_input) {
+      flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    }
+
+    do {
+      if (out->size() - out_len < 64) {
+        out->resize(out->size() * 2);
+      }
+
+      auto avail = std::min(out->size() - out_len, kMaxDeflateInput);
+      z.next_out = out->data() + out_len;
+      z.avail_out = avail;
+      if (deflate(&z, flush) == Z_STREAM_ERROR) {
+        ok = false;
+        break;
+      }
+
+      out_len += avail - z.avail_out;
+    } while (z.avail_out == 0);
 
-  std::vector<uint8_t> buf(sizeof(png_bytep) * image.getHeight());
-  for (size_t i = 0; i < image.getHeight(); i++) {
-    auto row = ((char *) image.getData()) + i * image.getPixelSize() * image.getWidth();
-    ((png_bytepp) buf.data())[i] = (png_byte *) row;
+    pos += n;
+    if (final_input) {
+      break;
+    }
+  }
+
+  deflateEnd(&z);
+  out->resize(out_len);
+  return ok;
+}
+
+static bool writeAll(OutputStream* os, const void* data, size_t len) {
+  try {
+    for (size_t pos = 0; pos < len; ) {
+      auto n = os->write(static_cast<const char*>(data) + pos, len - pos);
+      if (n == 0) {
+        return false;
+      }
+
+      pos += n;
+    }
+  } catch (const std::exception& e) {
+    return false;
+  }
+
+  return true;
+}
+
+static void writeUInt32BE(uint32_t v, uint8_t* out) {
+  out[0] = v >> 24;
+  out[1] = v >> 16;
+  out[2] = v >> 8;
+  out[3] = v;
+}
+
+static bool writePNGChunk(
+    OutputStream* os,
+    const char* type,
+    const uint8_t* data,
+    size_t len) {
+  uint8_t header[8];
+  writeUInt32BE(len, header);
+  memcpy(header + 4, type, 4);
+
+  auto crc = crc32(0, header + 4, 4);
+  if (len > 0) {
+    crc = crc32_z(crc, data, len);
+  }
+
+  uint8_t trailer[4];
+  writeUInt32BE(crc, trailer);
+
+  return
+      writeAll(os, header, sizeof(header)) &&
+      writeAll(os, data, len) &&
+      writeAll(os, trailer, sizeof(trailer));
+}
+
+/*
+ * Collect the distinct colours of each chunk of rows in parallel and merge
+ * them. Once there are more than 256 colours, fall back to a median cut
+ * palette built from a histogram of the whole image
+ */
+static void buildPalette(
+    const unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    size_t stride,
+    size_t thread_count,
+    size_t chunk_rows,
+    Palette* palette) {
+  auto chunk_count = (size_t(height) + chunk_rows - 1) / chunk_rows;
+  std::vector<Palette> chunk_palettes(chunk_count);
+  std::atomic<bool> exact(true);
+  runParallel(thread_count, chunk_count, [&] (size_t chunk) {
+    auto y0 = chunk * chunk_rows;
+    auto y1 = std::min(size_t(height), y0 + chunk_rows);
+
+    std::vector<uint8_t> rgba(size_t(width) * 4);
+    for (auto y = y0; y < y1 && exact; ++y) {
+      convertPixels_ARGB32(
+          PixelFormat::RGBA8,
+          reinterpret_cast<const uint32_t*>(data + y * stride),
+          width,
+          rgba.data());
+
+      if (!chunk_palettes[chunk].addColours(rgba.data(), width)) {
+        exact = false;
+      }
+    }
+  });
+
+  for (size_t i = 0; i < chunk_count && exact; ++i) {
+    exact = palette->merge(chunk_palettes[i]);
+  }
+
+  if (!exact) {
+    ColourHistogram histogram;
+    std::vector<uint8_t> rgba(size_t(width) * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+      convertPixels_ARGB32(
+          PixelFormat::RGBA8,
+          reinterpret_cast<const uint32_t*>(data + y * stride),
+          width,
+          rgba.data());
+
+      histogram.add(rgba.data(), width);
+    }
+
+    palette_median_cut(histogram, Palette::kMaxColours, palette);
   }
 
-  png_write_image(png, (png_bytepp) buf.data());
+  palette->finish();
+}
+
+Status pngWriteARGB32(
+    const unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    size_t stride,
+    PixelFormat pixel_format,
+    const PNGOptions& opts,
+    OutputStream* os) {
+  PLOTFX_PROFILE_SCOPE("pngWriteARGB32");
+
+  uint8_t color_type;
+  switch (pixel_format) {
+    case PixelFormat::RGB8:
+      color_type = PNG_COLOR_TYPE_RGB;
+      break;
+    case PixelFormat::RGBA8:
+      color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+      break;
+    default:
+      return ERROR_INVALID_ARGUMENT;
+  }
+
+  if (width == 0 || height == 0) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  auto level = std::clamp(opts.compression_level, 0, 9);
+  auto thread_count = std::max(opts.threads, size_t(1));
+  auto bpp = getPixelSize(pixel_format);
+  auto pixel_row_len = size_t(width) * bpp;
+  auto row_len = pixel_row_len + 1;
+
+  /* a few chunks per thread so that uneven chunks balance out */
+  size_t chunk_rows = height;
+  if (thread_count > 1) {
+    chunk_rows = std::max(
+        (kMinDeflateChunkSize + row_len - 1) / row_len,
+        (size_t(height) + thread_count * 4 - 1) / (thread_count * 4));
+  }
+
+  auto chunk_count = (size_t(height) + chunk_rows - 1) / chunk_rows;
+
+  /* small palettes pack several indices into each byte */
+  Palette palette;
+  uint8_t bit_depth = 8;
+  if (opts.indexed) {
+    PLOTFX_PROFILE_SCOPE("png_palette");
+    color_type = PNG_COLOR_TYPE_PALETTE;
+    buildPalette(data, width, height, stride, thread_count, chunk_rows, &palette);
+
+    auto colours = palette.size();
+    bit_depth = colours <= 2 ? 1 : colours <= 4 ? 2 : colours <= 16 ? 4 : 8;
+    pixel_row_len = (size_t(width) * bit_depth + 7) / 8;
+    row_len = pixel_row_len + 1;
+  }
+
+  /* filter all rows */
+  std::vector<uint8_t> filtered(size_t(height) * row_len);
+  {
+    PLOTFX_PROFILE_SCOPE("png_filter");
+    runParallel(thread_count, chunk_count, [&] (size_t chunk) {
+      auto y0 = chunk * chunk_rows;
+      auto y1 = std::min(size_t(height), y0 + chunk_rows);
+
+      /* palette indices are stored unfiltered, as is usual for indexed images */
+      if (opts.indexed) {
+        std::vector<uint8_t> rgba(size_t(width) * 4);
+        std::vector<uint8_t> indices(width);
+        for (auto y = y0; y < y1; ++y) {
+          convertPixels_ARGB32(
+              PixelFormat::RGBA8,
+              reinterpret_cast<const uint32_t*>(data + y * stride),
+              width,
+              rgba.data());
+
+          auto out = &filtered[y * row_len];
+          out[0] = PNG_FILTER_VALUE_NONE;
+          if (bit_depth == 8) {
+            palette.mapPixels(rgba.data(), width, out + 1);
+            continue;
+          }
 
-  png_write_end(png, NULL);
-  png_destroy_info_struct(png, &png_info);
-  png_destroy_write_struct(&png, NULL);
-  fclose(file);
+          /* leftmost pixel in the high-order bits */
+          palette.mapPixels(rgba.data(), width, indices.data());
+          memset(out + 1, 0, pixel_row_len);
+          auto per_byte = 8 / bit_depth;
+          for (uint32_t x = 0; x < width; ++x) {
+            auto shift = 8 - bit_depth * (x % per_byte + 1);
+            out[1 + x / per_byte] |= indices[x] << shift;
+          }
+        }
+
+        return;
+      }
+
+      std::vector<uint8_t> row(pixel_row_len);
+      std::vector<uint8_t> prev(pixel_row_len, 0);
+      std::vector<uint8_t> scratch(pixel_row_len * 4);
+      if (y0 > 0) {
+        convertPixels_ARGB32(
+            pixel_format,
+            reinterpret_cast<const uint32_t*>(data + (y0 - 1) * stride),
+            width,
+            prev.data());
+      }
+
+      for (auto y = y0; y < y1; ++y) {
+        convertPixels_ARGB32(
+            pixel_format,
+            reinterpret_cast<const uint32_t*>(data + y * stride),
+            width,
+            row.data());
+
+        filterRow(
+            row.data(),
+            prev.data(),
+            pixel_row_len,
+            bpp,
+            level > 0,
+            &filtered[y * row_len],
+            scratch.data());
+
+        std::swap(row, prev);
+      }
+    });
+  }
+
+  /* deflate the chunks */
+  std::vector<std::vector<uint8_t>> deflated(chunk_count);
+  std::vector<uLong> checksums(chunk_count);
+  std::atomic<bool> deflate_ok(true);
+  {
+    PLOTFX_PROFILE_SCOPE("png_deflate");
+    runParallel(thread_count, chunk_count, [&] (size_t chunk) {
+      auto begin = chunk * chunk_rows * row_len;
+      auto end = std::min(filtered.size(), begin + chunk_rows * row_len);
+      auto chunk_data = filtered.data() + begin;
+
+      checksums[chunk] = adler32_z(adler32(0, nullptr, 0), chunk_data, end - begin);
+
+      auto ok = deflateChunk(
+          chunk_data,
+          end - begin,
+          std::min(begin, kDeflateWindowSize),
+          level,
+          chunk + 1 == chunk_count,
+          &deflated[chunk]);
+
+      if (!ok) {
+        deflate_ok = false;
+      }
+    });
+  }
+
+  if (!deflate_ok) {
+    return ERROR;
+  }
+
+  /* zlib header and trailer around the concatenated deflate chunks */
+  uint8_t zlib_header[2];
+  zlib_header[0] = 0x78;
+  zlib_header[1] = (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+  zlib_header[1] += (31 - (zlib_header[0] * 256 + zlib_header[1]) % 31) % 31;
+
+  auto checksum = checksums[0];
+  for (size_t i = 1; i < chunk_count; ++i) {
+    auto chunk_len = std::min(filtered.size() - i * chunk_rows * row_len, chunk_rows * row_len);
+    checksum = adler32_combine(checksum, checksums[i], chunk_len);
+  }
+
+  uint8_t zlib_trailer[4];
+  writeUInt32BE(checksum, zlib_trailer);
+
+  deflated.front().insert(deflated.front().begin(), zlib_header, zlib_header + 2);
+  deflated.back().insert(deflated.back().end(), zlib_trailer, zlib_trailer + 4);
+
+  PLOTFX_PROFILE_SCOPE("png_write");
+  static const uint8_t signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+  uint8_t ihdr[13];
+  writeUInt32BE(width, ihdr);
+  writeUInt32BE(height, ihdr + 4);
+  ihdr[8] = bit_depth;
+  ihdr[9] = color_type;
+  ihdr[10] = 0;
+  ihdr[11] = 0;
+  ihdr[12] = 0;
+
+  if (!writeAll(os, signature, sizeof(signature)) ||
+      !writePNGChunk(os, "IHDR", ihdr, sizeof(ihdr))) {
+    return ERROR_IO;
+  }
+
+  if (opts.indexed) {
+    const auto& colours = palette.getColours();
+    std::vector<uint8_t> plte;
+    std::vector<uint8_t> trns;
+    for (size_t i = 0; i < colours.size(); ++i) {
+      uint8_t rgba[4];
+      memcpy(rgba, &colours[i], 4);
+      plte.insert(plte.end(), rgba, rgba + 3);
+      if (i < palette.getTranslucentCount()) {
+        trns.push_back(rgba[3]);
+      }
+    }
+
+    if (!writePNGChunk(os, "PLTE", plte.data(), plte.size())) {
+      return ERROR_IO;
+    }
+
+    if (!trns.empty() && !writePNGChunk(os, "tRNS", trns.data(), trns.size())) {
+      return ERROR_IO;
+    }
+  }
+
+  for (const auto& chunk : deflated) {
+    for (size_t pos = 0; pos < chunk.size(); pos += kMaxIDATSize) {
+      auto n = std::min(chunk.size() - pos, kMaxIDATSize);
+      if (!writePNGChunk(os, "IDAT", chunk.data() + pos, n)) {
+        return ERROR_IO;
+      }
+    }
+  }
+
+  if (!writePNGChunk(os, "IEND", nullptr, 0)) {
+    return ERROR_IO;
+  }
 
   return OK;
 }
 
+Status pngWriteImageFile(
+    const Image& image,
+    const std::string& filename) {
+  std::unique_ptr<FileOutputStream> os;
+  try {
+    os = FileOutputStream::openFile(filename);
+  } catch (const std::exception& e) {
+    return ERROR_IO;
+  }
+
+  PNGWriter writer(os.get());
+  auto rc = writer.begin(
+      image.getWidth(),
+      image.getHeight(),
+      image.getPixelFormat());
+
+  if (rc != OK) {
+    return rc;
+  }
+
+  rc = writer.writeRows(
+      image.getData(),
+      image.getHeight(),
+      image.getPixelSize() * image.getWidth());
+
+  if (rc != OK) {
+    return rc;
+  }
+
+  return writer.finish();
+}
+
 } // namespace plotfx
 
@@ -29,12 +29,110 @@
  */
 #pragma once
 #include <stdlib.h>
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include "plotfx.h"
 #include <graphics/image.h>
 
+struct png_struct_def;
+struct png_info_def;
+
 namespace plotfx {
+class OutputStream;
+
+struct PNGOptions {
+  PNGOptions();
+
+  /**
+   * zlib compression level from 0 (no compression, fastest) to 9 (smallest,
+   * slowest)
+   */
+  int compression_level;
+
+  /**
+   * Filter and compress the image in independent chunks of rows on this many
+   * threads
+   */
+  size_t threads;
+
+  /**
+   * Write an indexed colour (palette) image. Images with at most 256
+   * distinct colours are stored losslessly; images with more colours are
+   * reduced to 256 with median cut quantization. Only supported by
+   * pngWriteARGB32; PNGWriter ignores it
+   */
+  bool indexed;
+};
+
+/**
+ * Incremental PNG encoder. Rows are encoded and written to the output stream
+ * as they are passed in, so the full image never has to be held in memory.
+ * Rows must be written top to bottom; finish() fails unless exactly `height`
+ * rows have been written
+ */
+class PNGWriter {
+public:
+
+  explicit PNGWriter(OutputStream* os, const PNGOptions& opts = PNGOptions());
+  ~PNGWriter();
+  PNGWriter(const PNGWriter&) = delete;
+  PNGWriter& operator=(const PNGWriter&) = delete;
+
+  Status begin(uint32_t width, uint32_t height, PixelFormat pixel_format);
+
+  /**
+   * Write rows that are already in the output pixel format
+   */
+  Status writeRows(const void* data, uint32_t row_count, size_t stride);
+
+  /**
+   * Write rows of premultiplied, native endian ARGB32 pixels (the cairo image
+   * surface format), converting them to the output pixel format
+   */
+  Status writeRowsARGB32(
+      const unsigned char* data,
+      uint32_t row_count,
+      size_t stride);
+
+  Status finish();
+
+protected:
+
+  static void writeCallback(png_struct_def* png, unsigned char* data, size_t size);
+  static void flushCallback(png_struct_def* png);
+
+  void destroy();
+  bool flushOutput();
+
+  OutputStream* os_;
+  PNGOptions opts_;
+  png_struct_def* png_;
+  png_info_def* png_info_;
+  uint32_t width_;
+  uint32_t height_;
+  uint32_t rows_written_;
+  PixelFormat pixel_format_;
+  std::vector<unsigned char> row_buf_;
+  std::string out_buf_;
+};
+
+/**
+ * Encode a whole image of premultiplied, native endian ARGB32 pixels (the
+ * cairo image surface format) as a PNG. Rows are split into chunks that are
+ * filtered (choosing the filter per row) and deflated in parallel; the chunks
+ * are joined with sync flushes into a single zlib stream, so the output is a
+ * regular PNG file. For indexed output (opts.indexed) the pixel format is
+ * ignored; translucent pixels keep their alpha through the tRNS chunk
+ */
+Status pngWriteARGB32(
+    const unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    size_t stride,
+    PixelFormat pixel_format,
+    const PNGOptions& opts,
+    OutputStream* os);
 
 Status pngWriteImageFile(
     const Image& image,
@@ -27,9 +27,13 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
 #include <iostream>
 #include <graphics/rasterize.h>
 #include <graphics/image.h>
+#include <graphics/display_list.h>
+#include <graphics/clip.h>
+#include <utils/profile.h>
 
 namespace plotfx {
 
@@ -38,11 +42,11 @@ Rasterizer::Rasterizer(
     uint32_t height,
     MeasureTable measures_) :
     measures(measures_),
-    ft_ready(false) {
-  if (!FT_Init_FreeType(&ft)) {
-    ft_ready = true;
-  }
-
+    font_registry(text::FontRegistry::get()),
+    recording(nullptr),
+    origin_x(0),
+    origin_y(0),
+    cr_clip_set(false) {
   cr_surface = cairo_image_surface_create(
       CAIRO_FORMAT_ARGB32,
       width,
@@ -51,15 +55,44 @@ Rasterizer::Rasterizer(
   cr_ctx = cairo_create(cr_surface);
 }
 
-Rasterizer::~Rasterizer() {
-  if (ft_ready) {
-    FT_Done_FreeType(ft);
-  }
+Rasterizer::Rasterizer(
+    unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t stride,
+    MeasureTable measures_) :
+    measures(measures_),
+    font_registry(text::FontRegistry::get()),
+    recording(nullptr),
+    origin_x(0),
+    origin_y(0),
+    cr_clip_set(false) {
+  cr_surface = cairo_image_surface_create_for_data(
+      data,
+      CAIRO_FORMAT_ARGB32,
+      width,
+      height,
+      stride);
 
+  cr_ctx = cairo_create(cr_surface);
+}
+
+Rasterizer::~Rasterizer() {
   cairo_destroy(cr_ctx);
   cairo_surface_destroy(cr_surface);
 }
 
+/* the clip rectangle grown by the farthest a stroke can reach; only path
+ * segments inside of it are handed to cairo */
+static Rectangle getStrokeVisibleRect(const Rectangle& clip, double line_width) {
+  auto margin = clip_stroke_margin(line_width);
+  return Rectangle(
+      clip.x - margin,
+      clip.y - margin,
+      clip.w + margin * 2,
+      clip.h + margin * 2);
+}
+
 /* rasterize using libcairo */
 Status Rasterizer::strokePath(
     const Rectangle& clip,
@@ -70,18 +103,32 @@ Status Rasterizer::strokePath(
     return ERROR_INVALID_ARGUMENT;
   }
 
-  cairo_set_source_rgba(
-     cr_ctx,
-     style.colour.red(),
-     style.colour.green(),
-     style.colour.blue(),
-     style.colour.alpha());
+  auto effective_clip = getEffectiveClip(clip);
+  if (recording) {
+    recording->addStrokePath(effective_clip, path_data, point_count, style);
+    return OK;
+  }
 
-  cairo_set_line_width(cr_ctx, to_px(measures, style.line_width));
+  if (effective_clip.w <= 0 || effective_clip.h <= 0) {
+    return OK;
+  }
 
-  cairo_rectangle(cr_ctx, clip.x, clip.y, clip.w, clip.h);
-  cairo_clip(cr_ctx);
-  cairo_new_path(cr_ctx);
+  PLOTFX_PROFILE_SCOPE("Rasterizer::strokePath");
+
+  /* only hand the visible part of the path to cairo */
+  auto line_width = double(to_px(measures, style.line_width));
+  auto visible_rect = getStrokeVisibleRect(effective_clip, line_width);
+  if (clip_polyline(visible_rect, path_data, point_count, &clipped_path)) {
+    path_data = clipped_path.data();
+    point_count = clipped_path.size();
+  }
+
+  if (point_count == 0) {
+    return OK;
+  }
+
+  profileCounter(ProfileCounter::PATH_COMMANDS, point_count);
+  beginStroke(effective_clip, style, line_width);
 
   for (size_t i = 0; i < point_count; ++i) {
     const auto& cmd = path_data[i];
@@ -100,28 +147,209 @@ Status Rasterizer::strokePath(
   return OK;
 }
 
-Status Rasterizer::drawTextGlyphs(
-    const FontInfo& font_info,
-    const GlyphPlacement* glyphs,
-    size_t glyph_count) {
-  if (!ft_ready) {
+Status Rasterizer::strokePath(
+    const Rectangle& clip,
+    const CompactPath& path,
+    const StrokeStyle& style) {
+  if (path.size() < 2) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  auto effective_clip = getEffectiveClip(clip);
+  if (recording) {
+    recording->addStrokePath(effective_clip, path, style);
+    return OK;
+  }
+
+  if (effective_clip.w <= 0 || effective_clip.h <= 0) {
+    return OK;
+  }
+
+  PLOTFX_PROFILE_SCOPE("Rasterizer::strokePath");
+
+  auto line_width = double(to_px(measures, style.line_width));
+  auto visible_rect = getStrokeVisibleRect(effective_clip, line_width);
+  const auto* visible_path = &path;
+  if (clip_polyline(visible_rect, path, &clipped_compact_path)) {
+    visible_path = &clipped_compact_path;
+  }
+
+  auto command_count = visible_path->size();
+  if (command_count == 0) {
+    return OK;
+  }
+
+  profileCounter(ProfileCounter::PATH_COMMANDS, command_count);
+  beginStroke(effective_clip, style, line_width);
+
+  auto commands = visible_path->commands();
+  auto coords = visible_path->coords();
+  for (size_t i = 0; i < command_count; ++i) {
+    switch (static_cast<PathCommand>(commands[i])) {
+      case PathCommand::MOVE_TO:
+        cairo_move_to(cr_ctx, coords[0], coords[1]);
+        coords += 2;
+        break;
+      case PathCommand::LINE_TO:
+        cairo_line_to(cr_ctx, coords[0], coords[1]);
+        coords += 2;
+        break;
+      default:
+        break;
+    }
+  }
+
+  cairo_stroke(cr_ctx);
+
+  return OK;
+}
+
+Status Rasterizer::drawMarkers(
+    const Rectangle& clip,
+    const MarkerStyle& style,
+    const double* coords,
+    size_t count) {
+  auto effective_clip = getEffectiveClip(clip);
+  if (recording) {
+    recording->addMarkers(effective_clip, style, coords, count);
+    return OK;
+  }
+
+  if (count == 0 || effective_clip.w <= 0 || effective_clip.h <= 0) {
+    return OK;
+  }
+
+  PLOTFX_PROFILE_SCOPE("Rasterizer::drawMarkers");
+
+  auto sprite = MarkerSpriteCache::get()->getSprite(
+      style.shape,
+      to_px(measures, style.size));
+
+  cairo_surface_flush(cr_surface);
+  auto data = cairo_image_surface_get_data(cr_surface);
+  auto width = cairo_image_surface_get_width(cr_surface);
+  auto height = cairo_image_surface_get_height(cr_surface);
+  auto stride = cairo_image_surface_get_stride(cr_surface);
+  if (!data) {
     return ERROR;
   }
 
-  // FIXME cache
-  FT_Face ft_font;
-  if (FT_New_Face(ft, font_info.font_file.c_str(), 0, &ft_font)) {
+  blitMarkers(
+      *sprite,
+      style.colour,
+      coords,
+      count,
+      effective_clip,
+      origin_x,
+      origin_y,
+      data,
+      width,
+      height,
+      stride,
+      0,
+      height);
+
+  cairo_surface_mark_dirty(cr_surface);
+  return OK;
+}
+
+Status Rasterizer::drawBitmap(
+    const Rectangle& clip,
+    const Rectangle& rect,
+    const uint32_t* pixels,
+    uint32_t width,
+    uint32_t height) {
+  if (width == 0 || height == 0 || rect.w <= 0 || rect.h <= 0) {
+    return OK;
+  }
+
+  auto effective_clip = getEffectiveClip(clip);
+  if (recording) {
+    recording->addBitmap(effective_clip, rect, pixels, width, height);
+    return OK;
+  }
+
+  PLOTFX_PROFILE_SCOPE("Rasterizer::drawBitmap");
+
+  auto bitmap = cairo_image_surface_create_for_data(
+      reinterpret_cast<unsigned char*>(const_cast<uint32_t*>(pixels)),
+      CAIRO_FORMAT_ARGB32,
+      width,
+      height,
+      width * sizeof(uint32_t));
+
+  if (cairo_surface_status(bitmap) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(bitmap);
     return ERROR;
   }
 
+  applyClip(&effective_clip);
+
+  /* the source is changed temporarily; text is drawn in the current source */
+  cairo_save(cr_ctx);
+  cairo_translate(cr_ctx, rect.x, rect.y);
+  cairo_scale(cr_ctx, rect.w / width, rect.h / height);
+  cairo_set_source_surface(cr_ctx, bitmap, 0, 0);
+  cairo_pattern_set_filter(cairo_get_source(cr_ctx), CAIRO_FILTER_NEAREST);
+  cairo_paint(cr_ctx);
+  cairo_restore(cr_ctx);
+
+  cairo_surface_destroy(bitmap);
+  return OK;
+}
+
+Rectangle Rasterizer::getEffectiveClip(const Rectangle& clip) const {
+  if (clip_stack.empty()) {
+    return clip;
+  }
+
+  return clip_rect_intersect(clip, clip_stack.back());
+}
+
+void Rasterizer::beginStroke(
+    const Rectangle& clip,
+    const StrokeStyle& style,
+    double line_width) {
+  cairo_set_source_rgba(
+     cr_ctx,
+     style.colour.red(),
+     style.colour.green(),
+     style.colour.blue(),
+     style.colour.alpha());
+
+  cairo_set_line_width(cr_ctx, line_width);
+
+  applyClip(&clip);
+  cairo_new_path(cr_ctx);
+}
+
+Status Rasterizer::drawTextGlyphs(
+    const FontInfo& font_info,
+    const GlyphPlacement* glyphs,
+    size_t glyph_count,
+    std::string_view text /* = std::string_view() */) {
+  if (recording) {
+    recording->addTextGlyphs(font_info, glyphs, glyph_count, text);
+    return OK;
+  }
+
+  PLOTFX_PROFILE_SCOPE("Rasterizer::drawTextGlyphs");
+
   auto dpi = measures.dpi;
-  if (FT_Set_Char_Size(ft_font, 0, font_info.font_size * 64, dpi, dpi)) {
-    FT_Done_Face(ft_font);
-    return ERROR;
+  text::FontRef font;
+  auto rc = font_registry->getFont(
+      font_info.font_file,
+      font_info.font_size,
+      dpi,
+      &font);
+
+  if (rc != OK) {
+    return rc;
   }
 
-  auto cairo_face = cairo_ft_font_face_create_for_ft_face(ft_font, 0);
-  cairo_set_font_face(cr_ctx, cairo_face);
+  applyClip(clip_stack.empty() ? nullptr : &clip_stack.back());
+
+  cairo_set_font_face(cr_ctx, font->cairo_face);
   cairo_set_font_size(cr_ctx, (font_info.font_size / 72.0) * dpi);
 
   auto cairo_glyphs = cairo_glyph_allocate(glyph_count);
@@ -150,13 +378,102 @@ Status Rasterizer::drawTextGlyphs(
     // }
   }
 
-  cairo_show_glyphs(cr_ctx, cairo_glyphs, glyph_count);
-  cairo_glyph_free(cairo_glyphs);
-  cairo_font_face_destroy(cairo_face);
+  {
+    std::lock_guard<std::mutex> font_lock(font->lock);
+    cairo_show_glyphs(cr_ctx, cairo_glyphs, glyph_count);
+  }
 
-  FT_Done_Face(ft_font);
+  cairo_glyph_free(cairo_glyphs);
   return OK;
 }
 
+void Rasterizer::beginRecording(DisplayList* list) {
+  list->setDPI(measures.dpi);
+  recording = list;
+}
+
+void Rasterizer::endRecording() {
+  recording = nullptr;
+}
+
+void Rasterizer::setOrigin(double x, double y) {
+  /* the cairo clip is stored in device space */
+  applyClip(nullptr);
+
+  cairo_identity_matrix(cr_ctx);
+  cairo_translate(cr_ctx, -x, -y);
+  origin_x = x;
+  origin_y = y;
+}
+
+void Rasterizer::pushClip(const Rectangle& clip) {
+  if (clip_stack.empty()) {
+    clip_stack.push_back(clip);
+  } else {
+    clip_stack.push_back(clip_rect_intersect(clip, clip_stack.back()));
+  }
+}
+
+void Rasterizer::popClip() {
+  if (!clip_stack.empty()) {
+    clip_stack.pop_back();
+  }
+}
+
+void Rasterizer::resetClip() {
+  clip_stack.clear();
+  applyClip(nullptr);
+}
+
+/* same rounding as cairo's solid colour path (16 bit channels, truncated) */
+static inline uint32_t colourChannelToByte(double v) {
+  return uint32_t(std::clamp(v, 0.0, 1.0) * 65535.0 + 0.5) >> 8;
+}
+
+void Rasterizer::clear(const Colour& colour) {
+  auto a = std::clamp(colour.alpha(), 0.0, 1.0);
+  uint32_t pixel =
+      (colourChannelToByte(a) << 24) |
+      (colourChannelToByte(colour.red() * a) << 16) |
+      (colourChannelToByte(colour.green() * a) << 8) |
+      colourChannelToByte(colour.blue() * a);
+
+  cairo_surface_flush(cr_surface);
+  fillPixels_ARGB32(
+      pixel,
+      cairo_image_surface_get_data(cr_surface),
+      cairo_image_surface_get_width(cr_surface),
+      cairo_image_surface_get_height(cr_surface),
+      cairo_image_surface_get_stride(cr_surface));
+
+  cairo_surface_mark_dirty(cr_surface);
+}
+
+void Rasterizer::applyClip(const Rectangle* clip) {
+  if (!clip) {
+    if (cr_clip_set) {
+      cairo_reset_clip(cr_ctx);
+      cr_clip_set = false;
+    }
+
+    return;
+  }
+
+  if (cr_clip_set &&
+      cr_clip.x == clip->x &&
+      cr_clip.y == clip->y &&
+      cr_clip.w == clip->w &&
+      cr_clip.h == clip->h) {
+    return;
+  }
+
+  cairo_reset_clip(cr_ctx);
+  cairo_new_path(cr_ctx);
+  cairo_rectangle(cr_ctx, clip->x, clip->y, clip->w, clip->h);
+  cairo_clip(cr_ctx);
+  cr_clip = *clip;
+  cr_clip_set = true;
+}
+
 } // namespace plotfx
 
@@ -31,6 +31,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 #include <cairo.h>
 #include <cairo-ft.h>
@@ -45,16 +46,31 @@
 #include <harfbuzz/hb-icu.h>
 
 #include "text.h"
+#include "font_registry.h"
 #include "brush.h"
+#include "compact_path.h"
+#include "marker.h"
 #include "layout.h"
 
 namespace plotfx {
 class Image;
+class DisplayList;
 
 class Rasterizer {
 public:
 
   Rasterizer(uint32_t width, uint32_t height, MeasureTable measures);
+
+  /**
+   * Create a rasterizer that draws into an existing ARGB32 pixel buffer
+   */
+  Rasterizer(
+      unsigned char* data,
+      uint32_t width,
+      uint32_t height,
+      uint32_t stride,
+      MeasureTable measures);
+
   ~Rasterizer();
   Rasterizer(const Rasterizer&) = delete;
   Rasterizer& operator=(const Rasterizer&) = delete;
@@ -65,16 +81,104 @@ public:
       size_t point_count,
       const StrokeStyle& style);
 
+  Status strokePath(
+      const Rectangle& clip,
+      const CompactPath& path,
+      const StrokeStyle& style);
+
   Status drawTextGlyphs(
       const FontInfo& font_info,
       const GlyphPlacement* glyphs,
-      size_t glyph_count);
+      size_t glyph_count,
+      std::string_view text = std::string_view());
+
+  /**
+   * Draw a marker centered at each of the points (interleaved x/y pairs).
+   * Markers are stamped from a cached pre-rasterized sprite directly into the
+   * surface instead of being filled by cairo one by one
+   */
+  Status drawMarkers(
+      const Rectangle& clip,
+      const MarkerStyle& style,
+      const double* coords,
+      size_t count);
+
+  /**
+   * Draw a width x height bitmap of premultiplied ARGB32 pixels (native
+   * endian) scaled to fill the rectangle, without smoothing
+   */
+  Status drawBitmap(
+      const Rectangle& clip,
+      const Rectangle& rect,
+      const uint32_t* pixels,
+      uint32_t width,
+      uint32_t height);
+
+  /**
+   * While recording, draw calls are appended to the display list instead of
+   * being rasterized
+   */
+  void beginRecording(DisplayList* list);
+  void endRecording();
+
+  /**
+   * Shift the device origin so that (x, y) maps to the top-left pixel
+   */
+  void setOrigin(double x, double y);
+
+  /**
+   * Restrict all drawing to the intersection of the current clip and the
+   * given rectangle until the matching popClip call
+   */
+  void pushClip(const Rectangle& clip);
+  void popClip();
+
+  /**
+   * Drop all pushed clips
+   */
+  void resetClip();
+
+  /**
+   * Replace every pixel of the surface with the colour. Gives the same result
+   * as painting with CAIRO_OPERATOR_SOURCE but fills the pixel buffer
+   * directly; the clip and the cairo state are not affected
+   */
+  void clear(const Colour& colour);
 
   MeasureTable measures;
-  FT_Library ft;
-  bool ft_ready;
+  text::FontRegistry* font_registry;
   cairo_surface_t* cr_surface;
   cairo_t* cr_ctx;
+  DisplayList* recording;
+  std::vector<Rectangle> clip_stack;
+  double origin_x;
+  double origin_y;
+
+protected:
+
+  /**
+   * Intersect the clip rectangle of a draw call with the clip stack
+   */
+  Rectangle getEffectiveClip(const Rectangle& clip) const;
+
+  /**
+   * Set the source colour, line width and clip and start a new cairo path
+   */
+  void beginStroke(
+      const Rectangle& clip,
+      const StrokeStyle& style,
+      double line_width);
+
+  /**
+   * Make the cairo clip equal to the rectangle (or remove it if clip is
+   * null). The cairo clip is only changed when it differs from the last one
+   */
+  void applyClip(const Rectangle* clip);
+
+  bool cr_clip_set;
+  Rectangle cr_clip;
+  Path clipped_path;
+  CompactPath clipped_compact_path;
 };
 
 
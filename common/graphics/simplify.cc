@@ -0,0 +1,206 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <math.h>
+#include <utility>
+#include <vector>
+#include <utils/profile.h>
+#include "simplify.h"
+
+namespace plotfx {
+
+/* below this distance points count as collinear */
+static const double kCollinearEpsilon = 1e-6;
+
+/* squared distance of point p to the segment a-b */
+static double segment_distance_sq(
+    double px,
+    double py,
+    double ax,
+    double ay,
+    double bx,
+    double by) {
+  auto dx = bx - ax;
+  auto dy = by - ay;
+  auto len_sq = dx * dx + dy * dy;
+
+  auto t = 0.0;
+  if (len_sq > 0) {
+    t = ((px - ax) * dx + (py - ay) * dy) / len_sq;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+  }
+
+  auto ex = px - (ax + t * dx);
+  auto ey = py - (ay + t * dy);
+  return ex * ex + ey * ey;
+}
+
+namespace {
+
+struct Simplifier {
+  double tolerance_sq;
+  std::vector<float> points;
+  std::vector<uint8_t> keep;
+  std::vector<std::pair<size_t, size_t>> stack;
+  bool has_line;
+
+  void addPoint(float x, float y, bool line) {
+    has_line |= line;
+
+    auto n = points.size();
+    if (n >= 2 && points[n - 2] == x && points[n - 1] == y) {
+      return;
+    }
+
+    points.push_back(x);
+    points.push_back(y);
+  }
+
+  /* run Douglas-Peucker over the buffered subpath and write the result */
+  void flush(CompactPath* out) {
+    auto count = points.size() / 2;
+    if (count == 0 || (count == 1 && !has_line)) {
+      points.clear();
+      has_line = false;
+      return;
+    }
+
+    keep.assign(count, 0);
+    keep[0] = 1;
+    keep[count - 1] = 1;
+
+    stack.clear();
+    if (count > 2) {
+      stack.emplace_back(0, count - 1);
+    }
+
+    while (!stack.empty()) {
+      auto [first, last] = stack.back();
+      stack.pop_back();
+
+      auto ax = points[first * 2];
+      auto ay = points[first * 2 + 1];
+      auto bx = points[last * 2];
+      auto by = points[last * 2 + 1];
+
+      double max_dist = -1;
+      size_t max_idx = first;
+      for (auto i = first + 1; i < last; ++i) {
+        auto d = segment_distance_sq(
+            points[i * 2],
+            points[i * 2 + 1],
+            ax,
+            ay,
+            bx,
+            by);
+
+        if (d > max_dist) {
+          max_dist = d;
+          max_idx = i;
+        }
+      }
+
+      if (max_dist > tolerance_sq) {
+        keep[max_idx] = 1;
+        if (max_idx - first > 1) {
+          stack.emplace_back(first, max_idx);
+        }
+        if (last - max_idx > 1) {
+          stack.emplace_back(max_idx, last);
+        }
+      }
+    }
+
+    out->moveTo(points[0], points[1]);
+    for (size_t i = 1; i < count; ++i) {
+      if (keep[i]) {
+        out->lineTo(points[i * 2], points[i * 2 + 1]);
+      }
+    }
+
+    /* a zero-length line is drawn as a dot */
+    if (count == 1) {
+      out->lineTo(points[0], points[1]);
+    }
+
+    points.clear();
+    has_line = false;
+  }
+};
+
+} // namespace
+
+void path_simplify(
+    const CompactPath& path,
+    double tolerance,
+    CompactPath* out) {
+  PLOTFX_PROFILE_SCOPE("path_simplify");
+  out->clear();
+
+  tolerance = std::max(tolerance, kCollinearEpsilon);
+
+  Simplifier s;
+  s.tolerance_sq = tolerance * tolerance;
+  s.has_line = false;
+
+  auto coords = path.coords();
+  for (size_t i = 0; i < path.size(); ++i) {
+    switch (path.command(i)) {
+
+      case PathCommand::MOVE_TO:
+        s.flush(out);
+        s.addPoint(coords[0], coords[1], false);
+        coords += 2;
+        break;
+
+      case PathCommand::LINE_TO:
+        s.addPoint(coords[0], coords[1], true);
+        coords += 2;
+        break;
+
+      case PathCommand::CLOSE:
+        s.flush(out);
+        out->closePath();
+        break;
+
+      default:
+        break;
+
+    }
+  }
+
+  s.flush(out);
+
+  profileCounter(ProfileCounter::SIMPLIFY_POINTS_IN, path.size());
+  profileCounter(ProfileCounter::SIMPLIFY_POINTS_OUT, out->size());
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,632 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+#include "utils/outputstream.h"
+#include "clip.h"
+#include "display_list.h"
+#include "font_registry.h"
+#include "svg.h"
+
+namespace plotfx {
+
+static const size_t kFlushThreshold = 64 * 1024;
+static const uint32_t kMaxPrecision = 6;
+
+SVGOptions::SVGOptions() :
+    precision(2),
+    text_mode(SVGTextMode::GLYPH_OUTLINES),
+    background(Colour::fromRGBA(0, 0, 0, 0)) {}
+
+SVGWriter::SVGWriter(
+    OutputStream* os,
+    double width,
+    double height,
+    MeasureTable measures_,
+    const SVGOptions& opts) :
+    measures(measures_),
+    os_(os),
+    width_(width),
+    height_(height),
+    opts_(opts),
+    text_colour_(Colour::fromRGB(0, 0, 0)) {
+  opts_.precision = std::min(opts_.precision, kMaxPrecision);
+  quantize_scale_ = pow(10, opts_.precision);
+}
+
+int64_t SVGWriter::quantize(double v) const {
+  return llround(v * quantize_scale_);
+}
+
+/* print a quantized value as a decimal without trailing zeros */
+void SVGWriter::writeCoordinate(int64_t v) {
+  auto scale = int64_t(quantize_scale_);
+  if (v < 0) {
+    buf_ += '-';
+    v = -v;
+  }
+
+  buf_ += std::to_string(v / scale);
+
+  auto frac = v % scale;
+  if (frac == 0) {
+    return;
+  }
+
+  char digits[kMaxPrecision + 1];
+  auto len = opts_.precision;
+  for (auto i = len; i-- > 0; ) {
+    digits[i] = '0' + frac % 10;
+    frac /= 10;
+  }
+
+  while (len > 0 && digits[len - 1] == '0') {
+    --len;
+  }
+
+  buf_ += '.';
+  buf_.append(digits, len);
+}
+
+void SVGWriter::writeNumber(double v) {
+  writeCoordinate(quantize(v));
+}
+
+void SVGWriter::writeColour(const char* attr, const Colour& c) {
+  char hex[8];
+  snprintf(
+      hex,
+      sizeof(hex),
+      "#%02x%02x%02x",
+      int(std::clamp(c.red(), 0.0, 1.0) * 255 + 0.5),
+      int(std::clamp(c.green(), 0.0, 1.0) * 255 + 0.5),
+      int(std::clamp(c.blue(), 0.0, 1.0) * 255 + 0.5));
+
+  buf_ += ' ';
+  buf_ += attr;
+  buf_ += "=\"";
+  buf_ += hex;
+  buf_ += '"';
+
+  if (c.alpha() < 1.0) {
+    buf_ += ' ';
+    buf_ += attr;
+    buf_ += "-opacity=\"";
+    writeNumber(c.alpha());
+    buf_ += '"';
+  }
+}
+
+void SVGWriter::writeEscaped(std::string_view str) {
+  for (auto c : str) {
+    switch (c) {
+      case '<':
+        buf_ += "&lt;";
+        break;
+      case '>':
+        buf_ += "&gt;";
+        break;
+      case '&':
+        buf_ += "&amp;";
+        break;
+      case '"':
+        buf_ += "&quot;";
+        break;
+      default:
+        buf_ += c;
+        break;
+    }
+  }
+}
+
+Status SVGWriter::flush(bool force /* = false */) {
+  if (!force && buf_.size() < kFlushThreshold) {
+    return OK;
+  }
+
+  size_t pos = 0;
+  while (pos < buf_.size()) {
+    auto n = os_->write(buf_.data() + pos, buf_.size() - pos);
+    if (n == 0) {
+      return ERROR_IO;
+    }
+
+    pos += n;
+  }
+
+  buf_.clear();
+  return OK;
+}
+
+Status SVGWriter::begin() {
+  buf_ += "<svg xmlns=\"http://www.w3.org/2000/svg\" ";
+  buf_ += "xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"";
+  writeNumber(width_);
+  buf_ += "\" height=\"";
+  writeNumber(height_);
+  buf_ += "\" viewBox=\"0 0 ";
+  writeNumber(width_);
+  buf_ += ' ';
+  writeNumber(height_);
+  buf_ += "\">\n";
+
+  if (opts_.background.alpha() > 0) {
+    buf_ += "<rect width=\"100%\" height=\"100%\"";
+    writeColour("fill", opts_.background);
+    buf_ += "/>\n";
+  }
+
+  return flush();
+}
+
+Status SVGWriter::finish() {
+  buf_ += "</svg>\n";
+  return flush(true);
+}
+
+std::string SVGWriter::getClipID(const Rectangle& clip) {
+  auto x = quantize(clip.x);
+  auto y = quantize(clip.y);
+  auto w = quantize(clip.w);
+  auto h = quantize(clip.h);
+
+  auto key =
+      std::to_string(x) + ',' + std::to_string(y) + ',' +
+      std::to_string(w) + ',' + std::to_string(h);
+
+  auto iter = clip_ids_.find(key);
+  if (iter != clip_ids_.end()) {
+    return iter->second;
+  }
+
+  auto id = "c" + std::to_string(clip_ids_.size());
+  clip_ids_.emplace(key, id);
+
+  buf_ += "<clipPath id=\"" + id + "\"><rect x=\"";
+  writeCoordinate(x);
+  buf_ += "\" y=\"";
+  writeCoordinate(y);
+  buf_ += "\" width=\"";
+  writeCoordinate(w);
+  buf_ += "\" height=\"";
+  writeCoordinate(h);
+  buf_ += "\"/></clipPath>\n";
+  return id;
+}
+
+Status SVGWriter::strokePath(
+    const Rectangle& clip,
+    const PathData* path_data,
+    size_t path_data_count,
+    const StrokeStyle& style) {
+  if (path_data_count < 2) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  /* the raster backend draws text in the colour of the last stroke */
+  text_colour_ = style.colour;
+
+  /* drop the parts of the path that are outside of the clip */
+  auto line_width = double(to_px(measures, style.line_width));
+  auto margin = clip_stroke_margin(line_width);
+  auto visible_rect = Rectangle(
+      clip.x - margin,
+      clip.y - margin,
+      clip.w + margin * 2,
+      clip.h + margin * 2);
+
+  if (clip_polyline(visible_rect, path_data, path_data_count, &clipped_path_)) {
+    path_data = clipped_path_.data();
+    path_data_count = clipped_path_.size();
+  }
+
+  if (path_data_count == 0) {
+    return OK;
+  }
+
+  auto clip_id = getClipID(clip);
+
+  buf_ += "<path clip-path=\"url(#" + clip_id + ")\" fill=\"none\"";
+  writeColour("stroke", style.colour);
+  buf_ += " stroke-width=\"";
+  writeNumber(line_width);
+  buf_ += "\" d=\"";
+
+  /* absolute moveto, then quantized relative linetos */
+  int64_t px = 0;
+  int64_t py = 0;
+  int64_t sx = 0;
+  int64_t sy = 0;
+  bool has_point = false;
+  char last_op = 0;
+  for (size_t i = 0; i < path_data_count; ++i) {
+    const auto& cmd = path_data[i];
+    switch (cmd.command) {
+
+      case PathCommand::LINE_TO:
+        if (has_point) {
+          auto x = quantize(cmd[0]);
+          auto y = quantize(cmd[1]);
+          if (x == px && y == py) {
+            break;
+          }
+
+          buf_ += last_op == 'l' ? ' ' : 'l';
+          writeCoordinate(x - px);
+          buf_ += ' ';
+          writeCoordinate(y - py);
+          px = x;
+          py = y;
+          last_op = 'l';
+          break;
+        }
+
+        /* fallthrough: a lineto without a current point acts as a moveto */
+
+      case PathCommand::MOVE_TO:
+        px = sx = quantize(cmd[0]);
+        py = sy = quantize(cmd[1]);
+        buf_ += 'M';
+        writeCoordinate(px);
+        buf_ += ' ';
+        writeCoordinate(py);
+        has_point = true;
+        last_op = 'M';
+        break;
+
+      case PathCommand::CLOSE:
+        if (has_point) {
+          buf_ += 'z';
+          px = sx;
+          py = sy;
+          last_op = 'z';
+        }
+        break;
+
+      /* curves and arcs are not drawn by the raster backend either */
+      default:
+        break;
+
+    }
+  }
+
+  buf_ += "\"/>\n";
+  return flush();
+}
+
+Status SVGWriter::drawTextGlyphs(
+    const FontInfo& font_info,
+    const GlyphPlacement* glyphs,
+    size_t glyph_count,
+    std::string_view text /* = std::string_view() */) {
+  if (glyph_count == 0) {
+    return OK;
+  }
+
+  if (opts_.text_mode == SVGTextMode::TEXT && !text.empty()) {
+    /* derive the family from the font file name, e.g. Roboto-Medium.ttf */
+    auto family = font_info.font_file;
+    family = family.substr(family.find_last_of('/') + 1);
+    family = family.substr(0, family.find_first_of(".-"));
+
+    buf_ += "<text x=\"";
+    writeNumber(glyphs[0].x);
+    buf_ += "\" y=\"";
+    writeNumber(glyphs[0].y);
+    buf_ += "\" font-family=\"";
+    writeEscaped(family);
+    buf_ += "\" font-size=\"";
+    writeNumber((font_info.font_size / 72.0) * measures.dpi);
+    buf_ += '"';
+    writeColour("fill", text_colour_);
+    buf_ += '>';
+    writeEscaped(text);
+    buf_ += "</text>\n";
+    return flush();
+  }
+
+  auto font_key = font_info.font_file + '@' + std::to_string(font_info.font_size);
+  auto font_id = font_ids_.emplace(font_key, font_ids_.size()).first->second;
+
+  std::string uses;
+  for (size_t i = 0; i < glyph_count; ++i) {
+    const auto& g = glyphs[i];
+    auto glyph_id = "g" + std::to_string(font_id) + "_" + std::to_string(g.codepoint);
+    if (glyph_ids_.count(glyph_id) == 0) {
+      if (auto rc = writeGlyphOutline(glyph_id, font_info, g.codepoint); rc != OK) {
+        return rc;
+      }
+
+      glyph_ids_.emplace(glyph_id);
+    }
+
+    uses += "<use xlink:href=\"#" + glyph_id + "\" x=\"";
+    std::swap(buf_, uses);
+    writeNumber(g.x);
+    buf_ += "\" y=\"";
+    writeNumber(g.y);
+    buf_ += "\"/>";
+    std::swap(buf_, uses);
+  }
+
+  buf_ += "<g";
+  writeColour("fill", text_colour_);
+  buf_ += '>';
+  buf_ += uses;
+  buf_ += "</g>\n";
+  return flush();
+}
+
+Status SVGWriter::drawMarkers(
+    const Rectangle& clip,
+    const MarkerStyle& style,
+    const double* coords,
+    size_t count) {
+  auto size = double(to_px(measures, style.size));
+  auto marker_key =
+      std::to_string(static_cast<int>(style.shape)) + '@' +
+      std::to_string(quantize(size));
+
+  auto marker_id_iter = marker_ids_.find(marker_key);
+  if (marker_id_iter == marker_ids_.end()) {
+    auto marker_id = "m" + std::to_string(marker_ids_.size());
+    marker_id_iter = marker_ids_.emplace(marker_key, marker_id).first;
+
+    buf_ += "<defs>";
+    switch (style.shape) {
+      case MarkerShape::CIRCLE:
+        buf_ += "<circle id=\"" + marker_id + "\" r=\"";
+        writeNumber(size * 0.5);
+        buf_ += "\"/>";
+        break;
+      case MarkerShape::SQUARE:
+        buf_ += "<rect id=\"" + marker_id + "\" x=\"";
+        writeNumber(-size * 0.5);
+        buf_ += "\" y=\"";
+        writeNumber(-size * 0.5);
+        buf_ += "\" width=\"";
+        writeNumber(size);
+        buf_ += "\" height=\"";
+        writeNumber(size);
+        buf_ += "\"/>";
+        break;
+    }
+    buf_ += "</defs>\n";
+  }
+
+  /* skip markers that are entirely outside of the clip */
+  auto visible_rect = Rectangle(
+      clip.x - size * 0.5,
+      clip.y - size * 0.5,
+      clip.w + size,
+      clip.h + size);
+
+  auto clip_id = getClipID(clip);
+
+  buf_ += "<g clip-path=\"url(#" + clip_id + ")\"";
+  writeColour("fill", style.colour);
+  buf_ += ">";
+
+  for (size_t i = 0; i < count; ++i) {
+    auto x = coords[i * 2 + 0];
+    auto y = coords[i * 2 + 1];
+    if (!(x >= visible_rect.x && x <= visible_rect.x + visible_rect.w &&
+          y >= visible_rect.y && y <= visible_rect.y + visible_rect.h)) {
+      continue;
+    }
+
+    buf_ += "<use xlink:href=\"#" + marker_id_iter->second + "\" x=\"";
+    writeNumber(x);
+    buf_ += "\" y=\"";
+    writeNumber(y);
+    buf_ += "\"/>";
+
+    if (auto rc = flush(); rc != OK) {
+      return rc;
+    }
+  }
+
+  buf_ += "</g>\n";
+  return flush();
+}
+
+Status SVGWriter::drawBitmap(
+    const Rectangle& clip,
+    const Rectangle& rect,
+    const uint32_t* pixels,
+    uint32_t width,
+    uint32_t height) {
+  if (width == 0 || height == 0) {
+    return OK;
+  }
+
+  auto cell_w = rect.w / width;
+  auto cell_h = rect.h / height;
+  auto clip_id = getClipID(clip);
+
+  buf_ += "<g clip-path=\"url(#" + clip_id + ")\">";
+
+  for (uint32_t y = 0; y < height; ++y) {
+    auto row = pixels + size_t(y) * width;
+    for (uint32_t x = 0; x < width; ) {
+      auto pixel = row[x];
+      auto run = x + 1;
+      while (run < width && row[run] == pixel) {
+        ++run;
+      }
+
+      auto alpha = pixel >> 24;
+      if (alpha > 0) {
+        /* the pixels are premultiplied */
+        auto colour = Colour::fromRGBA(
+            ((pixel >> 16) & 0xff) / double(alpha),
+            ((pixel >> 8) & 0xff) / double(alpha),
+            (pixel & 0xff) / double(alpha),
+            alpha / 255.0);
+
+        buf_ += "<rect x=\"";
+        writeNumber(rect.x + x * cell_w);
+        buf_ += "\" y=\"";
+        writeNumber(rect.y + y * cell_h);
+        buf_ += "\" width=\"";
+        writeNumber((run - x) * cell_w);
+        buf_ += "\" height=\"";
+        writeNumber(cell_h);
+        buf_ += '"';
+        writeColour("fill", colour);
+        buf_ += "/>";
+
+        if (auto rc = flush(); rc != OK) {
+          return rc;
+        }
+      }
+
+      x = run;
+    }
+  }
+
+  buf_ += "</g>\n";
+  return flush();
+}
+
+Status SVGWriter::writeGlyphOutline(
+    const std::string& glyph_id,
+    const FontInfo& font_info,
+    uint32_t codepoint) {
+  text::FontRef font;
+  auto rc = text::FontRegistry::get()->getFont(
+      font_info.font_file,
+      font_info.font_size,
+      measures.dpi,
+      &font);
+
+  if (rc != OK) {
+    return rc;
+  }
+
+  std::string d;
+  {
+    std::lock_guard<std::mutex> font_lock(font->lock);
+    if (FT_Load_Glyph(font->ft_face, codepoint, FT_LOAD_NO_BITMAP)) {
+      return ERROR;
+    }
+
+    /* outline coordinates are 26.6 fixed point with the y axis pointing up */
+    auto point = [this, &d] (char op, const FT_Vector* v) {
+      if (op) {
+        d += op;
+      } else {
+        d += ' ';
+      }
+
+      std::swap(buf_, d);
+      writeNumber(v->x / 64.0);
+      buf_ += ' ';
+      writeNumber(-v->y / 64.0);
+      std::swap(buf_, d);
+    };
+
+    using PointFn = decltype(point);
+
+    FT_Outline_Funcs funcs;
+    funcs.move_to = [] (const FT_Vector* to, void* ctx) {
+      (*static_cast<PointFn*>(ctx))('M', to);
+      return 0;
+    };
+    funcs.line_to = [] (const FT_Vector* to, void* ctx) {
+      (*static_cast<PointFn*>(ctx))('L', to);
+      return 0;
+    };
+    funcs.conic_to = [] (const FT_Vector* c, const FT_Vector* to, void* ctx) {
+      (*static_cast<PointFn*>(ctx))('Q', c);
+      (*static_cast<PointFn*>(ctx))(0, to);
+      return 0;
+    };
+    funcs.cubic_to = [] (
+        const FT_Vector* c1,
+        const FT_Vector* c2,
+        const FT_Vector* to,
+        void* ctx) {
+      (*static_cast<PointFn*>(ctx))('C', c1);
+      (*static_cast<PointFn*>(ctx))(0, c2);
+      (*static_cast<PointFn*>(ctx))(0, to);
+      return 0;
+    };
+    funcs.shift = 0;
+    funcs.delta = 0;
+
+    if (FT_Outline_Decompose(&font->ft_face->glyph->outline, &funcs, &point)) {
+      return ERROR;
+    }
+  }
+
+  buf_ += "<defs><path id=\"" + glyph_id + "\" d=\"" + d + "\"/></defs>\n";
+  return OK;
+}
+
+ReturnCode writeSVG(
+    const DisplayList& list,
+    double width,
+    double height,
+    MeasureTable measures,
+    const SVGOptions& opts,
+    OutputStream* os) {
+  try {
+    SVGWriter writer(os, width, height, measures, opts);
+
+    DisplayListReplayOptions replay_opts;
+    replay_opts.coalesce_strokes = true;
+
+    Status rc = writer.begin();
+    if (rc == OK) {
+      rc = list.replay(&writer, replay_opts);
+    }
+
+    if (rc == OK) {
+      rc = writer.finish();
+    }
+
+    if (rc != OK) {
+      return rc;
+    }
+  } catch (const std::exception& e) {
+    return ReturnCode::errorf("EIO", "error while writing SVG: $0", e.what());
+  }
+
+  return ReturnCode::success();
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,177 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "brush.h"
+#include "colour.h"
+#include "layout.h"
+#include "marker.h"
+#include "measure.h"
+#include "path.h"
+#include "text.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+class DisplayList;
+class OutputStream;
+
+enum class SVGTextMode {
+  GLYPH_OUTLINES,
+  TEXT
+};
+
+struct SVGOptions {
+  SVGOptions();
+
+  /**
+   * Number of decimal digits kept for coordinates
+   */
+  uint32_t precision;
+
+  /**
+   * Output text as glyph outlines (identical to the raster output) or as
+   * <text> elements (smaller, selectable, but depends on the viewer's fonts)
+   */
+  SVGTextMode text_mode;
+
+  /**
+   * Fill colour for the whole canvas; transparent colours are skipped
+   */
+  Colour background;
+};
+
+/**
+ * Writes the stroke and text primitives of the Rasterizer as an SVG document.
+ * Output is buffered and streamed to the output stream as it is generated;
+ * clip paths and glyph outlines are emitted on first use.
+ */
+class SVGWriter {
+public:
+
+  SVGWriter(
+      OutputStream* os,
+      double width,
+      double height,
+      MeasureTable measures,
+      const SVGOptions& opts);
+
+  SVGWriter(const SVGWriter&) = delete;
+  SVGWriter& operator=(const SVGWriter&) = delete;
+
+  Status begin();
+
+  /**
+   * Stroke a path. All subpaths are emitted as one <path> element
+   */
+  Status strokePath(
+      const Rectangle& clip,
+      const PathData* path_data,
+      size_t path_data_count,
+      const StrokeStyle& style);
+
+  Status drawTextGlyphs(
+      const FontInfo& font_info,
+      const GlyphPlacement* glyphs,
+      size_t glyph_count,
+      std::string_view text = std::string_view());
+
+  /**
+   * Draw one marker per point; each marker shape is emitted once and
+   * referenced with <use>
+   */
+  Status drawMarkers(
+      const Rectangle& clip,
+      const MarkerStyle& style,
+      const double* coords,
+      size_t count);
+
+  /**
+   * Draw a bitmap as one <rect> per horizontal run of equal pixels, so that
+   * the output stays resolution independent
+   */
+  Status drawBitmap(
+      const Rectangle& clip,
+      const Rectangle& rect,
+      const uint32_t* pixels,
+      uint32_t width,
+      uint32_t height);
+
+  Status finish();
+
+  MeasureTable measures;
+
+protected:
+
+  void writeNumber(double v);
+  void writeCoordinate(int64_t v);
+  void writeColour(const char* attr, const Colour& c);
+  void writeEscaped(std::string_view str);
+  int64_t quantize(double v) const;
+  Status flush(bool force = false);
+
+  Status writeGlyphOutline(
+      const std::string& glyph_id,
+      const FontInfo& font_info,
+      uint32_t codepoint);
+
+  std::string getClipID(const Rectangle& clip);
+
+  OutputStream* os_;
+  double width_;
+  double height_;
+  SVGOptions opts_;
+  double quantize_scale_;
+  std::string buf_;
+  Colour text_colour_;
+  std::unordered_map<std::string, std::string> clip_ids_;
+  std::unordered_map<std::string, uint32_t> font_ids_;
+  std::unordered_set<std::string> glyph_ids_;
+  std::unordered_map<std::string, std::string> marker_ids_;
+  Path clipped_path_;
+};
+
+/**
+ * Write a recorded display list as an SVG document. Consecutive strokes with
+ * the same style and clip are merged into a single <path> element
+ */
+ReturnCode writeSVG(
+    const DisplayList& list,
+    double width,
+    double height,
+    MeasureTable measures,
+    const SVGOptions& opts,
+    OutputStream* os);
+
+} // namespace plotfx
+
@@ -67,15 +67,16 @@ Status drawText(
     return rc;
   }
 
-  return drawTextGlyphs(font_info, glyphs.data(), glyphs.size(), layer);
+  return drawTextGlyphs(font_info, glyphs.data(), glyphs.size(), layer, text);
 }
 
 Status drawTextGlyphs(
     const FontInfo& font_info,
     const GlyphPlacement* glyphs,
     size_t glyph_count,
-    Layer* layer) {
-  return layer->rasterizer.drawTextGlyphs(font_info, glyphs, glyph_count);
+    Layer* layer,
+    std::string_view text /* = std::string_view() */) {
+  return layer->rasterizer.drawTextGlyphs(font_info, glyphs, glyph_count, text);
 }
 
 } // namespace plotfx
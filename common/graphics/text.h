@@ -28,6 +28,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include <string_view>
 #include "plotfx.h"
 #include "path.h"
 
@@ -80,11 +81,16 @@ Status drawText(
     const TextStyle& text_style,
     Layer* layer);
 
+/**
+ * Draw pre-shaped glyphs. The optional text is the string the glyphs were
+ * shaped from; it is kept for backends that output text instead of glyphs
+ */
 Status drawTextGlyphs(
     const FontInfo& font_info,
     const GlyphPlacement* glyphs,
     size_t glyph_count,
-    Layer* layer);
+    Layer* layer,
+    std::string_view text = std::string_view());
 
 
 } // namespace plotfx
@@ -0,0 +1,156 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "text_cache.h"
+
+namespace plotfx {
+namespace text {
+
+/* rough per-entry bookkeeping cost: list node, hash node, shared_ptr block */
+static const size_t kEntryOverhead = 128;
+
+ShapedRun::ShapedRun() :
+    advance_x(0),
+    metrics_ascender(0),
+    metrics_descender(0) {}
+
+ShapedRunCache* ShapedRunCache::get() {
+  static ShapedRunCache cache;
+  return &cache;
+}
+
+ShapedRunCache::ShapedRunCache(
+    size_t memory_limit) :
+    memory_used_(0),
+    memory_limit_(memory_limit),
+    hits_(0),
+    misses_(0),
+    evictions_(0) {}
+
+std::string ShapedRunCache::buildKey(
+    const std::string& text,
+    const FontInfo& font_info,
+    double dpi,
+    TextDirection direction) {
+  std::string key;
+  key.reserve(text.size() + font_info.font_file.size() + 2 * sizeof(double) + 3);
+  key.append(text);
+  key += '\0';
+  key.append(font_info.font_file);
+  key += '\0';
+  key.append(reinterpret_cast<const char*>(&font_info.font_size), sizeof(double));
+  key.append(reinterpret_cast<const char*>(&dpi), sizeof(double));
+  key += static_cast<char>(direction);
+  return key;
+}
+
+bool ShapedRunCache::lookup(
+    const std::string& text,
+    const FontInfo& font_info,
+    double dpi,
+    TextDirection direction,
+    ShapedRunRef* run) {
+  auto key = buildKey(text, font_info, dpi, direction);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    ++misses_;
+    return false;
+  }
+
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  *run = iter->second->run;
+  return true;
+}
+
+void ShapedRunCache::insert(
+    const std::string& text,
+    const FontInfo& font_info,
+    double dpi,
+    TextDirection direction,
+    ShapedRunRef run) {
+  auto key = buildKey(text, font_info, dpi, direction);
+  auto size =
+      kEntryOverhead +
+      2 * key.size() +
+      sizeof(ShapedRun) +
+      run->glyphs.capacity() * sizeof(ShapedGlyph);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (size > memory_limit_ || index_.count(key) > 0) {
+    return;
+  }
+
+  entries_.emplace_front(Entry{key, std::move(run), size});
+  index_.emplace(std::move(key), entries_.begin());
+  memory_used_ += size;
+  evict();
+}
+
+void ShapedRunCache::evict() {
+  while (memory_used_ > memory_limit_ && !entries_.empty()) {
+    const auto& entry = entries_.back();
+    memory_used_ -= entry.size;
+    index_.erase(entry.key);
+    entries_.pop_back();
+    ++evictions_;
+  }
+}
+
+void ShapedRunCache::setMemoryLimit(size_t limit) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  memory_limit_ = limit;
+  evict();
+}
+
+void ShapedRunCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  index_.clear();
+  memory_used_ = 0;
+}
+
+ShapedRunCacheStats ShapedRunCache::getStats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  ShapedRunCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.entries = entries_.size();
+  stats.memory_used = memory_used_;
+  stats.memory_limit = memory_limit_;
+  return stats;
+}
+
+} // namespace text
+} // namespace plotfx
+
@@ -0,0 +1,142 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "text.h"
+
+namespace plotfx {
+namespace text {
+
+struct ShapedGlyph {
+  uint32_t codepoint;
+  double advance_x;
+  double advance_y;
+};
+
+/**
+ * The result of shaping a single line of text: the glyphs with their
+ * advances and the (per-font) line metrics
+ */
+struct ShapedRun {
+  ShapedRun();
+  std::vector<ShapedGlyph> glyphs;
+  double advance_x;
+  double metrics_ascender;
+  double metrics_descender;
+};
+
+using ShapedRunRef = std::shared_ptr<const ShapedRun>;
+
+struct ShapedRunCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t entries;
+  size_t memory_used;
+  size_t memory_limit;
+};
+
+/**
+ * Process-wide LRU cache of shaped runs keyed by (text, font, dpi,
+ * direction). Entries are evicted in least-recently-used order once the
+ * total (approximate) memory used by the cache exceeds the limit. Safe to use
+ * from multiple threads.
+ */
+class ShapedRunCache {
+public:
+
+  static const size_t kDefaultMemoryLimit = 4 * 1024 * 1024;
+
+  static ShapedRunCache* get();
+
+  ShapedRunCache(size_t memory_limit = kDefaultMemoryLimit);
+  ShapedRunCache(const ShapedRunCache&) = delete;
+  ShapedRunCache& operator=(const ShapedRunCache&) = delete;
+
+  bool lookup(
+      const std::string& text,
+      const FontInfo& font_info,
+      double dpi,
+      TextDirection direction,
+      ShapedRunRef* run);
+
+  void insert(
+      const std::string& text,
+      const FontInfo& font_info,
+      double dpi,
+      TextDirection direction,
+      ShapedRunRef run);
+
+  /**
+   * Set the memory limit in bytes. A limit of zero disables the cache
+   */
+  void setMemoryLimit(size_t limit);
+
+  void clear();
+
+  ShapedRunCacheStats getStats() const;
+
+protected:
+
+  struct Entry {
+    std::string key;
+    ShapedRunRef run;
+    size_t size;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  static std::string buildKey(
+      const std::string& text,
+      const FontInfo& font_info,
+      double dpi,
+      TextDirection direction);
+
+  void evict();
+
+  mutable std::mutex mutex_;
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+  size_t memory_used_;
+  size_t memory_limit_;
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+};
+
+} // namespace text
+} // namespace plotfx
+
@@ -42,20 +42,14 @@ Status layoutTextLTR(
     TextVAlign valign,
     TextShaper* shaper,
     std::function<void (const GlyphPlacement&)> glyph_cb) {
-  double line_length;
-  std::vector<GlyphInfo> glyphs;
-  auto rc = shaper->shapeText(
-      text,
-      font_info,
-      [&] (const GlyphInfo& gi) {
-        line_length += gi.advance_x;
-        glyphs.emplace_back(gi);
-      });
-
+  ShapedRunRef run;
+  auto rc = shaper->shapeRun(text, font_info, TextDirection::LTR, &run);
   if (rc != OK) {
     return rc;
   }
 
+  auto line_length = run->advance_x;
+
   auto gx = x;
   auto gy = y;
 
@@ -70,25 +64,24 @@ Status layoutTextLTR(
       break;
   }
 
-  for (const auto& gi : glyphs) {
-    // FIXME: this is constant for every glpyh in the same font
-    double baseline_offset = 0;
-
-    switch (valign) {
-      case TextVAlign::BASELINE:
-        break;
-      case TextVAlign::TOP:
-        baseline_offset = gi.metrics_ascender;
-        break;
-      case TextVAlign::MIDDLE:
-        baseline_offset = gi.metrics_ascender - (gi.metrics_ascender + -gi.metrics_descender) / 2;
-        break;
-      case TextVAlign::BOTTOM:
-        baseline_offset = gi.metrics_descender;
-        break;
-    }
+  double baseline_offset = 0;
+  switch (valign) {
+    case TextVAlign::BASELINE:
+      break;
+    case TextVAlign::TOP:
+      baseline_offset = run->metrics_ascender;
+      break;
+    case TextVAlign::MIDDLE:
+      baseline_offset =
+          run->metrics_ascender -
+          (run->metrics_ascender + -run->metrics_descender) / 2;
+      break;
+    case TextVAlign::BOTTOM:
+      baseline_offset = run->metrics_descender;
+      break;
+  }
 
-    GlyphPlacement g;
+  for (const auto& gi : run->glyphs) {
     glyph_cb(GlyphPlacement {
       .codepoint = gi.codepoint,
       .x = gx,
@@ -29,70 +29,113 @@
  */
 #include <graphics/text_shaper.h>
 #include <iostream>
+#include <utils/profile.h>
 
 namespace plotfx {
 namespace text {
 
+/* one HarfBuzz buffer per thread, shared by all shapers on that thread */
+static hb_buffer_t* getThreadBuffer() {
+  struct BufferHolder {
+    BufferHolder() : buf(hb_buffer_create()) {}
+    ~BufferHolder() { hb_buffer_destroy(buf); }
+    hb_buffer_t* buf;
+  };
+
+  thread_local BufferHolder holder;
+  return holder.buf;
+}
+
 TextShaper::TextShaper(
     double dpi_) :
     dpi(dpi_),
-    ft_ready(false),
-    hb_buf(hb_buffer_create()) {}
+    font_registry(FontRegistry::get()),
+    run_cache(ShapedRunCache::get()) {}
 
-TextShaper::~TextShaper() {
-  if (ft_ready) {
-    FT_Done_FreeType(ft);
-  }
-}
+TextShaper::~TextShaper() {}
 
 Status TextShaper::shapeText(
     const std::string& text,
     const FontInfo& font_info,
     std::function<void (const GlyphInfo&)> glyph_cb) {
-  if (!ft_ready) {
-    if (FT_Init_FreeType(&ft)) {
-      return ERROR;
-    }
-
-    ft_ready = true;
+  ShapedRunRef run;
+  if (auto rc = shapeRun(text, font_info, TextDirection::LTR, &run); rc != OK) {
+    return rc;
   }
 
-  // FIXME cache
-  FT_Face ft_font;
-  if (FT_New_Face(ft, font_info.font_file.c_str(), 0, &ft_font)) {
-    return ERROR;
+  for (const auto& sg : run->glyphs) {
+    GlyphInfo g;
+    g.codepoint = sg.codepoint;
+    g.advance_x = sg.advance_x;
+    g.advance_y = sg.advance_y;
+    g.metrics_ascender = run->metrics_ascender;
+    g.metrics_descender = run->metrics_descender;
+    glyph_cb(g);
   }
 
-  if (FT_Set_Char_Size(ft_font, 0, font_info.font_size * 64, dpi, dpi)) {
-    FT_Done_Face(ft_font);
-    return ERROR;
+  return OK;
+}
+
+Status TextShaper::shapeRun(
+    const std::string& text,
+    const FontInfo& font_info,
+    TextDirection direction,
+    ShapedRunRef* run) {
+  if (run_cache->lookup(text, font_info, dpi, direction, run)) {
+    return OK;
   }
 
-  auto hb_font = hb_ft_font_create_referenced(ft_font);
+  PLOTFX_PROFILE_SCOPE("shapeText");
 
+  FontRef font;
+  auto rc = font_registry->getFont(
+      font_info.font_file,
+      font_info.font_size,
+      dpi,
+      &font);
+
+  if (rc != OK) {
+    return rc;
+  }
+
+  auto hb_buf = getThreadBuffer();
   hb_buffer_reset(hb_buf);
-  hb_buffer_set_direction(hb_buf, HB_DIRECTION_LTR);
-  hb_buffer_set_script(hb_buf, HB_SCRIPT_LATIN);
+  switch (direction) {
+    case TextDirection::LTR:
+      hb_buffer_set_direction(hb_buf, HB_DIRECTION_LTR);
+      break;
+    case TextDirection::RTL:
+      hb_buffer_set_direction(hb_buf, HB_DIRECTION_RTL);
+      break;
+  }
 
+  hb_buffer_set_script(hb_buf, HB_SCRIPT_LATIN);
   hb_buffer_add_utf8(hb_buf, text.data(), text.size(), 0, text.size());
-  hb_shape(hb_font, hb_buf, NULL, 0);
+
+  {
+    std::lock_guard<std::mutex> font_lock(font->lock);
+    hb_shape(font->hb_font, hb_buf, NULL, 0);
+  }
+
+  auto shaped = std::make_shared<ShapedRun>();
+  shaped->metrics_ascender = font->metrics_ascender;
+  shaped->metrics_descender = font->metrics_descender;
 
   uint32_t glyph_count;
   auto glyph_infos = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
   auto glyph_positions = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+  shaped->glyphs.resize(glyph_count);
+  profileCounter(ProfileCounter::GLYPHS_SHAPED, glyph_count);
   for (size_t i = 0; i < glyph_count; ++i) {
-    GlyphInfo g;
+    auto& g = shaped->glyphs[i];
     g.codepoint = glyph_infos[i].codepoint;
     g.advance_x = glyph_positions[i].x_advance / 64.0;
     g.advance_y = glyph_positions[i].y_advance / 64.0;
-    g.metrics_ascender = ft_font->size->metrics.ascender / 64.0; // FIXME this is constant for all glyphs
-    g.metrics_descender = ft_font->size->metrics.descender / 64.0; // FIXME this is constant for all glyphs
-    glyph_cb(g);
+    shaped->advance_x += g.advance_x;
   }
 
-  hb_font_destroy(hb_font);
-  FT_Done_Face(ft_font);
-
+  run_cache->insert(text, font_info, dpi, direction, shaped);
+  *run = std::move(shaped);
   return OK;
 }
 
@@ -42,6 +42,8 @@
 #include <harfbuzz/hb-icu.h>
 
 #include "text.h"
+#include "font_registry.h"
+#include "text_cache.h"
 
 namespace plotfx {
 namespace text {
@@ -59,11 +61,20 @@ public:
       const FontInfo& font_info,
       std::function<void (const GlyphInfo&)> glyph_cb);
 
+  /**
+   * Shape a single line of text. Results are served from the shared run
+   * cache where possible
+   */
+  Status shapeRun(
+      const std::string& text,
+      const FontInfo& font_info,
+      TextDirection direction,
+      ShapedRunRef* run);
+
 protected:
   double dpi;
-  FT_Library ft;
-  bool ft_ready;
-  hb_buffer_t* hb_buf;
+  FontRegistry* font_registry;
+  ShapedRunCache* run_cache;
 };
 
 } // namespace text
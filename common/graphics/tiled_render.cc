@@ -0,0 +1,165 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <utils/profile.h>
+#include "display_list.h"
+#include "rasterize.h"
+#include "tiled_render.h"
+
+namespace plotfx {
+
+/* use a few more bands than threads so uneven bands balance out */
+static const size_t kBandsPerThread = 4;
+static const uint32_t kMinBandHeight = 32;
+
+Status rasterizeTiled(
+    const DisplayList& list,
+    Rasterizer* target,
+    size_t thread_count) {
+  if (thread_count <= 1) {
+    return list.replay(target);
+  }
+
+  cairo_surface_flush(target->cr_surface);
+  auto data = cairo_image_surface_get_data(target->cr_surface);
+  auto width = cairo_image_surface_get_width(target->cr_surface);
+  auto height = cairo_image_surface_get_height(target->cr_surface);
+  auto stride = cairo_image_surface_get_stride(target->cr_surface);
+  if (!data || width <= 0 || height <= 0) {
+    return list.replay(target);
+  }
+
+  uint32_t band_height = std::max(
+      kMinBandHeight,
+      uint32_t((height + thread_count * kBandsPerThread - 1) /
+          (thread_count * kBandsPerThread)));
+
+  size_t band_count = (height + band_height - 1) / band_height;
+  thread_count = std::min(thread_count, band_count);
+
+  std::atomic<size_t> next_band(0);
+  std::atomic<int> result(OK);
+  auto worker = [&] () {
+    for (;;) {
+      auto band = next_band++;
+      if (band >= band_count) {
+        break;
+      }
+
+      PLOTFX_PROFILE_SCOPE("rasterizeTiled::band");
+      uint32_t y0 = band * band_height;
+      uint32_t y1 = std::min(uint32_t(height), y0 + band_height);
+
+      Rasterizer band_rasterizer(
+          data + size_t(y0) * stride,
+          width,
+          y1 - y0,
+          stride,
+          target->measures);
+
+      band_rasterizer.setOrigin(0, y0);
+      band_rasterizer.pushClip(Rectangle(0, y0, width, y1 - y0));
+      if (auto rc = list.replay(&band_rasterizer); rc != OK) {
+        result = rc;
+      }
+
+      cairo_surface_flush(band_rasterizer.cr_surface);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  cairo_surface_mark_dirty(target->cr_surface);
+  return Status(result.load());
+}
+
+Status rasterizeBands(
+    const DisplayList& list,
+    uint32_t width,
+    uint32_t height,
+    const MeasureTable& measures,
+    uint32_t band_rows,
+    const Colour& background,
+    const BandSink& sink) {
+  if (width == 0 || height == 0 || band_rows == 0) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+
+  band_rows = std::min(band_rows, height);
+
+  Rasterizer band_rasterizer(width, band_rows, measures);
+  if (cairo_surface_status(band_rasterizer.cr_surface) != CAIRO_STATUS_SUCCESS) {
+    return ERROR;
+  }
+
+  auto data = cairo_image_surface_get_data(band_rasterizer.cr_surface);
+  auto stride = cairo_image_surface_get_stride(band_rasterizer.cr_surface);
+
+  for (uint32_t y0 = 0; y0 < height; y0 += band_rows) {
+    PLOTFX_PROFILE_SCOPE("rasterizeBands::band");
+    auto y1 = std::min(height, y0 + band_rows);
+
+    /* replace the previous band's pixels */
+    band_rasterizer.resetClip();
+    band_rasterizer.setOrigin(0, 0);
+    band_rasterizer.clear(background);
+
+    /* start every band with cairo's default source, as a fresh surface would */
+    cairo_set_source_rgb(band_rasterizer.cr_ctx, 0, 0, 0);
+
+    band_rasterizer.setOrigin(0, y0);
+    band_rasterizer.pushClip(Rectangle(0, y0, width, y1 - y0));
+    if (auto rc = list.replay(&band_rasterizer); rc != OK) {
+      return rc;
+    }
+
+    cairo_surface_flush(band_rasterizer.cr_surface);
+    if (auto rc = sink(data, y1 - y0, stride); rc != OK) {
+      return rc;
+    }
+  }
+
+  return OK;
+}
+
+} // namespace plotfx
+
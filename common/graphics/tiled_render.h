@@ -0,0 +1,79 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdlib.h>
+#include <stdint.h>
+#include <functional>
+#include "plotfx.h"
+#include "colour.h"
+#include "measure.h"
+
+namespace plotfx {
+class DisplayList;
+class Rasterizer;
+
+/**
+ * Rasterize a display list into the target using a pool of threads. The
+ * target surface is split into horizontal bands; every band gets its own
+ * rasterizer that draws directly into the target's pixel buffer, clipped to
+ * the band, so no stitching copy is needed. Bands are translated by whole
+ * pixels only, so the result is the same as replaying the list into the
+ * target on a single thread.
+ */
+Status rasterizeTiled(
+    const DisplayList& list,
+    Rasterizer* target,
+    size_t thread_count);
+
+/**
+ * Receives one finished band of premultiplied ARGB32 pixels
+ */
+using BandSink = std::function<Status (
+    const unsigned char* data,
+    uint32_t row_count,
+    uint32_t stride)>;
+
+/**
+ * Rasterize a display list for a canvas of the given size one horizontal band
+ * of `band_rows` rows at a time, top to bottom, and pass each band to the sink
+ * before the next one is drawn. Only a single band buffer is allocated, so
+ * memory use is bounded by the band size rather than the canvas size.
+ */
+Status rasterizeBands(
+    const DisplayList& list,
+    uint32_t width,
+    uint32_t height,
+    const MeasureTable& measures,
+    uint32_t band_rows,
+    const Colour& background,
+    const BandSink& sink);
+
+} // namespace plotfx
+
@@ -0,0 +1,265 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <unistd.h>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include "common/element_tree.h"
+#include "graphics/layer.h"
+#include "graphics/layer_pool.h"
+#include "utils/fileutil.h"
+#include "utils/outputstream.h"
+#include "utils/mapped_file.h"
+#include "utils/profile.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+#include "batch.h"
+
+namespace plotfx {
+
+BatchJobResult::BatchJobResult() :
+    rc(ReturnCode::success()),
+    runtime_us(0) {}
+
+ReturnCode readBatchManifest(std::istream* input, std::vector<BatchJob>* jobs) {
+  bool has_stdout_job = false;
+  std::string line;
+  for (size_t lineno = 1; std::getline(*input, line); ++lineno) {
+    std::istringstream fields(line);
+
+    BatchJob job;
+    if (!(fields >> job.input_path) || job.input_path[0] == '#') {
+      continue;
+    }
+
+    std::string extra;
+    if (!(fields >> job.output_path) || (fields >> extra)) {
+      return ReturnCode::errorf(
+          "EARG",
+          "invalid batch manifest line $0; expected: <input> <output>",
+          lineno);
+    }
+
+    /* concurrent workers would interleave their output on stdout */
+    if (job.output_path == "-") {
+      if (has_stdout_job) {
+        return ReturnCode::errorf(
+            "EARG",
+            "invalid batch manifest line $0; only one job can write to stdout",
+            lineno);
+      }
+
+      has_stdout_job = true;
+    }
+
+    jobs->emplace_back(std::move(job));
+  }
+
+  return ReturnCode::success();
+}
+
+static OutputFormat getOutputFormat(const std::string& path) {
+  static const std::string ext = ".svg";
+  auto is_svg =
+      path.size() >= ext.size() &&
+      path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+
+  return is_svg ? OutputFormat::SVG : OutputFormat::PNG;
+}
+
+static ReturnCode checkOutputPath(const std::string& path) {
+  static const std::string ext = ".png";
+  auto is_png =
+      path.size() >= ext.size() &&
+      path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+
+  if (path != "-" && !is_png && getOutputFormat(path) != OutputFormat::SVG) {
+    return ReturnCode::errorf(
+        "EARG",
+        "can't write output file '$0': unsupported file extension",
+        path);
+  }
+
+  return ReturnCode::success();
+}
+
+/*
+ * Load the job's spec and check its output path. Shared by the framebuffer
+ * and the banded render path
+ */
+static ReturnCode loadJob(const BatchJob& job, ElementTree* elems) {
+  std::unique_ptr<MappedFile> spec;
+  if (auto rc = MappedFile::openFile(job.input_path, &spec); !rc.isSuccess()) {
+    return rc;
+  }
+
+  // relative paths in the spec are relative to the spec file, not to the
+  // working directory
+  std::string base_path;
+  if (auto sep = job.input_path.rfind('/'); sep != std::string::npos) {
+    base_path = sep == 0 ? "/" : job.input_path.substr(0, sep);
+  }
+
+  if (auto rc = buildElementTree(spec->view(), elems, base_path); !rc.isSuccess()) {
+    return rc;
+  }
+
+  return checkOutputPath(job.output_path);
+}
+
+/*
+ * Run the render function against the job's output. Files are written to a
+ * temporary file next to the output that is only renamed over the output
+ * path once rendering succeeded, so a failed job leaves an existing output
+ * untouched. "-" streams to stdout
+ */
+static ReturnCode writeOutput(
+    const std::string& path,
+    std::function<ReturnCode (OutputStream* os)> render) {
+  if (path == "-") {
+    auto os = OutputStream::getStdout();
+    return render(os.get());
+  }
+
+  static std::atomic<uint64_t> tmp_id(0);
+  auto tmp_path = StringUtil::format(
+      "$0.tmp.$1.$2",
+      path,
+      getpid(),
+      tmp_id++);
+
+  auto rc = ReturnCode::success();
+  try {
+    {
+      auto os = FileOutputStream::openFile(tmp_path, O_CREAT | O_TRUNC | O_EXCL);
+      rc = render(os.get());
+    }
+
+    if (rc.isSuccess()) {
+      FileUtil::mv(tmp_path, path);
+    }
+  } catch (const std::exception& e) {
+    rc = ReturnCode::errorf(
+        "EIO",
+        "can't write output file '$0': $1",
+        path,
+        e.what());
+  }
+
+  if (!rc.isSuccess()) {
+    FileUtil::rm(tmp_path);
+  }
+
+  return rc;
+}
+
+ReturnCode renderJob(
+    const BatchJob& job,
+    Layer* frame,
+    const RenderOptions& opts /* = RenderOptions() */) {
+  PLOTFX_PROFILE_SCOPE("renderJob");
+
+  ElementTree elems;
+  if (auto rc = loadJob(job, &elems); !rc.isSuccess()) {
+    return rc;
+  }
+
+  auto format = getOutputFormat(job.output_path);
+  return writeOutput(job.output_path, [&] (OutputStream* os) {
+    return renderToStream(elems, format, frame, opts, os);
+  });
+}
+
+ReturnCode renderJobBanded(
+    const BatchJob& job,
+    const RenderOptions& opts) {
+  PLOTFX_PROFILE_SCOPE("renderJobBanded");
+
+  ElementTree elems;
+  if (auto rc = loadJob(job, &elems); !rc.isSuccess()) {
+    return rc;
+  }
+
+  auto format = getOutputFormat(job.output_path);
+  return writeOutput(job.output_path, [&] (OutputStream* os) {
+    return renderToStreamBanded(elems, format, opts, os);
+  });
+}
+
+void runBatch(
+    const std::vector<BatchJob>& jobs,
+    size_t thread_count,
+    std::vector<BatchJobResult>* results,
+    const RenderOptions& opts /* = RenderOptions() */) {
+  results->clear();
+  results->resize(jobs.size());
+
+  thread_count = std::max(size_t(1), std::min(thread_count, jobs.size()));
+
+  std::atomic<size_t> next_job(0);
+  auto worker = [&jobs, results, &next_job, &opts] () {
+    LayerRef frame;
+    if (opts.band_rows == 0) {
+      frame = LayerPool::get()->acquire(opts.width, opts.height);
+    }
+
+    for (;;) {
+      auto idx = next_job++;
+      if (idx >= jobs.size()) {
+        break;
+      }
+
+      auto& result = (*results)[idx];
+      auto t0 = MonotonicClock::now();
+      if (frame) {
+        result.rc = renderJob(jobs[idx], frame.get(), opts);
+      } else {
+        result.rc = renderJobBanded(jobs[idx], opts);
+      }
+
+      result.runtime_us = MonotonicClock::now() - t0;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+} // namespace plotfx
+
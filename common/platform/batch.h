@@ -0,0 +1,92 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <istream>
+#include <string>
+#include <vector>
+#include "common/render.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+class Layer;
+
+struct BatchJob {
+  std::string input_path;
+  std::string output_path;
+};
+
+struct BatchJobResult {
+  BatchJobResult();
+  ReturnCode rc;
+  uint64_t runtime_us;
+};
+
+/**
+ * Read a batch manifest: one "<input> <output>" pair per line. Blank lines
+ * and lines starting with '#' are ignored. At most one job may write to
+ * stdout ("-")
+ */
+ReturnCode readBatchManifest(std::istream* input, std::vector<BatchJob>* jobs);
+
+/**
+ * Render a single spec file into the given (reused) layer and write the
+ * result to the output path. Output paths ending in ".svg" are written with
+ * the vector backend, all other outputs are rasterized. The output path "-"
+ * writes a PNG to stdout. Files are only replaced once rendering succeeded;
+ * a failed job leaves an existing output file untouched
+ */
+ReturnCode renderJob(
+    const BatchJob& job,
+    Layer* frame,
+    const RenderOptions& opts = RenderOptions());
+
+/**
+ * Render a single spec file without a full-size framebuffer (see
+ * renderToStreamBanded). Output paths are handled as in renderJob
+ */
+ReturnCode renderJobBanded(
+    const BatchJob& job,
+    const RenderOptions& opts);
+
+/**
+ * Render all jobs using a fixed-size pool of worker threads. Each worker takes
+ * one layer from the process-wide layer pool and reuses it across jobs (unless
+ * banded rendering is enabled). Fonts and shaped text are shared through the
+ * process-wide caches. One result is returned per job (in job order); a
+ * failed job does not abort the batch
+ */
+void runBatch(
+    const std::vector<BatchJob>& jobs,
+    size_t thread_count,
+    std::vector<BatchJobResult>* results,
+    const RenderOptions& opts = RenderOptions());
+
+} // namespace plotfx
+
@@ -34,16 +34,22 @@
 #include <signal.h>
 #include <regex>
 #include <iostream>
+#include <fstream>
+#include <thread>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/file.h>
 #include "plotfx.h"
 #include "common/element_tree.h"
+#include "common/platform/batch.h"
 #include "graphics/layer.h"
 #include <utils/flagparser.h>
 #include <utils/fileutil.h>
+#include <utils/mapped_file.h>
 #include <utils/return_code.h>
+#include <utils/profile.h>
 #include <utils/stringutil.h>
+#include <utils/wallclock.h>
 
 using namespace plotfx;
 
@@ -51,14 +57,126 @@ void printError(const ReturnCode& rc) {
   std::cerr << StringUtil::format("ERROR: $0", rc.getMessage()) << std::endl;
 }
 
+int runSingleCommand(
+    const std::string& input_path,
+    const std::string& output_path,
+    const RenderOptions& opts) {
+  if (input_path.empty() || output_path.empty()) {
+    std::cerr << "ERROR: need --in and --out (or --batch)" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto job = BatchJob{input_path, output_path};
+  auto rc = ReturnCode::success();
+  if (opts.band_rows > 0) {
+    rc = renderJobBanded(job, opts);
+  } else {
+    Layer frame{double(opts.width), double(opts.height)};
+    rc = renderJob(job, &frame, opts);
+  }
+
+  if (!rc.isSuccess()) {
+    printError(rc);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int runBatchCommand(
+    const std::string& manifest_path,
+    uint64_t thread_count,
+    const RenderOptions& opts) {
+  std::vector<BatchJob> jobs;
+  ReturnCode rc = ReturnCode::success();
+  if (manifest_path == "-") {
+    rc = readBatchManifest(&std::cin, &jobs);
+  } else {
+    std::ifstream manifest(manifest_path);
+    if (!manifest) {
+      rc = ReturnCode::errorf("EIO", "can't open batch manifest '$0'", manifest_path);
+    } else {
+      rc = readBatchManifest(&manifest, &jobs);
+    }
+  }
+
+  if (!rc.isSuccess()) {
+    printError(rc);
+    return EXIT_FAILURE;
+  }
+
+  thread_count = std::max(thread_count, uint64_t(1));
+
+  auto t0 = MonotonicClock::now();
+  std::vector<BatchJobResult> results;
+  runBatch(jobs, thread_count, &results, opts);
+  auto runtime_us = std::max(MonotonicClock::now() - t0, uint64_t(1));
+
+  size_t failed = 0;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    if (!results[i].rc.isSuccess()) {
+      std::cerr
+          << StringUtil::format(
+                "ERROR: $0: $1",
+                jobs[i].input_path,
+                results[i].rc.getMessage())
+          << std::endl;
+
+      ++failed;
+    }
+  }
+
+  std::cerr
+      << StringUtil::format(
+            "rendered $0/$1 files in $2ms using $3 threads ($4 files/s)",
+            jobs.size() - failed,
+            jobs.size(),
+            runtime_us / 1000,
+            std::min(thread_count, uint64_t(jobs.size())),
+            uint64_t(jobs.size() * 1000000 / runtime_us))
+      << std::endl;
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, const char** argv) {
   FlagParser flag_parser;
 
   std::string flag_in;
-  flag_parser.defineString("in", true, &flag_in);
+  flag_parser.defineString("in", false, &flag_in);
 
   std::string flag_out;
-  flag_parser.defineString("out", true, &flag_out);
+  flag_parser.defineString("out", false, &flag_out);
+
+  std::string flag_batch;
+  flag_parser.defineString("batch", false, &flag_batch);
+
+  std::string flag_profile;
+  flag_parser.defineString("profile", false, &flag_profile);
+
+  uint64_t flag_threads = 1;
+  flag_parser.defineUInt64("threads", false, &flag_threads);
+
+  uint64_t flag_jobs = std::max(1u, std::thread::hardware_concurrency());
+  flag_parser.defineUInt64("jobs", false, &flag_jobs);
+
+  uint64_t flag_width = 1200;
+  flag_parser.defineUInt64("width", false, &flag_width);
+
+  uint64_t flag_height = 800;
+  flag_parser.defineUInt64("height", false, &flag_height);
+
+  uint64_t flag_band_rows = 0;
+  flag_parser.defineUInt64("band-rows", false, &flag_band_rows);
+
+  uint64_t flag_png_level = PNGOptions().compression_level;
+  flag_parser.defineUInt64("png-level", false, &flag_png_level);
+
+  bool flag_png_palette = false;
+  flag_parser.defineSwitch("png-palette", &flag_png_palette);
+
+  bool flag_svg_text = false;
+  flag_parser.defineSwitch("svg-text", &flag_svg_text);
 
   bool flag_help;
   flag_parser.defineSwitch("help", &flag_help);
@@ -88,6 +206,24 @@ int main(int argc, const char** argv) {
   if (flag_help) {
     std::cerr <<
         "Usage: $ plotfx [OPTIONS]\n"
+        "   --in <file>           Read the plot spec from this file\n"
+        "   --out <file>          Write the rendered image to this file; use '-' to\n"
+        "                         write a PNG to stdout\n"
+        "   --batch <file>        Render all '<in> <out>' pairs listed in this file;\n"
+        "                         use '-' to read the pairs from stdin\n"
+        "   --jobs <n>            Number of render threads in batch mode\n"
+        "   --threads <n>         Rasterize a single plot using n threads (tiled)\n"
+        "   --width <px>          Canvas width (default: 1200)\n"
+        "   --height <px>         Canvas height (default: 800)\n"
+        "   --band-rows <n>       Render and encode PNG output in bands of n rows\n"
+        "                         instead of allocating the whole canvas at once\n"
+        "   --png-level <0-9>     PNG compression level; 0 is fastest, 9 is smallest\n"
+        "                         (default: 6)\n"
+        "   --png-palette         Write indexed colour PNGs (at most 256 colours; more\n"
+        "                         are quantized). Not supported with --band-rows\n"
+        "   --svg-text            Write text in SVG output as <text> elements instead\n"
+        "                         of glyph outlines\n"
+        "   --profile <file>      Write a Chrome trace-event JSON profile to this file\n"
         "   --help                Display this help text and exit\n"
         "   --version             Display the version of this binary and exit\n"
         "\n"
@@ -98,24 +234,52 @@ int main(int argc, const char** argv) {
     return 0;
   }
 
-  auto spec = FileUtil::read(flag_in).toString(); // FIXME
-  plotfx::ElementTree elems;
-  if (auto rc = buildElementTree(spec, &elems); !rc.isSuccess()) {
-    printError(rc);
+  if (!flag_profile.empty()) {
+    Profiler::get()->enable();
+  }
+
+  if (flag_png_level > 9) {
+    std::cerr << "ERROR: --png-level must be between 0 and 9" << std::endl;
     return EXIT_FAILURE;
   }
 
-  Layer frame{1200, 800};
-  frame.clear(Colour{1, 1, 1, 1});
-  if (auto rc = renderElements(elems, &frame); !rc.isSuccess()) {
-    printError(rc);
+  if (flag_png_palette && flag_band_rows > 0) {
+    std::cerr << "ERROR: --png-palette can't be combined with --band-rows" << std::endl;
     return EXIT_FAILURE;
   }
 
-  if (auto rc = frame.writeToFile(flag_out); rc) {
-    std::cerr << "ERROR: can't write output file" << std::endl;
+  if (flag_width == 0 || flag_height == 0) {
+    std::cerr << "ERROR: --width and --height must be at least 1" << std::endl;
     return EXIT_FAILURE;
   }
 
-  return EXIT_SUCCESS;
+  RenderOptions render_opts;
+  render_opts.render_threads = flag_threads;
+  render_opts.width = flag_width;
+  render_opts.height = flag_height;
+  render_opts.band_rows = flag_band_rows;
+  render_opts.png.compression_level = flag_png_level;
+  render_opts.png.threads = flag_threads;
+  render_opts.png.indexed = flag_png_palette;
+  if (flag_svg_text) {
+    render_opts.svg.text_mode = SVGTextMode::TEXT;
+  }
+
+  int rc;
+  if (flag_batch.empty()) {
+    rc = runSingleCommand(flag_in, flag_out, render_opts);
+  } else {
+    rc = runBatchCommand(flag_batch, flag_jobs, render_opts);
+  }
+
+  if (!flag_profile.empty()) {
+    if (auto prc = Profiler::get()->writeTraceFile(flag_profile); !prc.isSuccess()) {
+      printError(prc);
+      return EXIT_FAILURE;
+    }
+  }
+
+  return rc;
 }
+
+
@@ -27,8 +27,7 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#include <regex>
-#include <iostream>
+#include <string.h>
 #include "plist_parser.h"
 #include "utils/stringutil.h"
 
@@ -39,18 +38,22 @@ PropertyListParser::PropertyListParser(
     const char* input,
     size_t input_len) :
     input_(input),
-    input_cur_(input_),
     input_end_(input_ + input_len),
+    input_cur_(input_),
     has_token_(false),
     has_error_(false) {}
 
+PropertyListParser::PropertyListParser(
+    std::string_view input) :
+    PropertyListParser(input.data(), input.size()) {}
+
 const std::string& PropertyListParser::get_error() const {
   return error_msg_;
 }
 
 bool PropertyListParser::parse(PropertyList* plist) {
   TokenType ttype;
-  std::string tbuf;
+  std::string_view tbuf;
   while (getToken(&ttype, &tbuf)) {
     if (!parsePropertyOrList(plist)) {
       return false;
@@ -67,7 +70,7 @@ bool PropertyListParser::parsePropertyOrList(PropertyList* plist) {
   }
 
   TokenType ttype;
-  std::string tbuf;
+  std::string_view tbuf;
   if (!getToken(&ttype, &tbuf)) {
     setError("unexpected end of file; expected COLON or LCBRACE");
     return false;
@@ -100,9 +103,9 @@ bool PropertyListParser::parseProperty(const std::string& pname, PropertyList* p
   prop.name = pname;
 
   TokenType ttype;
-  std::string tbuf;
+  std::string_view tbuf;
   for (; getToken(&ttype, &tbuf) && ttype != T_SEMICOLON; consumeToken()) {
-    PropertyValue pval;
+    auto& pval = prop.values.emplace_back();
     pval.is_literal = true;
 
     switch (ttype) {
@@ -119,7 +122,7 @@ bool PropertyListParser::parseProperty(const std::string& pname, PropertyList* p
         pval.is_literal = false;
         /* fallthrough */
       case T_STRING:
-        pval.data = tbuf;
+        pval.data.assign(tbuf.data(), tbuf.size());
         break;
       default:
         setError(
@@ -128,8 +131,6 @@ bool PropertyListParser::parseProperty(const std::string& pname, PropertyList* p
                 printToken(ttype, tbuf)));
         return false;
     }
-
-    prop.values.emplace_back(pval);
   }
 
   plist->emplace_back(std::move(prop));
@@ -142,7 +143,7 @@ bool PropertyListParser::parsePropertyList(const std::string& pname, PropertyLis
   prop.child = std::make_unique<PropertyList>();
 
   TokenType ttype;
-  std::string tbuf;
+  std::string_view tbuf;
   while (getToken(&ttype, &tbuf) && ttype != T_RCBRACE) {
     if (!parsePropertyOrList(prop.child.get())) {
       return false;
@@ -153,26 +154,30 @@ bool PropertyListParser::parsePropertyList(const std::string& pname, PropertyLis
   return true;
 }
 
-bool PropertyListParser::getToken(
-    TokenType* ttype,
-    std::string* tbuf) const {
-  const char* tbuf_cstr = nullptr;
-  size_t tbuf_len = 0;
-
-  tbuf->clear();
-
-  bool ret = getToken(ttype, &tbuf_cstr, &tbuf_len);
-  if (tbuf_cstr) {
-    tbuf->append(tbuf_cstr, tbuf_len);
+static inline bool isStringDelimiter(char c) {
+  switch (c) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case ';':
+    case '(':
+    case ')':
+    case '{':
+    case '}':
+    case '"':
+    case '\'':
+      return true;
+    default:
+      return false;
   }
-
-  return ret;
 }
 
 bool PropertyListParser::getToken(
     TokenType* ttype,
-    const char** tbuf,
-    size_t* tbuf_len) const {
+    std::string_view* tbuf) const {
   char quote_char = 0;
 
   if (has_token_) {
@@ -214,6 +219,8 @@ bool PropertyListParser::getToken(
     return false;
   }
 
+  token_ = std::string_view();
+
   /* single character tokens */
   switch (*input_cur_) {
 
@@ -275,6 +282,29 @@ bool PropertyListParser::getToken(
   token_type_ = quote_char ? T_STRING_QUOTED : T_STRING;
 
   if (quote_char) {
+    /* fast path: quoted strings without escape sequences are returned as a
+     * view into the input buffer */
+    auto begin = input_cur_;
+    while (
+        input_cur_ < input_end_ &&
+        *input_cur_ != quote_char &&
+        *input_cur_ != '\\') {
+      input_cur_++;
+    }
+
+    if (input_cur_ >= input_end_ || *input_cur_ == quote_char) {
+      token_ = std::string_view(begin, input_cur_ - begin);
+      if (input_cur_ < input_end_) {
+        input_cur_++; // skip the closing quote
+      }
+
+      goto return_token;
+    }
+
+    /* slow path: the string contains a backslash, so copy it into the token
+     * buffer while unescaping */
+    token_buf_.assign(begin, input_cur_ - begin);
+
     bool escaped = false;
     bool eof = false;
     for (; !eof && input_cur_ < input_end_; input_cur_++) {
@@ -309,51 +339,36 @@ bool PropertyListParser::getToken(
       escaped = false;
     }
 
-    quote_char = 0;
+    token_ = token_buf_;
     goto return_token;
   } else {
-    while (
-        *input_cur_ != ' ' &&
-        *input_cur_ != '\t' &&
-        *input_cur_ != '\n' &&
-        *input_cur_ != '\r' &&
-        *input_cur_ != ',' &&
-        *input_cur_ != ':' &&
-        *input_cur_ != ';' &&
-        *input_cur_ != '(' &&
-        *input_cur_ != ')' &&
-        *input_cur_ != '{' &&
-        *input_cur_ != '}' &&
-        *input_cur_ != '"' &&
-        *input_cur_ != '\'' &&
-        input_cur_ < input_end_) {
-      token_buf_ += *input_cur_;
+    auto begin = input_cur_;
+    while (input_cur_ < input_end_ && !isStringDelimiter(*input_cur_)) {
       input_cur_++;
     }
 
+    token_ = std::string_view(begin, input_cur_ - begin);
     goto return_token;
   }
 
 return_token:
   has_token_ = true;
   *ttype = token_type_;
-  *tbuf = token_buf_.c_str();
-  *tbuf_len = token_buf_.size();
+  *tbuf = token_;
   return true;
 }
 
 bool PropertyListParser::consumeToken() {
   has_token_ = false;
-  token_buf_.clear();
+  token_ = std::string_view();
   return true;
 }
 
 bool PropertyListParser::expectAndConsumeToken(TokenType desired_type) {
   TokenType actual_type;
-  const char* tbuf = nullptr;
-  size_t tbuf_len = 0;
+  std::string_view tbuf;
 
-  if (!getToken(&actual_type, &tbuf, &tbuf_len)) {
+  if (!getToken(&actual_type, &tbuf)) {
     return false;
   }
 
@@ -362,7 +377,7 @@ bool PropertyListParser::expectAndConsumeToken(TokenType desired_type) {
         StringUtil::format(
             "unexpected token; expected: $0, got: $1",
             printToken(desired_type),
-            printToken(actual_type, tbuf, tbuf_len)));
+            printToken(actual_type, tbuf)));
 
     return false;
   }
@@ -373,7 +388,8 @@ bool PropertyListParser::expectAndConsumeToken(TokenType desired_type) {
 
 bool PropertyListParser::expectAndConsumeString(std::string* buf) {
   TokenType ttype;
-  if (!getToken(&ttype, buf)) {
+  std::string_view tbuf;
+  if (!getToken(&ttype, &tbuf)) {
     return false;
   }
 
@@ -381,29 +397,23 @@ bool PropertyListParser::expectAndConsumeString(std::string* buf) {
     setError(
         StringUtil::format(
             "unexpected token; expected: STRING, got: $0",
-            printToken(ttype, *buf)));
+            printToken(ttype, tbuf)));
 
     return false;
   }
 
+  buf->assign(tbuf.data(), tbuf.size());
   consumeToken();
   return true;
 }
 
 std::string PropertyListParser::printToken(TokenType type) {
-  return printToken(type, nullptr, 0);
-}
-
-std::string PropertyListParser::printToken(
-    TokenType type,
-    const std::string& buf) {
-  return printToken(type, buf.c_str(), buf.size());
+  return printToken(type, std::string_view());
 }
 
 std::string PropertyListParser::printToken(
     TokenType type,
-    const char* buf,
-    size_t buf_len) {
+    std::string_view buf) {
   std::string out;
   switch (type) {
     case T_STRING: out = "STRING"; break;
@@ -417,9 +427,9 @@ std::string PropertyListParser::printToken(
     case T_RCBRACE: out = "RCBRACE"; break;
   }
 
-  if (buf && buf_len > 0) {
+  if (!buf.empty()) {
     out += "<";
-    out += std::string(buf, buf_len);
+    out += buf;
     out += ">";
   }
 
@@ -434,3 +444,4 @@ void PropertyListParser::setError(const std::string& error) {
 }
 
 } // namespace plist
+
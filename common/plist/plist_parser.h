@@ -31,6 +31,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <string_view>
 #include "plist.h"
 
 namespace plist {
@@ -42,6 +43,8 @@ public:
       const char* input,
       size_t input_len);
 
+  explicit PropertyListParser(std::string_view input);
+
   bool parse(PropertyList* plist);
 
   const std::string& get_error() const;
@@ -60,9 +63,15 @@ protected:
     T_RCBRACE
   };
 
+  /**
+   * Peek at the next token. The returned string view points directly into the
+   * input buffer, except for quoted strings that contain escape sequences,
+   * which are unescaped into an internal buffer. In both cases, the view is
+   * only valid until the next call to consumeToken
+   */
   bool getToken(
       TokenType* type,
-      std::string* buf) const;
+      std::string_view* buf) const;
 
   bool hasToken() const;
 
@@ -72,11 +81,6 @@ protected:
   bool parseProperty(const std::string& pname, PropertyList* plist);
   bool parsePropertyList(const std::string& pname, PropertyList* plist);
 
-  bool getToken(
-      TokenType* type,
-      const char** buf,
-      size_t* buf_len) const;
-
   bool expectAndConsumeToken(TokenType type);
   bool expectAndConsumeString(std::string* buf);
 
@@ -84,12 +88,7 @@ protected:
 
   std::string printToken(
       TokenType type,
-      const std::string& buf);
-
-  std::string printToken(
-      TokenType type,
-      const char* buf,
-      size_t buf_len);
+      std::string_view buf);
 
   void setError(const std::string& error);
 
@@ -101,6 +100,7 @@ protected:
   mutable const char* input_cur_;
   mutable bool has_token_;
   mutable TokenType token_type_;
+  mutable std::string_view token_;
   mutable std::string token_buf_;
 
   bool has_error_;
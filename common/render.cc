@@ -0,0 +1,190 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "element_tree.h"
+#include "graphics/display_list.h"
+#include "graphics/layer.h"
+#include "graphics/layer_pool.h"
+#include "graphics/tiled_render.h"
+#include "utils/buffer.h"
+#include "utils/outputstream.h"
+#include "utils/profile.h"
+#include "render.h"
+
+namespace plotfx {
+
+RenderOptions::RenderOptions() :
+    width(1200),
+    height(800),
+    band_rows(0),
+    render_threads(1) {}
+
+/* the raster outputs are rendered over opaque white; do the same for SVG */
+static const Colour kBackground = Colour{1, 1, 1, 1};
+
+static ReturnCode renderSVG(
+    const ElementTree& elems,
+    Layer* frame,
+    const RenderOptions& opts,
+    OutputStream* os) {
+  DisplayList display_list;
+  frame->rasterizer.beginRecording(&display_list);
+  auto rc = renderElements(elems, frame);
+  frame->rasterizer.endRecording();
+
+  if (!rc.isSuccess()) {
+    return rc;
+  }
+
+  auto svg_opts = opts.svg;
+  svg_opts.background = kBackground;
+
+  CountingOutputStream counting_os(os);
+  rc = writeSVG(
+      display_list,
+      frame->width,
+      frame->height,
+      frame->measures,
+      svg_opts,
+      &counting_os);
+
+  profileCounter(ProfileCounter::BYTES_WRITTEN, counting_os.getCount());
+  return rc;
+}
+
+ReturnCode renderToStream(
+    const ElementTree& elems,
+    OutputFormat format,
+    Layer* frame,
+    const RenderOptions& opts,
+    OutputStream* os) {
+  PLOTFX_PROFILE_SCOPE("renderToStream");
+
+  if (format == OutputFormat::SVG) {
+    return renderSVG(elems, frame, opts, os);
+  }
+
+  frame->clear(kBackground);
+  if (auto rc = renderElements(elems, frame, opts.render_threads); !rc.isSuccess()) {
+    return rc;
+  }
+
+  if (frame->writePNG(os, opts.png) != OK) {
+    return ReturnCode::error("EIO", "error while writing PNG");
+  }
+
+  return ReturnCode::success();
+}
+
+ReturnCode renderToStream(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    OutputStream* os) {
+  auto frame = LayerPool::get()->acquire(opts.width, opts.height);
+  return renderToStream(elems, format, frame.get(), opts, os);
+}
+
+ReturnCode renderToStreamBanded(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    OutputStream* os) {
+  PLOTFX_PROFILE_SCOPE("renderToStreamBanded");
+
+  if (opts.band_rows == 0) {
+    return ReturnCode::error("EARG", "band size must be at least one row");
+  }
+
+  DisplayList display_list;
+  Layer frame(&display_list, opts.width, opts.height);
+
+  if (format == OutputFormat::SVG) {
+    return renderSVG(elems, &frame, opts, os);
+  }
+
+  if (auto rc = renderElements(elems, &frame); !rc.isSuccess()) {
+    return rc;
+  }
+
+  frame.rasterizer.endRecording();
+
+  /* the bands are rendered over an opaque background */
+  CountingOutputStream counting_os(os);
+  PNGWriter png(&counting_os, opts.png);
+  auto rc = png.begin(opts.width, opts.height, PixelFormat::RGB8);
+  if (rc == OK) {
+    rc = rasterizeBands(
+        display_list,
+        opts.width,
+        opts.height,
+        frame.measures,
+        opts.band_rows,
+        kBackground,
+        [&png] (const unsigned char* data, uint32_t row_count, uint32_t stride) {
+          PLOTFX_PROFILE_SCOPE("png_write_band");
+          return png.writeRowsARGB32(data, row_count, stride);
+        });
+  }
+
+  if (rc == OK) {
+    rc = png.finish();
+  }
+
+  profileCounter(ProfileCounter::BYTES_WRITTEN, counting_os.getCount());
+
+  if (rc != OK) {
+    return ReturnCode::error("EIO", "error while writing PNG");
+  }
+
+  return ReturnCode::success();
+}
+
+ReturnCode renderToBuffer(
+    const ElementTree& elems,
+    OutputFormat format,
+    Layer* frame,
+    const RenderOptions& opts,
+    Buffer* out) {
+  out->clear();
+  BufferOutputStream os(out);
+  return renderToStream(elems, format, frame, opts, &os);
+}
+
+ReturnCode renderToBuffer(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    Buffer* out) {
+  out->clear();
+  BufferOutputStream os(out);
+  return renderToStream(elems, format, opts, &os);
+}
+
+} // namespace plotfx
@@ -0,0 +1,137 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdint.h>
+#include "graphics/png.h"
+#include "graphics/svg.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+class Buffer;
+class Layer;
+class OutputStream;
+struct ElementTree;
+
+enum class OutputFormat {
+  PNG,
+  SVG
+};
+
+struct RenderOptions {
+  RenderOptions();
+
+  /**
+   * Canvas size in pixels
+   */
+  uint32_t width;
+  uint32_t height;
+
+  /**
+   * If non-zero, raster outputs are rendered and encoded in horizontal bands
+   * of this many rows instead of into a full-size frame (see
+   * renderToStreamBanded)
+   */
+  uint32_t band_rows;
+
+  /**
+   * Rasterize each frame in parallel tiles using this many threads
+   */
+  size_t render_threads;
+
+  /**
+   * Options for raster (PNG) outputs
+   */
+  PNGOptions png;
+
+  /**
+   * Options for SVG outputs
+   */
+  SVGOptions svg;
+};
+
+/**
+ * Render the element tree into the given (reused) layer and encode the result
+ * in the requested format into the output stream. Nothing is written to the
+ * filesystem, so this is the entry point for embedding plotfx in a service
+ */
+ReturnCode renderToStream(
+    const ElementTree& elems,
+    OutputFormat format,
+    Layer* frame,
+    const RenderOptions& opts,
+    OutputStream* os);
+
+/**
+ * Like renderToStream, but the layer is taken from the process-wide layer
+ * pool (and returned to it afterwards), so repeated renders of the same size
+ * reuse the same pixel buffer
+ */
+ReturnCode renderToStream(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    OutputStream* os);
+
+/**
+ * Render the element tree without a full-size framebuffer. The draw calls are
+ * recorded, then rasterized in bands of opts.band_rows rows, each of which is
+ * encoded as part of the PNG output before the next band is drawn. Memory use
+ * is bounded by the band size, so this works for canvases that would not fit
+ * in memory as a whole
+ */
+ReturnCode renderToStreamBanded(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    OutputStream* os);
+
+/**
+ * Render the element tree and store the encoded image in `out`. The buffer is
+ * cleared first but keeps its allocation, so a buffer that is reused across
+ * renders stops allocating once it has grown to the size of the output
+ */
+ReturnCode renderToBuffer(
+    const ElementTree& elems,
+    OutputFormat format,
+    Layer* frame,
+    const RenderOptions& opts,
+    Buffer* out);
+
+/**
+ * Like renderToBuffer, but using a layer from the process-wide layer pool
+ */
+ReturnCode renderToBuffer(
+    const ElementTree& elems,
+    OutputFormat format,
+    const RenderOptions& opts,
+    Buffer* out);
+
+} // namespace plotfx
+
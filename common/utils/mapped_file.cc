@@ -0,0 +1,110 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_file.h"
+
+namespace plotfx {
+
+ReturnCode MappedFile::openFile(
+    const std::string& path,
+    std::unique_ptr<MappedFile>* file) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return ReturnCode::errorf(
+        "EIO",
+        "can't open file '$0': $1",
+        path,
+        strerror(errno));
+  }
+
+  struct stat fd_stat;
+  if (fstat(fd, &fd_stat) < 0) {
+    auto err = errno;
+    close(fd);
+    return ReturnCode::errorf(
+        "EIO",
+        "fstat('$0') failed: $1",
+        path,
+        strerror(err));
+  }
+
+  /* mmap(2) refuses zero length mappings */
+  size_t size = fd_stat.st_size;
+  if (size == 0) {
+    close(fd);
+    file->reset(new MappedFile(nullptr, 0));
+    return ReturnCode::success();
+  }
+
+  auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  auto err = errno;
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    return ReturnCode::errorf(
+        "EIO",
+        "mmap('$0') failed: $1",
+        path,
+        strerror(err));
+  }
+
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  file->reset(new MappedFile(data, size));
+  return ReturnCode::success();
+}
+
+MappedFile::MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(data_, size_);
+  }
+}
+
+const char* MappedFile::data() const {
+  return static_cast<const char*>(data_);
+}
+
+size_t MappedFile::size() const {
+  return size_;
+}
+
+std::string_view MappedFile::view() const {
+  return std::string_view(data(), size_);
+}
+
+} // namespace plotfx
+
@@ -162,5 +162,20 @@ size_t BufferOutputStream::write(const char* data, size_t size) {
   return size;
 }
 
+CountingOutputStream::CountingOutputStream(
+    OutputStream* os) :
+    os_(os),
+    count_(0) {}
+
+size_t CountingOutputStream::write(const char* data, size_t size) {
+  auto n = os_->write(data, size);
+  count_ += n;
+  return n;
+}
+
+size_t CountingOutputStream::getCount() const {
+  return count_;
+}
+
 } // fnord
 
@@ -175,5 +175,28 @@ protected:
   Buffer* buf_;
 };
 
+class CountingOutputStream : public OutputStream {
+public:
+
+  /**
+   * Create a new OutputStream that forwards all writes to the provided
+   * stream and counts the number of bytes written
+   *
+   * @param os the target output stream
+   */
+  CountingOutputStream(OutputStream* os);
+
+  size_t write(const char* data, size_t size) override;
+
+  /**
+   * Returns the number of bytes written so far
+   */
+  size_t getCount() const;
+
+protected:
+  OutputStream* os_;
+  size_t count_;
+};
+
 }
 #endif
@@ -0,0 +1,161 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fstream>
+#include <sys/resource.h>
+#include "profile.h"
+#include "wallclock.h"
+
+namespace plotfx {
+
+std::atomic<bool> Profiler::enabled_(false);
+
+static const char* kCounterNames[] = {
+  "points_processed",
+  "path_commands",
+  "glyphs_shaped",
+  "bytes_written",
+  "simplify_points_in",
+  "simplify_points_out",
+};
+
+static uint32_t getThreadID() {
+  static std::atomic<uint32_t> next_id(1);
+  thread_local uint32_t id = next_id++;
+  return id;
+}
+
+static void writeJSONString(std::ostream& os, const char* str) {
+  os << '"';
+  for (; *str; ++str) {
+    switch (*str) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      default:
+        os << *str;
+        break;
+    }
+  }
+  os << '"';
+}
+
+Profiler* Profiler::get() {
+  static Profiler profiler;
+  return &profiler;
+}
+
+Profiler::Profiler() : time_origin_(MonotonicClock::now()) {
+  for (auto& c : counters_) {
+    c = 0;
+  }
+}
+
+void Profiler::enable() {
+  time_origin_ = MonotonicClock::now();
+  enabled_ = true;
+}
+
+void Profiler::addEvent(const char* name, uint64_t begin_us, uint64_t end_us) {
+  Event e;
+  e.name = name;
+  e.thread_id = getThreadID();
+  e.begin_us = begin_us;
+  e.end_us = end_us;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  events_.emplace_back(e);
+}
+
+void Profiler::addCounter(ProfileCounter counter, uint64_t delta) {
+  counters_[size_t(counter)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::getCounter(ProfileCounter counter) const {
+  return counters_[size_t(counter)].load(std::memory_order_relaxed);
+}
+
+ReturnCode Profiler::writeTraceFile(const std::string& path) const {
+  std::ofstream os(path);
+  if (!os) {
+    return ReturnCode::errorf("EIO", "can't open profile output file '$0'", path);
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto now = MonotonicClock::now();
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const auto& e = events_[i];
+    os << (i > 0 ? ",\n" : "\n") << "{\"name\":";
+    writeJSONString(os, e.name);
+    os
+        << ",\"cat\":\"plotfx\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread_id
+        << ",\"ts\":" << (e.begin_us - time_origin_)
+        << ",\"dur\":" << (e.end_us - e.begin_us)
+        << "}";
+  }
+
+  /* counters are reported once, with their final values */
+  struct rusage usage;
+  uint64_t peak_rss_kb = 0;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    peak_rss_kb = usage.ru_maxrss;
+  }
+
+  os
+      << (events_.empty() ? "\n" : ",\n")
+      << "{\"name\":\"counters\",\"cat\":\"plotfx\",\"ph\":\"C\",\"pid\":1,\"tid\":0"
+      << ",\"ts\":" << (now - time_origin_) << ",\"args\":{";
+
+  for (size_t i = 0; i < size_t(ProfileCounter::kCount); ++i) {
+    os << "\"" << kCounterNames[i] << "\":" << counters_[i].load() << ",";
+  }
+
+  /* fraction of the points that were left after path simplification */
+  auto simplify_in = counters_[size_t(ProfileCounter::SIMPLIFY_POINTS_IN)].load();
+  auto simplify_out = counters_[size_t(ProfileCounter::SIMPLIFY_POINTS_OUT)].load();
+  if (simplify_in > 0) {
+    os << "\"simplify_ratio\":" << double(simplify_out) / simplify_in << ",";
+  }
+
+  os << "\"peak_rss_bytes\":" << peak_rss_kb * 1024 << "}}\n]}\n";
+
+  if (!os) {
+    return ReturnCode::errorf("EIO", "write failed: '$0'", path);
+  }
+
+  return ReturnCode::success();
+}
+
+} // namespace plotfx
+
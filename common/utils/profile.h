@@ -0,0 +1,139 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "return_code.h"
+#include "wallclock.h"
+
+namespace plotfx {
+
+enum class ProfileCounter {
+  POINTS_PROCESSED,
+  PATH_COMMANDS,
+  GLYPHS_SHAPED,
+  BYTES_WRITTEN,
+  SIMPLIFY_POINTS_IN,
+  SIMPLIFY_POINTS_OUT,
+  kCount
+};
+
+/**
+ * Collects timed stages and counters and writes them as a Chrome trace-event
+ * JSON file (chrome://tracing, Perfetto). Profiling is disabled by default;
+ * while disabled, scopes and counters reduce to a single relaxed atomic load.
+ */
+class Profiler {
+public:
+
+  static Profiler* get();
+
+  static bool isEnabled();
+
+  void enable();
+
+  void addEvent(const char* name, uint64_t begin_us, uint64_t end_us);
+
+  void addCounter(ProfileCounter counter, uint64_t delta);
+
+  uint64_t getCounter(ProfileCounter counter) const;
+
+  ReturnCode writeTraceFile(const std::string& path) const;
+
+protected:
+
+  struct Event {
+    const char* name;
+    uint32_t thread_id;
+    uint64_t begin_us;
+    uint64_t end_us;
+  };
+
+  Profiler();
+
+  static std::atomic<bool> enabled_;
+  uint64_t time_origin_;
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::atomic<uint64_t> counters_[size_t(ProfileCounter::kCount)];
+};
+
+/**
+ * Records the time between construction and destruction as one trace event.
+ * The name must be a string literal (or otherwise outlive the profiler)
+ */
+class ProfileScope {
+public:
+
+  ProfileScope(const char* name);
+  ~ProfileScope();
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+protected:
+  const char* name_;
+  uint64_t begin_us_;
+};
+
+inline bool Profiler::isEnabled() {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+inline ProfileScope::ProfileScope(
+    const char* name) :
+    name_(nullptr),
+    begin_us_(0) {
+  if (Profiler::isEnabled()) {
+    name_ = name;
+    begin_us_ = MonotonicClock::now();
+  }
+}
+
+inline ProfileScope::~ProfileScope() {
+  if (name_) {
+    Profiler::get()->addEvent(name_, begin_us_, MonotonicClock::now());
+  }
+}
+
+inline void profileCounter(ProfileCounter counter, uint64_t delta) {
+  if (Profiler::isEnabled()) {
+    Profiler::get()->addCounter(counter, delta);
+  }
+}
+
+#define PLOTFX_PROFILE_CONCAT_(A, B) A##B
+#define PLOTFX_PROFILE_CONCAT(A, B) PLOTFX_PROFILE_CONCAT_(A, B)
+#define PLOTFX_PROFILE_SCOPE(NAME) \
+    ::plotfx::ProfileScope PLOTFX_PROFILE_CONCAT(profile_scope_, __LINE__)(NAME)
+
+} // namespace plotfx
+
@@ -29,6 +29,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <string>
+#include <charconv>
 #include <assert.h>
 #include "bufferutil.h"
 #include "stringutil.h"
@@ -361,6 +362,55 @@ bool StringUtil::isNumber(const char* begin, const char* end) {
   return true;
 }
 
+static inline bool isNumberSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+std::errc StringUtil::parseDouble(
+    const char* begin,
+    const char* end,
+    double* value) {
+  while (begin != end && isNumberSpace(*begin)) {
+    ++begin;
+  }
+
+  while (end != begin && isNumberSpace(end[-1])) {
+    --end;
+  }
+
+  /* std::from_chars only accepts a minus sign and no hex prefix */
+  bool negative = false;
+  if (begin != end && (*begin == '+' || *begin == '-')) {
+    negative = *begin == '-';
+    ++begin;
+  }
+
+  auto format = std::chars_format::general;
+  if (end - begin > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X')) {
+    begin += 2;
+    format = std::chars_format::hex;
+  }
+
+  if (begin != end && (*begin == '+' || *begin == '-')) {
+    return std::errc::invalid_argument;
+  }
+
+  auto [ptr, ec] = std::from_chars(begin, end, *value, format);
+  if (ec != std::errc()) {
+    return ec;
+  }
+
+  if (ptr != end) {
+    return std::errc::invalid_argument;
+  }
+
+  if (negative) {
+    *value = -*value;
+  }
+
+  return std::errc();
+}
+
 void StringUtil::toLower(std::string* str) {
   auto& str_ref = *str;
 
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string>
+#include <system_error>
 #include <vector>
 #include "stdtypes.h"
 
@@ -187,6 +188,18 @@ public:
   static bool isNumber(const std::string& str);
   static bool isNumber(const char* begin, const char* end);
 
+  /**
+   * Parse a number with the input rules of strtod: surrounding whitespace, an
+   * explicit sign and hex input ("0x1a", "0x1.8p3") are accepted. Unlike strtod
+   * the whole value has to be consumed
+   *
+   * @param begin the start of the string to parse
+   * @param end the end of the string to parse
+   * @param value the parsed value
+   * @return std::errc() on success, the std::from_chars error otherwise
+   */
+  static std::errc parseDouble(const char* begin, const char* end, double* value);
+
   /**
    * Replace all occurences of pattern with replacement in str
    *
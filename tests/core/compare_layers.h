@@ -0,0 +1,63 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <string.h>
+#include <cairo.h>
+#include <graphics/layer.h>
+
+namespace plotfx {
+
+/**
+ * Compare the pixels of two layers. Layers with a different size or stride
+ * never compare equal
+ */
+inline bool compareLayers(const Layer& a, const Layer& b) {
+  auto surface_a = a.rasterizer.cr_surface;
+  auto surface_b = b.rasterizer.cr_surface;
+  cairo_surface_flush(surface_a);
+  cairo_surface_flush(surface_b);
+
+  auto width = cairo_image_surface_get_width(surface_a);
+  auto height = cairo_image_surface_get_height(surface_a);
+  auto stride = cairo_image_surface_get_stride(surface_a);
+  if (width != cairo_image_surface_get_width(surface_b) ||
+      height != cairo_image_surface_get_height(surface_b) ||
+      stride != cairo_image_surface_get_stride(surface_b)) {
+    return false;
+  }
+
+  return memcmp(
+      cairo_image_surface_get_data(surface_a),
+      cairo_image_surface_get_data(surface_b),
+      size_t(stride) * height) == 0;
+}
+
+} // namespace plotfx
+
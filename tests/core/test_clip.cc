@@ -0,0 +1,213 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <graphics/clip.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_clip_rect_intersect() {
+  auto r = clip_rect_intersect(Rectangle(0, 0, 100, 50), Rectangle(20, 10, 100, 100));
+  EXPECT_EQ(r.x, 20);
+  EXPECT_EQ(r.y, 10);
+  EXPECT_EQ(r.w, 80);
+  EXPECT_EQ(r.h, 40);
+
+  auto d = clip_rect_intersect(Rectangle(0, 0, 10, 10), Rectangle(20, 20, 10, 10));
+  EXPECT_EQ(d.w, 0);
+  EXPECT_EQ(d.h, 0);
+}
+
+void test_clip_line_segment() {
+  Rectangle clip(0, 0, 10, 10);
+
+  /* inside */
+  {
+    double x0 = 1, y0 = 1, x1 = 9, y1 = 9;
+    EXPECT(clip_line_segment(clip, &x0, &y0, &x1, &y1));
+    EXPECT_EQ(x0, 1);
+    EXPECT_EQ(y1, 9);
+  }
+
+  /* crossing both sides */
+  {
+    double x0 = -10, y0 = 5, x1 = 20, y1 = 5;
+    EXPECT(clip_line_segment(clip, &x0, &y0, &x1, &y1));
+    EXPECT_EQ(x0, 0);
+    EXPECT_EQ(x1, 10);
+    EXPECT_EQ(y0, 5);
+    EXPECT_EQ(y1, 5);
+  }
+
+  /* diagonal through a corner region */
+  {
+    double x0 = -5, y0 = 5, x1 = 5, y1 = 15;
+    EXPECT(clip_line_segment(clip, &x0, &y0, &x1, &y1));
+    EXPECT_EQ(x0, 0);
+    EXPECT_EQ(y0, 10);
+    EXPECT_EQ(x1, 0);
+    EXPECT_EQ(y1, 10);
+  }
+
+  /* outside */
+  {
+    double x0 = -5, y0 = -5, x1 = 20, y1 = -1;
+    EXPECT(!clip_line_segment(clip, &x0, &y0, &x1, &y1));
+  }
+
+  /* zero length */
+  {
+    double x0 = 5, y0 = 5, x1 = 5, y1 = 5;
+    EXPECT(clip_line_segment(clip, &x0, &y0, &x1, &y1));
+    double x2 = 15, y2 = 5, x3 = 15, y3 = 5;
+    EXPECT(!clip_line_segment(clip, &x2, &y2, &x3, &y3));
+  }
+}
+
+void test_clip_polyline() {
+  Rectangle clip(0, 0, 10, 10);
+
+  /* fully inside: the path is left as it is */
+  {
+    Path p;
+    p.moveTo(1, 1);
+    p.lineTo(5, 5);
+    p.lineTo(9, 1);
+
+    Path out;
+    EXPECT(!clip_polyline(clip, p.data(), p.size(), &out));
+    EXPECT(out.empty());
+  }
+
+  /* leaves and re-enters the clip */
+  {
+    Path p;
+    p.moveTo(1, 5);
+    p.lineTo(5, 5);
+    p.lineTo(5, 20);
+    p.lineTo(8, 20);
+    p.lineTo(8, 5);
+    p.lineTo(9, 5);
+
+    Path out;
+    EXPECT(clip_polyline(clip, p.data(), p.size(), &out));
+    EXPECT_EQ(out.size(), 6);
+    EXPECT(out[0].command == PathCommand::MOVE_TO);
+    EXPECT(out[1].command == PathCommand::LINE_TO);
+    EXPECT(out[2].command == PathCommand::LINE_TO);
+    EXPECT_EQ(out[2][0], 5);
+    EXPECT_EQ(out[2][1], 10);
+    EXPECT(out[3].command == PathCommand::MOVE_TO);
+    EXPECT_EQ(out[3][0], 8);
+    EXPECT_EQ(out[3][1], 10);
+    EXPECT(out[4].command == PathCommand::LINE_TO);
+    EXPECT(out[5].command == PathCommand::LINE_TO);
+    EXPECT_EQ(out[5][0], 9);
+  }
+
+  /* a long series of which only a few points are visible */
+  {
+    Path p;
+    for (int i = -1000; i < 1000; ++i) {
+      i == -1000 ? p.moveTo(i, 5) : p.lineTo(i, 5);
+    }
+
+    Path out;
+    EXPECT(clip_polyline(clip, p.data(), p.size(), &out));
+    EXPECT_EQ(out.size(), 11);
+    EXPECT_EQ(out[0][0], 0);
+    EXPECT_EQ(out[10][0], 10);
+  }
+
+  /* completely outside */
+  {
+    Path p;
+    p.moveTo(20, 20);
+    p.lineTo(30, 30);
+
+    Path out;
+    EXPECT(clip_polyline(clip, p.data(), p.size(), &out));
+    EXPECT(out.empty());
+  }
+
+  /* paths with curves or closes are not polylines and are left unclipped */
+  {
+    Path p;
+    p.moveTo(1, 1);
+    p.lineTo(20, 20);
+    p.cubicCurveTo(1, 2, 3, 4, 5, 6);
+    p.closePath();
+
+    Path out;
+    EXPECT(!clip_polyline(clip, p.data(), p.size(), &out));
+    EXPECT(out.empty());
+  }
+}
+
+void test_clip_compact_path() {
+  Rectangle clip(0, 0, 10, 10);
+
+  CompactPath p(4);
+  p.moveTo(1, 5);
+  p.lineTo(5, 5);
+  p.lineTo(5, 20);
+  p.lineTo(9, 5);
+
+  CompactPath out;
+  EXPECT(clip_polyline(clip, p, &out));
+  EXPECT_EQ(out.size(), 5);
+  EXPECT(out.command(0) == PathCommand::MOVE_TO);
+  EXPECT(out.command(3) == PathCommand::MOVE_TO);
+  EXPECT_EQ(out.coordCount(), 10);
+  EXPECT_EQ(out.coords()[5], 10);
+  EXPECT_EQ(out.coords()[7], 10);
+  EXPECT_EQ(out.coords()[9], 5);
+
+  CompactPath inside;
+  inside.moveTo(1, 1);
+  inside.lineTo(2, 2);
+  EXPECT(!clip_polyline(clip, inside, &out));
+}
+
+int main() {
+  test_clip_rect_intersect();
+  test_clip_line_segment();
+  test_clip_polyline();
+  test_clip_compact_path();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,121 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <common/config_helpers.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+#define EXPECT_STREQ(A, B) EXPECT(std::string(A) == std::string(B))
+
+static plist::Property mkProperty(const std::vector<std::string>& values) {
+  plist::Property prop;
+  for (const auto& v : values) {
+    prop.values.emplace_back(plist::PropertyValue{v, true});
+  }
+
+  return prop;
+}
+
+void test_parse_data_series() {
+  std::vector<double> data;
+  auto rc = parseDataSeries(mkProperty({"1", "-2.5", "+3", "1e3", ".5"}), &data);
+  EXPECT(rc.isSuccess());
+  EXPECT_EQ(data.size(), 5);
+  EXPECT_EQ(data[0], 1.0);
+  EXPECT_EQ(data[1], -2.5);
+  EXPECT_EQ(data[2], 3.0);
+  EXPECT_EQ(data[3], 1000.0);
+  EXPECT_EQ(data[4], 0.5);
+}
+
+/* the inputs std::stod accepted before the switch to std::from_chars */
+void test_parse_data_series_strtod_compat() {
+  std::vector<double> data;
+  auto rc = parseDataSeries(
+      mkProperty({" 1", "\t+2.5", "  -3 ", "0x1A", "-0x10", "+0X1.8p1", "0x.8"}),
+      &data);
+
+  EXPECT(rc.isSuccess());
+  EXPECT_EQ(data.size(), 7);
+  EXPECT_EQ(data[0], 1.0);
+  EXPECT_EQ(data[1], 2.5);
+  EXPECT_EQ(data[2], -3.0);
+  EXPECT_EQ(data[3], 26.0);
+  EXPECT_EQ(data[4], -16.0);
+  EXPECT_EQ(data[5], 3.0);
+  EXPECT_EQ(data[6], 0.5);
+
+  for (auto v : {"+-1", "--1", "0x", "0x-1", " ", "1 2"}) {
+    EXPECT(!parseDataSeries(mkProperty({v}), &data).isSuccess());
+  }
+}
+
+void test_parse_data_series_append() {
+  std::vector<double> data = {42};
+  auto rc = parseDataSeries(mkProperty({"1", "2"}), &data);
+  EXPECT(rc.isSuccess());
+  EXPECT_EQ(data.size(), 3);
+  EXPECT_EQ(data[0], 42.0);
+  EXPECT_EQ(data[2], 2.0);
+}
+
+void test_parse_data_series_invalid() {
+  std::vector<double> data = {42};
+  auto rc = parseDataSeries(mkProperty({"1", "2", "3x", "4"}), &data);
+  EXPECT(!rc.isSuccess());
+  EXPECT_STREQ(rc.getMessage(), "invalid number at index 2: '3x'");
+  EXPECT_EQ(data.size(), 1);
+
+  rc = parseDataSeries(mkProperty({"1", ","}), &data);
+  EXPECT(!rc.isSuccess());
+  EXPECT_STREQ(rc.getMessage(), "invalid number at index 1: ','");
+
+  rc = parseDataSeries(mkProperty({"1e999"}), &data);
+  EXPECT(!rc.isSuccess());
+  EXPECT_STREQ(rc.getMessage(), "value out of range at index 0: '1e999'");
+}
+
+int main() {
+  test_parse_data_series();
+  test_parse_data_series_strtod_compat();
+  test_parse_data_series_append();
+  test_parse_data_series_invalid();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,168 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <common/data/csv.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+#define EXPECT_STREQ(A, B) EXPECT(std::string(A) == std::string(B))
+
+static std::string writeTempFile(const std::string& data) {
+  char path[] = "/tmp/plotfx_test_csv_XXXXXX";
+  auto fd = mkstemp(path);
+  EXPECT(fd >= 0);
+  close(fd);
+
+  std::ofstream f(path, std::ios::binary);
+  f << data;
+  return path;
+}
+
+void test_read_column() {
+  auto path = writeTempFile(
+      "x,label,y\n"
+      "1,\"a, b\",10\n"
+      "2,\"say \"\"hi\"\"\",20\r\n"
+      "\n"
+      "3,c,30");
+
+  std::unique_ptr<CSVFile> csv;
+  EXPECT(CSVFile::openFile(path, &csv).isSuccess());
+  EXPECT_EQ(csv->getHeader().size(), 3);
+  EXPECT_STREQ(csv->getHeader()[1], "label");
+
+  std::vector<double> xs;
+  EXPECT(csv->readColumn("x", CSVFile::kNoRowLimit, &xs).isSuccess());
+  EXPECT_EQ(xs.size(), 3);
+  EXPECT_EQ(xs[0], 1.0);
+  EXPECT_EQ(xs[2], 3.0);
+
+  std::vector<double> ys;
+  EXPECT(csv->readColumn("y", 2, &ys).isSuccess());
+  EXPECT_EQ(ys.size(), 2);
+  EXPECT_EQ(ys[0], 10.0);
+  EXPECT_EQ(ys[1], 20.0);
+
+  unlink(path.c_str());
+}
+
+void test_read_column_errors() {
+  auto path = writeTempFile("x,y\n1,2\n3,abc\n");
+
+  CSVCache cache;
+  std::vector<double> data;
+  auto rc = cache.readColumn(path, "z", CSVFile::kNoRowLimit, &data);
+  EXPECT(!rc.isSuccess());
+
+  rc = cache.readColumn(path, "y", CSVFile::kNoRowLimit, &data);
+  EXPECT(!rc.isSuccess());
+  EXPECT_STREQ(
+      rc.getMessage(),
+      "CSV file '" + path + "', row 2, column 'y': invalid number 'abc'");
+
+  rc = cache.readColumn(path, "y", 1, &data);
+  EXPECT(rc.isSuccess());
+  EXPECT_EQ(data.size(), 1);
+  EXPECT_EQ(data[0], 2.0);
+
+  unlink(path.c_str());
+}
+
+void test_read_column_number_syntax() {
+  auto path = writeTempFile(
+      "a,b\n"
+      "1, 1.5\n"
+      "+2,\t-0.5 \n"
+      "0x10, 2e1\n");
+
+  std::unique_ptr<CSVFile> csv;
+  EXPECT(CSVFile::openFile(path, &csv).isSuccess());
+
+  std::vector<double> as;
+  EXPECT(csv->readColumn("a", CSVFile::kNoRowLimit, &as).isSuccess());
+  EXPECT_EQ(as.size(), 3);
+  EXPECT_EQ(as[0], 1.0);
+  EXPECT_EQ(as[1], 2.0);
+  EXPECT_EQ(as[2], 16.0);
+
+  std::vector<double> bs;
+  EXPECT(csv->readColumn("b", CSVFile::kNoRowLimit, &bs).isSuccess());
+  EXPECT_EQ(bs.size(), 3);
+  EXPECT_EQ(bs[0], 1.5);
+  EXPECT_EQ(bs[1], -0.5);
+  EXPECT_EQ(bs[2], 20.0);
+
+  unlink(path.c_str());
+}
+
+void test_read_column_base_path() {
+  auto path = writeTempFile("x\n1\n2\n");
+  auto sep = path.rfind('/');
+  auto dir = path.substr(0, sep);
+  auto name = path.substr(sep + 1);
+
+  std::vector<double> data;
+  CSVCache cache;
+  cache.setBasePath(dir);
+  EXPECT(cache.readColumn(name, "x", CSVFile::kNoRowLimit, &data).isSuccess());
+  EXPECT_EQ(data.size(), 2);
+  EXPECT_EQ(data[1], 2.0);
+
+  // absolute paths ignore the base path
+  CSVCache other;
+  other.setBasePath("/nonexistent");
+  data.clear();
+  EXPECT(other.readColumn(path, "x", CSVFile::kNoRowLimit, &data).isSuccess());
+  EXPECT_EQ(data.size(), 2);
+
+  EXPECT(!other.readColumn(name, "x", CSVFile::kNoRowLimit, &data).isSuccess());
+
+  unlink(path.c_str());
+}
+
+int main() {
+  test_read_column();
+  test_read_column_errors();
+  test_read_column_number_syntax();
+  test_read_column_base_path();
+  return EXIT_SUCCESS;
+}
+
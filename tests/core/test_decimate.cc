@@ -0,0 +1,150 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <charts/line_chart.h>
+#include <graphics/decimate.h>
+#include <graphics/layer.h>
+#include "compare_layers.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_decimate_m4_column() {
+  CompactPath path;
+  DecimatorM4 decimator(&path);
+  decimator.addPoint(0.1, 5);
+  decimator.addPoint(0.2, 9);
+  decimator.addPoint(0.3, 7);
+  decimator.addPoint(0.4, 1);
+  decimator.addPoint(0.5, 3);
+  decimator.addPoint(0.6, 4);
+  decimator.flush();
+
+  /* first, max, min, last in original order */
+  EXPECT_EQ(path.size(), 4);
+  EXPECT(path.command(0) == PathCommand::MOVE_TO);
+  EXPECT_EQ(path.coords()[1], 5);
+  EXPECT(path.command(1) == PathCommand::LINE_TO);
+  EXPECT_EQ(path.coords()[3], 9);
+  EXPECT_EQ(path.coords()[5], 1);
+  EXPECT_EQ(path.coords()[7], 4);
+}
+
+void test_decimate_m4_passthrough() {
+  CompactPath path;
+  DecimatorM4 decimator(&path);
+  for (size_t i = 0; i < 10; ++i) {
+    decimator.addPoint(i, i * i);
+  }
+  decimator.flush();
+
+  EXPECT_EQ(path.size(), 10);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(path.coords()[i * 2], i);
+    EXPECT_EQ(path.coords()[i * 2 + 1], i * i);
+  }
+}
+
+void test_decimate_m4_bounded() {
+  CompactPath path;
+  DecimatorM4 decimator(&path);
+  for (size_t i = 0; i < 100000; ++i) {
+    decimator.addPoint(i / 1000.0, (i * 7919) % 1000);
+  }
+  decimator.flush();
+
+  EXPECT(path.size() <= 4 * 100);
+}
+
+static void renderSeries(
+    const linechart::LinechartSeries& series,
+    Layer* layer) {
+  linechart::LinechartConfig config;
+  config.axis_top.mode = AxisMode::OFF;
+  config.axis_right.mode = AxisMode::OFF;
+  config.axis_bottom.mode = AxisMode::OFF;
+  config.axis_left.mode = AxisMode::OFF;
+  config.series.emplace_back(series);
+
+  layer->clear(Colour{1, 1, 1, 1});
+  Rectangle clip(0, 0, layer->width, layer->height);
+  EXPECT(linechart::draw(config, clip, layer).isSuccess());
+}
+
+/* series render at full resolution unless decimation is requested */
+void test_decimate_default_off() {
+  linechart::LinechartSeries series;
+  EXPECT(series.decimate == DecimationMode::OFF);
+}
+
+/*
+ * Sample-and-hold data repeats each point several times. The full path then
+ * only adds zero-length segments, which cairo drops, so the decimated path
+ * must rasterize to exactly the same pixels
+ */
+void test_decimate_rasterized_equal() {
+  linechart::LinechartSeries series;
+  for (size_t i = 0; i < 100; ++i) {
+    for (size_t j = 0; j < 10; ++j) {
+      series.xs.push_back(i);
+      series.ys.push_back((i * 7919) % 211);
+    }
+  }
+
+  Layer full(200, 100);
+  series.decimate = DecimationMode::OFF;
+  renderSeries(series, &full);
+
+  /* 1000 points over 200 columns enables the decimator */
+  Layer decimated(200, 100);
+  series.decimate = DecimationMode::AUTO;
+  renderSeries(series, &decimated);
+
+  EXPECT(compareLayers(full, decimated));
+}
+
+int main() {
+  test_decimate_m4_column();
+  test_decimate_m4_passthrough();
+  test_decimate_m4_bounded();
+  test_decimate_default_off();
+  test_decimate_rasterized_equal();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,120 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <vector>
+#include <graphics/density.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_density_bin() {
+  DensityGrid grid(Rectangle(10, 20, 10, 5), 2);
+  EXPECT_EQ(grid.cols, 5);
+  EXPECT_EQ(grid.rows, 3);
+  EXPECT_EQ(grid.counts.size(), 15);
+
+  double xs[] = {10, 11.9, 12, 19.9, 9.9, 20.1, NAN, 15};
+  double ys[] = {20, 21.9, 20, 25.5, 20, 20, 20, NAN};
+  density_bin(xs, ys, 8, &grid);
+
+  EXPECT_EQ(grid.counts[0], 2);
+  EXPECT_EQ(grid.counts[1], 1);
+  EXPECT_EQ(grid.counts[2 * 5 + 4], 1);
+
+  uint32_t total = 0;
+  for (auto c : grid.counts) {
+    total += c;
+  }
+
+  EXPECT_EQ(total, 4);
+}
+
+void test_density_merge() {
+  DensityGrid a(Rectangle(0, 0, 4, 4), 1);
+  DensityGrid b(Rectangle(0, 0, 4, 4), 1);
+
+  double xs[] = {0.5, 3.5};
+  double ys[] = {0.5, 3.5};
+  density_bin(xs, ys, 2, &a);
+  density_bin(xs, ys, 1, &b);
+  density_merge(b, &a);
+
+  EXPECT_EQ(a.counts[0], 2);
+  EXPECT_EQ(a.counts[15], 1);
+}
+
+void test_density_colourize() {
+  DensityGrid grid(Rectangle(0, 0, 4, 1), 1);
+  grid.counts = {0, 1, 10, 100};
+
+  std::vector<uint32_t> pixels;
+  density_colourize(
+      grid,
+      DensityScale::LOG,
+      Colour::fromRGB(1, 1, 1),
+      Colour::fromRGBA(1, 0, 0, 0.5),
+      &pixels);
+
+  EXPECT_EQ(pixels.size(), 4);
+  EXPECT_EQ(pixels[0], 0);
+  EXPECT_EQ(pixels[1], 0xffffffff);
+  EXPECT_EQ(pixels[3], 0x80800000);
+
+  /* log(10) is halfway between log(1) and log(100) */
+  EXPECT_EQ(pixels[2] >> 24, 0xbf);
+
+  density_colourize(
+      grid,
+      DensityScale::LINEAR,
+      Colour::fromRGB(0, 0, 0),
+      Colour::fromRGB(0, 0, 1),
+      &pixels);
+
+  EXPECT_EQ(pixels[1], 0xff000000);
+  EXPECT_EQ(pixels[2], 0xff000017);
+  EXPECT_EQ(pixels[3], 0xff0000ff);
+}
+
+int main() {
+  test_density_bin();
+  test_density_merge();
+  test_density_colourize();
+  return EXIT_SUCCESS;
+}
+
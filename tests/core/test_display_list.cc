@@ -0,0 +1,272 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <graphics/display_list.h>
+#include <graphics/layer.h>
+#include "compare_layers.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static void recordScene(DisplayList* list) {
+  StrokeStyle style;
+  style.colour = Colour::fromRGB(0.2, 0.4, 0.8);
+
+  Path path;
+  path.moveTo(10, 10);
+  path.lineTo(20, 30);
+  path.cubicCurveTo(1, 2, 3, 4, 5, 6);
+  path.closePath();
+
+  for (size_t i = 0; i < 10; ++i) {
+    list->addStrokePath(Rectangle(0, 0, 100, 100), path.data(), path.size(), style);
+  }
+
+  FontInfo font;
+  font.font_file = "font.ttf";
+  font.font_size = 12;
+
+  GlyphPlacement glyphs[2] = {{42, 1.5, 2.5}, {43, 8.5, 2.5}};
+  list->addTextGlyphs(font, glyphs, 2, "ab");
+
+  MarkerStyle marker;
+  marker.shape = MarkerShape::SQUARE;
+  marker.colour = Colour::fromRGBA(1, 0, 0, 0.5);
+
+  double points[] = {5, 5, 50, 60, 95, 10};
+  list->addMarkers(Rectangle(0, 0, 100, 100), marker, points, 3);
+
+  uint32_t pixels[6] = {0, 0xff000000, 0x80400000, 0, 0, 0xffffffff};
+  list->addBitmap(Rectangle(0, 0, 50, 50), Rectangle(10, 10, 30, 20), pixels, 3, 2);
+}
+
+void test_display_list_serialize() {
+  DisplayList list;
+  list.setDPI(144);
+  recordScene(&list);
+  EXPECT_EQ(list.size(), 13);
+
+  std::string data;
+  list.serialize(&data);
+
+  DisplayList copy;
+  auto rc = DisplayList::deserialize(data, &copy);
+  EXPECT(rc.isSuccess());
+  EXPECT_EQ(copy.size(), 13);
+  EXPECT_EQ(copy.getDPI(), 144);
+  EXPECT_EQ(copy.hash(), list.hash());
+
+  std::string data2;
+  copy.serialize(&data2);
+  EXPECT(data == data2);
+}
+
+void test_display_list_hash() {
+  DisplayList a;
+  DisplayList b;
+  recordScene(&a);
+  recordScene(&b);
+  EXPECT_EQ(a.hash(), b.hash());
+
+  Path path;
+  path.moveTo(0, 0);
+  path.lineTo(1, 1);
+  b.addStrokePath(Rectangle(0, 0, 1, 1), path.data(), path.size(), StrokeStyle{});
+  EXPECT(a.hash() != b.hash());
+}
+
+void test_display_list_deserialize_invalid() {
+  DisplayList list;
+  recordScene(&list);
+
+  std::string data;
+  list.serialize(&data);
+
+  DisplayList copy;
+  EXPECT(!DisplayList::deserialize("", &copy).isSuccess());
+  EXPECT(!DisplayList::deserialize("garbage", &copy).isSuccess());
+
+  for (size_t n = 0; n < data.size(); ++n) {
+    EXPECT(!DisplayList::deserialize(data.substr(0, n), &copy).isSuccess());
+  }
+
+  EXPECT(!DisplayList::deserialize(data + "x", &copy).isSuccess());
+}
+
+void test_display_list_deserialize_corrupt() {
+  DisplayList copy;
+  uint32_t huge = 0xffffffff;
+
+  /* an empty list is the magic, the dpi and five empty tables followed by
+   * the element counts of the path op, path coord, glyph and bitmap arrays
+   * (with the text data in between) */
+  std::string empty;
+  DisplayList().serialize(&empty);
+  size_t counts_offset = 6 + sizeof(double) + 5 * sizeof(uint32_t);
+  size_t counts[] = {
+    counts_offset,
+    counts_offset + 4,
+    counts_offset + 8,
+    counts_offset + 16
+  };
+
+  for (auto offset : counts) {
+    auto data = empty;
+    memcpy(&data[offset], &huge, sizeof(huge));
+    EXPECT(!DisplayList::deserialize(data, &copy).isSuccess());
+  }
+
+  /* the first stroke style follows the one entry clip table; the line width
+   * unit, join and cap bytes are at offsets 0, 9 and 10 */
+  DisplayList list;
+  Path path;
+  path.moveTo(0, 0);
+  path.lineTo(1, 1);
+  list.addStrokePath(Rectangle(0, 0, 1, 1), path.data(), path.size(), StrokeStyle{});
+
+  std::string data;
+  list.serialize(&data);
+  EXPECT(DisplayList::deserialize(data, &copy).isSuccess());
+
+  size_t style_offset = 6 + sizeof(double) + 4 + 4 * sizeof(double) + 4;
+  for (size_t field : {0, 9, 10}) {
+    auto corrupt = data;
+    corrupt[style_offset + field] = 0x7f;
+    EXPECT(!DisplayList::deserialize(corrupt, &copy).isSuccess());
+  }
+}
+
+void test_display_list_compact_path() {
+  Path path;
+  path.moveTo(1.5, 2.5);
+  path.lineTo(3.5, 4.5);
+  path.closePath();
+
+  CompactPath compact_path;
+  compact_path.moveTo(1.5, 2.5);
+  compact_path.lineTo(3.5, 4.5);
+  compact_path.closePath();
+
+  DisplayList a;
+  a.addStrokePath(Rectangle(0, 0, 10, 10), path.data(), path.size(), StrokeStyle{});
+
+  DisplayList b;
+  b.addStrokePath(Rectangle(0, 0, 10, 10), compact_path, StrokeStyle{});
+
+  EXPECT_EQ(a.hash(), b.hash());
+}
+
+static void recordStrokes(DisplayList* list) {
+  StrokeStyle style;
+  style.colour = Colour::fromRGB(0, 0, 0);
+
+  StrokeStyle translucent;
+  translucent.colour = Colour::fromRGBA(0, 0, 0, 0.5);
+
+  auto addLine = [list] (
+      const StrokeStyle& style,
+      double x0,
+      double y0,
+      double x1,
+      double y1) {
+    Path path;
+    path.moveTo(x0, y0);
+    path.lineTo(x1, y1);
+    list->addStrokePath(Rectangle(0, 0, 400, 200), path.data(), path.size(), style);
+  };
+
+  /* ticks far enough apart that their pixels never touch */
+  for (size_t i = 0; i < 10; ++i) {
+    addLine(style, 10.5 + i * 20, 10, 10.5 + i * 20, 30);
+  }
+
+  /* two crossing lines */
+  addLine(style, 10, 100, 100, 150);
+  addLine(style, 10, 150, 100, 100);
+
+  for (size_t i = 0; i < 3; ++i) {
+    addLine(translucent, 210.5 + i * 20, 10, 210.5 + i * 20, 30);
+  }
+}
+
+void test_display_list_coalesce_disjoint() {
+  DisplayList list;
+  recordStrokes(&list);
+  EXPECT_EQ(list.size(), 15);
+
+  DisplayListReplayOptions unmerged_opts;
+  unmerged_opts.coalesce_disjoint_strokes = false;
+
+  /* replay into a recording rasterizer to count the resulting strokes: the
+   * ticks and the first crossing line are merged, the second crossing line
+   * overlaps the first and the translucent ticks are never merged */
+  {
+    DisplayList merged;
+    Layer target(&merged, 400, 200);
+    EXPECT(list.replay(&target.rasterizer) == OK);
+    EXPECT_EQ(merged.size(), 5);
+
+    DisplayList unmerged;
+    Layer unmerged_target(&unmerged, 400, 200);
+    EXPECT(list.replay(&unmerged_target.rasterizer, unmerged_opts) == OK);
+    EXPECT_EQ(unmerged.size(), 15);
+  }
+
+  /* merging must not change a single pixel */
+  Layer merged(400, 200);
+  merged.clear(Colour{1, 1, 1, 1});
+  EXPECT(list.replay(&merged.rasterizer) == OK);
+
+  Layer unmerged(400, 200);
+  unmerged.clear(Colour{1, 1, 1, 1});
+  EXPECT(list.replay(&unmerged.rasterizer, unmerged_opts) == OK);
+
+  EXPECT(compareLayers(merged, unmerged));
+}
+
+int main() {
+  test_display_list_serialize();
+  test_display_list_hash();
+  test_display_list_deserialize_invalid();
+  test_display_list_deserialize_corrupt();
+  test_display_list_compact_path();
+  test_display_list_coalesce_disjoint();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,102 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <common/domain.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_domain_fit_span() {
+  std::vector<double> data = {3, -1, 7, NAN, 2, 9, -4, 0.5, 1};
+  DomainConfig domain;
+  domain_fit_span(data.data(), data.size(), &domain);
+  EXPECT_EQ(*domain.min, -4);
+  EXPECT_EQ(*domain.max, 9);
+}
+
+void test_domain_fit_span_padding() {
+  std::vector<double> data = {0, 5, 10};
+  DomainConfig domain;
+  domain.padding = 0.1;
+  domain.max = 20;
+  domain_fit_span(data.data(), data.size(), &domain);
+  EXPECT_EQ(*domain.min, -2);
+  EXPECT_EQ(*domain.max, 20);
+}
+
+void test_domain_fit_span_empty() {
+  DomainConfig domain;
+  domain_fit_span(nullptr, 0, &domain);
+  EXPECT_EQ(domain.min.value_or(0), 0);
+  EXPECT_EQ(domain.max.value_or(0), 0);
+}
+
+void test_domain_translate_span() {
+  std::vector<double> data;
+  for (size_t i = 0; i < 103; ++i) {
+    data.push_back(i * 0.37 - 5);
+  }
+
+  for (auto inverted : {false, true}) {
+    DomainConfig domain;
+    domain.inverted = inverted;
+    domain_fit_span(data.data(), data.size(), &domain);
+
+    std::vector<double> out(data.size());
+    domain_translate_span(domain, data.data(), out.data(), data.size(), 200, 10);
+
+    /* span and per-point translation must agree to the last bit */
+    for (size_t i = 0; i < data.size(); ++i) {
+      auto expected = 10 + domain_translate(domain, data[i]) * 200;
+      EXPECT_EQ(out[i], expected);
+    }
+
+    EXPECT(fabs(out[0] - (inverted ? 210 : 10)) < 1e-9);
+    EXPECT(fabs(out.back() - (inverted ? 10 : 210)) < 1e-9);
+  }
+}
+
+int main() {
+  test_domain_fit_span();
+  test_domain_fit_span_padding();
+  test_domain_fit_span_empty();
+  test_domain_translate_span();
+  return EXIT_SUCCESS;
+}
+
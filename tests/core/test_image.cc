@@ -0,0 +1,201 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <graphics/image.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static void convertReference(
+    PixelFormat dst_format,
+    const std::vector<uint32_t>& src,
+    std::vector<unsigned char>* dst) {
+  for (auto p : src) {
+    uint32_t a = p >> 24;
+    uint32_t c[3] = {(p >> 16) & 0xff, (p >> 8) & 0xff, p & 0xff};
+    for (size_t i = 0; i < 3; ++i) {
+      dst->push_back(a == 0 ? 0 : (c[i] * 255 + a / 2) / a);
+    }
+
+    if (dst_format == PixelFormat::RGBA8) {
+      dst->push_back(a);
+    }
+  }
+}
+
+/* every valid premultiplied alpha/colour pair, mixed with runs of opaque
+ * pixels so that both the fast and the unpremultiply paths are hit */
+static std::vector<uint32_t> makePixels() {
+  std::vector<uint32_t> pixels;
+  for (uint32_t a = 0; a <= 255; ++a) {
+    for (uint32_t c = 0; c <= a; ++c) {
+      uint32_t g = (c * 7) % (a + 1);
+      uint32_t b = a - c;
+      pixels.push_back((a << 24) | (c << 16) | (g << 8) | b);
+    }
+
+    for (uint32_t i = 0; i < a % 19; ++i) {
+      pixels.push_back(0xff000000 | (a << 16) | (i << 8) | (255 - a));
+    }
+  }
+
+  return pixels;
+}
+
+void test_convert_pixels_argb32() {
+  auto pixels = makePixels();
+
+  for (auto fmt : {PixelFormat::RGBA8, PixelFormat::RGB8}) {
+    auto pixel_size = getPixelSize(fmt);
+
+    /* unaligned starts and odd lengths exercise the kernel tails */
+    for (size_t offset = 0; offset < 9; ++offset) {
+      std::vector<uint32_t> src(pixels.begin() + offset, pixels.end() - offset);
+      std::vector<unsigned char> expected;
+      convertReference(fmt, src, &expected);
+
+      std::vector<unsigned char> out(src.size() * pixel_size + 1, 0xaa);
+      convertPixels_ARGB32(fmt, src.data(), src.size(), out.data());
+      EXPECT_EQ(out.back(), 0xaa);
+      out.pop_back();
+      EXPECT(out == expected);
+    }
+  }
+}
+
+/* every (c, a) pair, including the c > a values a premultiplied surface
+ * never holds, through each kernel the CPU supports */
+void test_convert_pixels_kernels() {
+  std::vector<uint32_t> src;
+  for (uint32_t a = 0; a <= 255; ++a) {
+    for (uint32_t c = 0; c <= 255; ++c) {
+      src.push_back((a << 24) | (c << 16) | ((255 - c) << 8) | (c ^ a));
+    }
+  }
+
+  for (auto fmt : {PixelFormat::RGBA8, PixelFormat::RGB8}) {
+    std::vector<unsigned char> expected(src.size() * getPixelSize(fmt));
+    convertPixels_ARGB32(
+        PixelKernel::SCALAR,
+        fmt,
+        src.data(),
+        src.size(),
+        expected.data());
+
+    for (auto kernel : {PixelKernel::SSE41, PixelKernel::AVX2}) {
+      if (!hasPixelKernel(kernel)) {
+        continue;
+      }
+
+      std::vector<unsigned char> out(expected.size());
+      convertPixels_ARGB32(kernel, fmt, src.data(), src.size(), out.data());
+      EXPECT(out == expected);
+    }
+  }
+}
+
+void test_convert_pixels_opaque() {
+  std::vector<uint32_t> src(37, 0xff102030);
+  src[36] = 0xffa0b0c0;
+
+  std::vector<unsigned char> out(src.size() * 3);
+  convertPixels_ARGB32(PixelFormat::RGB8, src.data(), src.size(), out.data());
+  EXPECT_EQ(out[0], 0x10);
+  EXPECT_EQ(out[1], 0x20);
+  EXPECT_EQ(out[2], 0x30);
+  EXPECT_EQ(out[105], 0x10);
+  EXPECT_EQ(out[108], 0xa0);
+  EXPECT_EQ(out[109], 0xb0);
+  EXPECT_EQ(out[110], 0xc0);
+}
+
+void test_convert_image() {
+  Image rgba(PixelFormat::RGBA8, 3, 2);
+  auto data = static_cast<unsigned char*>(rgba.getData());
+  for (size_t i = 0; i < rgba.getDataSize(); ++i) {
+    data[i] = i;
+  }
+
+  auto rgb = convertImage_RGBA8_RGB8(rgba);
+  EXPECT(rgb.getPixelFormat() == PixelFormat::RGB8);
+  EXPECT_EQ(rgb.getDataSize(), 18);
+
+  auto rgb_data = static_cast<const unsigned char*>(rgb.getData());
+  EXPECT_EQ(rgb_data[3], 4);
+  EXPECT_EQ(rgb_data[17], 22);
+
+  auto rgba2 = convertImage_RGB8_RGBA8(rgb);
+  auto rgba2_data = static_cast<const unsigned char*>(rgba2.getData());
+  EXPECT_EQ(rgba2_data[4], 4);
+  EXPECT_EQ(rgba2_data[7], 0xff);
+  EXPECT_EQ(rgba2_data[22], 22);
+}
+
+void test_fill_pixels() {
+  const uint32_t width = 37;
+  const uint32_t height = 5;
+  const size_t stride = width * 4 + 12;
+
+  for (uint32_t pixel : {0x00000000u, 0xffffffffu, 0x80402010u}) {
+    std::vector<unsigned char> data(stride * height, 0xaa);
+    fillPixels_ARGB32(pixel, data.data(), width, height, stride);
+
+    for (uint32_t y = 0; y < height; ++y) {
+      auto row = &data[y * stride];
+      for (uint32_t x = 0; x < width; ++x) {
+        uint32_t p;
+        memcpy(&p, row + x * 4, 4);
+        EXPECT_EQ(p, pixel);
+      }
+
+      /* the padding at the end of each row is left alone */
+      EXPECT_EQ(row[width * 4], 0xaa);
+    }
+  }
+}
+
+int main() {
+  test_convert_pixels_argb32();
+  test_convert_pixels_kernels();
+  test_convert_pixels_opaque();
+  test_convert_image();
+  test_fill_pixels();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <graphics/layer.h>
+#include <graphics/layer_pool.h>
+#include "compare_layers.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+void test_clear_matches_cairo() {
+  std::vector<Colour> colours = {
+    Colour{1, 1, 1, 1},
+    Colour{0, 0, 0, 0},
+    Colour::fromRGBA(0.2, 0.4, 0.8, 1),
+    Colour::fromRGBA(0.3, 0.61, 0.99, 0.5),
+    Colour::fromRGBA(1, 0, 0.5, 0.01),
+  };
+
+  for (const auto& c : colours) {
+    Layer painted(67, 13);
+    cairo_set_operator(painted.rasterizer.cr_ctx, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_rgba(
+        painted.rasterizer.cr_ctx,
+        c.red(),
+        c.green(),
+        c.blue(),
+        c.alpha());
+    cairo_paint(painted.rasterizer.cr_ctx);
+
+    Layer cleared(67, 13);
+    cleared.clear(Colour::fromRGBA(0.9, 0.1, 0.1, 1));
+    cleared.clear(c);
+    EXPECT(compareLayers(painted, cleared));
+    EXPECT(cleared.opaque == (c.alpha() >= 1));
+  }
+}
+
+void test_layer_pool_reuse() {
+  LayerPool pool(2);
+
+  Layer* first;
+  {
+    auto layer = pool.acquire(300, 200);
+    first = layer.get();
+    layer->rasterizer.pushClip(Rectangle(10, 10, 20, 20));
+  }
+
+  EXPECT(pool.getStats().misses == 1);
+  EXPECT(pool.getStats().idle == 1);
+
+  {
+    auto layer = pool.acquire(300, 200);
+    EXPECT(layer.get() == first);
+    EXPECT(layer->rasterizer.clip_stack.empty());
+
+    /* different size or resolution: a new layer */
+    auto other = pool.acquire(300, 200, 12, 192);
+    EXPECT(other.get() != first);
+    EXPECT(other->measures.dpi == 192);
+  }
+
+  auto stats = pool.getStats();
+  EXPECT(stats.hits == 1);
+  EXPECT(stats.misses == 2);
+  EXPECT(stats.idle == 2);
+
+  /* at most max_idle layers are kept */
+  {
+    auto a = pool.acquire(10, 10);
+    auto b = pool.acquire(20, 20);
+    auto c = pool.acquire(30, 30);
+  }
+
+  EXPECT(pool.getStats().idle == 2);
+
+  pool.clear();
+  EXPECT(pool.getStats().idle == 0);
+}
+
+void test_layer_pool_memory_limit() {
+  /* a 100x100 ARGB32 layer holds 40000 bytes of pixel data */
+  LayerPool pool(8, 100000);
+
+  {
+    auto a = pool.acquire(100, 100);
+    auto b = pool.acquire(100, 100);
+    auto c = pool.acquire(100, 100);
+  }
+
+  auto stats = pool.getStats();
+  EXPECT(stats.idle == 2);
+  EXPECT(stats.memory_used == 80000);
+  EXPECT(stats.memory_limit == 100000);
+
+  /* layers larger than the limit are never pooled */
+  pool.acquire(200, 200);
+  stats = pool.getStats();
+  EXPECT(stats.idle == 2);
+  EXPECT(stats.memory_used == 80000);
+
+  pool.acquire(100, 100);
+  EXPECT(pool.getStats().hits == 1);
+  EXPECT(pool.getStats().memory_used == 80000);
+
+  pool.clear();
+  EXPECT(pool.getStats().memory_used == 0);
+}
+
+int main() {
+  test_clear_matches_cairo();
+  test_layer_pool_reuse();
+  test_layer_pool_memory_limit();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <vector>
+#include <graphics/marker.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static uint32_t pixelAt(
+    const std::vector<uint32_t>& buf,
+    uint32_t width,
+    uint32_t x,
+    uint32_t y) {
+  return buf[y * width + x];
+}
+
+void test_marker_sprite_coverage() {
+  MarkerSprite square(MarkerShape::SQUARE, 4);
+  EXPECT_EQ(square.getMaskSize(), 6);
+
+  /* an aligned square covers exactly 4x4 pixels */
+  auto mask = square.getMask(0, 0);
+  uint32_t covered = 0;
+  for (uint32_t i = 0; i < 6 * 6; ++i) {
+    EXPECT(mask[i] == 0 || mask[i] == 255);
+    covered += mask[i] == 255;
+  }
+
+  EXPECT_EQ(covered, 16);
+
+  /* a circle covers roughly pi * r^2 pixels */
+  MarkerSprite circle(MarkerShape::CIRCLE, 10);
+  double area = 0;
+  auto circle_mask = circle.getMask(2, 1);
+  auto n = circle.getMaskSize();
+  for (uint32_t i = 0; i < n * n; ++i) {
+    area += circle_mask[i] / 255.0;
+  }
+
+  EXPECT(fabs(area - M_PI * 25) < 1.0);
+}
+
+void test_marker_sprite_cache() {
+  auto cache = MarkerSpriteCache::get();
+  auto a = cache->getSprite(MarkerShape::CIRCLE, 5);
+  auto b = cache->getSprite(MarkerShape::CIRCLE, 5.001);
+  auto c = cache->getSprite(MarkerShape::SQUARE, 5);
+  EXPECT(a.get() == b.get());
+  EXPECT(a.get() != c.get());
+}
+
+void test_marker_blit() {
+  const uint32_t width = 16;
+  const uint32_t height = 16;
+  std::vector<uint32_t> buf(width * height, 0);
+
+  MarkerSprite sprite(MarkerShape::SQUARE, 2);
+  double points[] = {4, 4, 12, 12, NAN, 1};
+
+  blitMarkers(
+      sprite,
+      Colour::fromRGB(1, 0, 0),
+      points,
+      3,
+      Rectangle(0, 0, 8, 16),
+      0,
+      0,
+      reinterpret_cast<unsigned char*>(buf.data()),
+      width,
+      height,
+      width * 4,
+      0,
+      height);
+
+  /* the first marker covers the pixels [3, 5) x [3, 5) */
+  EXPECT_EQ(pixelAt(buf, width, 3, 3), 0xffff0000);
+  EXPECT_EQ(pixelAt(buf, width, 4, 4), 0xffff0000);
+  EXPECT_EQ(pixelAt(buf, width, 2, 3), 0);
+  EXPECT_EQ(pixelAt(buf, width, 5, 4), 0);
+
+  /* the second marker is outside of the clip */
+  EXPECT_EQ(pixelAt(buf, width, 11, 11), 0);
+}
+
+void test_marker_blit_origin_and_rows() {
+  const uint32_t width = 8;
+  const uint32_t height = 8;
+  std::vector<uint32_t> buf(width * height, 0);
+
+  MarkerSprite sprite(MarkerShape::SQUARE, 2);
+  double points[] = {104, 54};
+
+  /* the buffer is a tile starting at (100, 50); only rows 0..4 are written */
+  blitMarkers(
+      sprite,
+      Colour::fromRGBA(0, 0, 1, 0.5),
+      points,
+      1,
+      Rectangle(0, 0, 1000, 1000),
+      100,
+      50,
+      reinterpret_cast<unsigned char*>(buf.data()),
+      width,
+      height,
+      width * 4,
+      0,
+      4);
+
+  EXPECT_EQ(pixelAt(buf, width, 3, 3), 0x80000080);
+  EXPECT_EQ(pixelAt(buf, width, 3, 4), 0);
+}
+
+int main() {
+  test_marker_sprite_coverage();
+  test_marker_sprite_cache();
+  test_marker_blit();
+  test_marker_blit_origin_and_rows();
+  return EXIT_SUCCESS;
+}
+
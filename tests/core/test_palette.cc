@@ -0,0 +1,152 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <graphics/palette.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static void pushPixel(std::vector<unsigned char>* rgba, int r, int g, int b, int a) {
+  rgba->push_back(r);
+  rgba->push_back(g);
+  rgba->push_back(b);
+  rgba->push_back(a);
+}
+
+static uint32_t toColour(const unsigned char* rgba) {
+  uint32_t c;
+  memcpy(&c, rgba, 4);
+  return c;
+}
+
+void test_palette_exact() {
+  std::vector<unsigned char> rgba;
+  for (int i = 0; i < 50; ++i) {
+    pushPixel(&rgba, 255, 255, 255, 255);
+    pushPixel(&rgba, i, 0, 0, 255);
+    pushPixel(&rgba, 0, 0, i, i * 5);
+  }
+
+  Palette palette;
+  EXPECT(palette.addColours(rgba.data(), rgba.size() / 4));
+  palette.finish();
+  EXPECT(!palette.isQuantized());
+  EXPECT_EQ(palette.size(), 101);
+
+  /* translucent colours first */
+  EXPECT_EQ(palette.getTranslucentCount(), 50);
+  for (size_t i = 0; i < palette.size(); ++i) {
+    unsigned char c[4];
+    memcpy(c, &palette.getColours()[i], 4);
+    EXPECT((c[3] != 255) == (i < 50));
+  }
+
+  std::vector<uint8_t> indices(rgba.size() / 4);
+  palette.mapPixels(rgba.data(), indices.size(), indices.data());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    EXPECT_EQ(palette.getColours()[indices[i]], toColour(&rgba[i * 4]));
+  }
+}
+
+void test_palette_overflow() {
+  Palette a;
+  Palette b;
+  std::vector<unsigned char> rgba;
+  for (int i = 0; i < 200; ++i) {
+    pushPixel(&rgba, i, 0, 0, 255);
+  }
+
+  EXPECT(a.addColours(rgba.data(), 200));
+  EXPECT(b.addColours(rgba.data() + 100 * 4, 100));
+  EXPECT(a.merge(b));
+  EXPECT_EQ(a.size(), 200);
+
+  rgba.clear();
+  for (int i = 0; i < 57; ++i) {
+    pushPixel(&rgba, i, 1, 0, 255);
+  }
+
+  EXPECT(!a.addColours(rgba.data(), 57));
+}
+
+void test_palette_median_cut() {
+  /* a smooth gradient over all channels: far more than 256 colours */
+  std::vector<unsigned char> rgba;
+  for (int y = 0; y < 256; ++y) {
+    for (int x = 0; x < 256; ++x) {
+      pushPixel(&rgba, x, y, (x + y) / 2, x == 0 ? 0 : 255);
+    }
+  }
+
+  ColourHistogram histogram;
+  histogram.add(rgba.data(), rgba.size() / 4);
+
+  Palette palette;
+  palette_median_cut(histogram, Palette::kMaxColours, &palette);
+  palette.finish();
+  EXPECT(palette.isQuantized());
+  EXPECT(palette.size() <= Palette::kMaxColours);
+  EXPECT(palette.size() > 200);
+
+  std::vector<uint8_t> indices(rgba.size() / 4);
+  palette.mapPixels(rgba.data(), indices.size(), indices.data());
+
+  double err = 0;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    unsigned char c[4];
+    memcpy(c, &palette.getColours()[indices[i]], 4);
+    for (size_t k = 0; k < 4; ++k) {
+      err += std::abs(int(c[k]) - int(rgba[i * 4 + k]));
+    }
+
+    /* opaque stays opaque */
+    EXPECT((c[3] == 255) == (rgba[i * 4 + 3] == 255));
+  }
+
+  /* mean absolute error per channel */
+  EXPECT(err / (indices.size() * 4) < 6);
+}
+
+int main() {
+  test_palette_exact();
+  test_palette_overflow();
+  test_palette_median_cut();
+  return EXIT_SUCCESS;
+}
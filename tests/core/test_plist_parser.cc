@@ -206,6 +206,47 @@ void test_parse_value_parens() {
   EXPECT_EQ(plist[0][3].is_literal, true);
 }
 
+void test_parse_value_escaped() {
+  std::string confstr =
+      R"(
+        prop0: "hello \"world\"";
+        prop1: 'it\'s';
+        prop2: "back\\slash" "plain";
+      )";
+
+  PropertyListParser parser(confstr.c_str(), confstr.size());
+  PropertyList plist;
+  if (!parser.parse(&plist)) {
+    std::cerr << parser.get_error() << std::endl;
+    std::exit(1);
+  }
+
+  EXPECT_EQ(plist.size(), 3);
+  EXPECT_EQ(plist[0].size(), 1);
+  EXPECT_STREQ(plist[0][0], "hello \"world\"");
+  EXPECT_EQ(plist[1].size(), 1);
+  EXPECT_STREQ(plist[1][0], "it's");
+  EXPECT_EQ(plist[2].size(), 2);
+  EXPECT_STREQ(plist[2][0], "back\\slash");
+  EXPECT_STREQ(plist[2][1], "plain");
+  EXPECT_EQ(plist[2][1].is_literal, false);
+}
+
+void test_parse_string_view() {
+  std::string confstr = "prop0: 123;prop1: 456;";
+
+  PropertyListParser parser(std::string_view(confstr).substr(0, 11));
+  PropertyList plist;
+  if (!parser.parse(&plist)) {
+    std::cerr << parser.get_error() << std::endl;
+    std::exit(1);
+  }
+
+  EXPECT_EQ(plist.size(), 1);
+  EXPECT_EQ(plist[0].size(), 1);
+  EXPECT_STREQ(plist[0][0], "123");
+}
+
 int main() {
   test_parse_simple();
   test_parse_element();
@@ -213,6 +254,8 @@ int main() {
   test_parse_value_list();
   test_parse_value_comma();
   test_parse_value_parens();
+  test_parse_value_escaped();
+  test_parse_string_view();
   return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,286 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <algorithm>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <png.h>
+#include <graphics/png.h>
+#include <utils/outputstream.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static bool decodePNG(
+    const std::string& data,
+    uint32_t* width,
+    uint32_t* height,
+    std::vector<uint8_t>* rgba) {
+  png_image image;
+  memset(&image, 0, sizeof(image));
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_memory(&image, data.data(), data.size())) {
+    return false;
+  }
+
+  image.format = PNG_FORMAT_RGBA;
+  rgba->resize(PNG_IMAGE_SIZE(image));
+  *width = image.width;
+  *height = image.height;
+  return png_image_finish_read(&image, nullptr, rgba->data(), 0, nullptr);
+}
+
+void test_png_writer_argb32() {
+  const uint32_t width = 3;
+  const uint32_t height = 4;
+  uint32_t pixels[width * height] = {
+    0xffff0000, 0xff00ff00, 0xff0000ff,
+    0x80800000, 0x00000000, 0x40202020,
+    0xffffffff, 0xff000000, 0xff102030,
+    0xff000000, 0xff000000, 0xff000000,
+  };
+
+  std::string out;
+  StringOutputStream os(&out);
+  PNGWriter writer(&os);
+  EXPECT(writer.begin(width, height, PixelFormat::RGBA8) == OK);
+
+  /* written in two bands */
+  auto data = reinterpret_cast<const unsigned char*>(pixels);
+  EXPECT(writer.writeRowsARGB32(data, 3, width * 4) == OK);
+  EXPECT(writer.writeRowsARGB32(data + 3 * width * 4, 1, width * 4) == OK);
+  EXPECT(writer.finish() == OK);
+
+  uint32_t w, h;
+  std::vector<uint8_t> rgba;
+  EXPECT(decodePNG(out, &w, &h, &rgba));
+  EXPECT_EQ(w, width);
+  EXPECT_EQ(h, height);
+
+  auto px = [&rgba] (size_t i) {
+    return
+        (uint32_t(rgba[i * 4 + 0]) << 24) |
+        (uint32_t(rgba[i * 4 + 1]) << 16) |
+        (uint32_t(rgba[i * 4 + 2]) << 8) |
+        uint32_t(rgba[i * 4 + 3]);
+  };
+
+  EXPECT_EQ(px(0), 0xff0000ff);
+  EXPECT_EQ(px(2), 0x0000ffff);
+  EXPECT_EQ(px(3), 0xff000080);
+  EXPECT_EQ(px(4), 0x00000000);
+  EXPECT_EQ(px(5), 0x80808040);
+  EXPECT_EQ(px(8), 0x102030ff);
+}
+
+void test_png_writer_row_count() {
+  uint32_t pixels[4] = {0, 0, 0, 0};
+  auto data = reinterpret_cast<const unsigned char*>(pixels);
+
+  std::string out;
+  StringOutputStream os(&out);
+  PNGWriter writer(&os);
+  EXPECT(writer.begin(2, 2, PixelFormat::RGB8) == OK);
+  EXPECT(writer.writeRowsARGB32(data, 1, 8) == OK);
+  EXPECT(writer.writeRowsARGB32(data, 2, 8) != OK);
+  EXPECT(writer.finish() != OK);
+}
+
+void test_png_parallel_encoder() {
+  const uint32_t width = 512;
+  const uint32_t height = 600;
+  const uint32_t stride = width * 4 + 16;
+  std::vector<unsigned char> data(stride * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    auto row = reinterpret_cast<uint32_t*>(&data[y * stride]);
+    for (uint32_t x = 0; x < width; ++x) {
+      uint32_t a = (x * 7 + y) % 3 == 0 ? 255 : (x ^ y) & 0xff;
+      uint32_t c = ((x * y) >> 4) & 0xff;
+      c = c * a / 255;
+      row[x] = (a << 24) | (c << 16) | ((c / 2) << 8) | (a / 3);
+    }
+  }
+
+  std::string reference;
+  {
+    StringOutputStream os(&reference);
+    PNGWriter writer(&os);
+    EXPECT(writer.begin(width, height, PixelFormat::RGBA8) == OK);
+    EXPECT(writer.writeRowsARGB32(data.data(), height, stride) == OK);
+    EXPECT(writer.finish() == OK);
+  }
+
+  uint32_t w, h;
+  std::vector<uint8_t> expected;
+  EXPECT(decodePNG(reference, &w, &h, &expected));
+
+  for (size_t threads : {1, 3, 8}) {
+    for (int level : {0, 1, 6, 9}) {
+      PNGOptions opts;
+      opts.threads = threads;
+      opts.compression_level = level;
+
+      std::string out;
+      StringOutputStream os(&out);
+      auto rc = pngWriteARGB32(
+          data.data(),
+          width,
+          height,
+          stride,
+          PixelFormat::RGBA8,
+          opts,
+          &os);
+
+      EXPECT(rc == OK);
+
+      std::vector<uint8_t> decoded;
+      EXPECT(decodePNG(out, &w, &h, &decoded));
+      EXPECT(w == width && h == height);
+      EXPECT(decoded == expected);
+    }
+  }
+}
+
+static std::string encodeARGB32(
+    const std::vector<uint32_t>& pixels,
+    uint32_t width,
+    uint32_t height,
+    const PNGOptions& opts) {
+  std::string out;
+  StringOutputStream os(&out);
+  auto rc = pngWriteARGB32(
+      reinterpret_cast<const unsigned char*>(pixels.data()),
+      width,
+      height,
+      width * 4,
+      PixelFormat::RGBA8,
+      opts,
+      &os);
+
+  EXPECT(rc == OK);
+  return out;
+}
+
+void test_png_indexed() {
+  const uint32_t width = 300;
+  const uint32_t height = 200;
+
+  /* a few opaque and translucent colours: stored losslessly */
+  std::vector<uint32_t> pixels(width * height);
+  for (uint32_t i = 0; i < pixels.size(); ++i) {
+    uint32_t a = i % 7 == 0 ? 0x80 : 0xff;
+    uint32_t c = ((i / 13) % 40) * 3;
+    pixels[i] = (a << 24) | (std::min(c, a) << 16) | ((a / 2) << 8) | (a / 4);
+  }
+
+  for (size_t threads : {1, 4}) {
+    PNGOptions opts;
+    opts.threads = threads;
+    auto rgba_png = encodeARGB32(pixels, width, height, opts);
+    opts.indexed = true;
+    auto indexed_png = encodeARGB32(pixels, width, height, opts);
+    EXPECT(indexed_png.find("PLTE") != std::string::npos);
+    EXPECT(indexed_png.find("tRNS") != std::string::npos);
+    EXPECT(indexed_png.size() < rgba_png.size());
+
+    uint32_t w, h;
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> decoded;
+    EXPECT(decodePNG(rgba_png, &w, &h, &expected));
+    EXPECT(decodePNG(indexed_png, &w, &h, &decoded));
+    EXPECT(w == width && h == height);
+    EXPECT(decoded == expected);
+  }
+
+  /* 1, 2 and 4 bit indices; odd widths leave partial bytes at the row end */
+  for (uint32_t colours : {2, 3, 11}) {
+    const uint32_t small_width = 13;
+    std::vector<uint32_t> small(small_width * 9);
+    for (uint32_t i = 0; i < small.size(); ++i) {
+      small[i] = 0xff000000 | ((i * 7) % colours) * 0x10305;
+    }
+
+    PNGOptions opts;
+    auto rgba_png = encodeARGB32(small, small_width, 9, opts);
+    opts.indexed = true;
+    auto indexed_png = encodeARGB32(small, small_width, 9, opts);
+
+    uint32_t w, h;
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> decoded;
+    EXPECT(decodePNG(rgba_png, &w, &h, &expected));
+    EXPECT(decodePNG(indexed_png, &w, &h, &decoded));
+    EXPECT(decoded == expected);
+  }
+
+  /* thousands of colours: quantized to 256 */
+  for (uint32_t i = 0; i < pixels.size(); ++i) {
+    uint32_t x = i % width;
+    uint32_t y = i / width;
+    pixels[i] = 0xff000000 | ((x & 0xff) << 16) | ((y & 0xff) << 8) | ((x + y) & 0xff);
+  }
+
+  PNGOptions opts;
+  opts.indexed = true;
+  auto indexed_png = encodeARGB32(pixels, width, height, opts);
+  EXPECT(indexed_png.find("tRNS") == std::string::npos);
+
+  uint32_t w, h;
+  std::vector<uint8_t> decoded;
+  EXPECT(decodePNG(indexed_png, &w, &h, &decoded));
+  EXPECT(w == width && h == height);
+
+  double err = 0;
+  for (uint32_t i = 0; i < pixels.size(); ++i) {
+    err += std::abs(int(decoded[i * 4 + 0]) - int((pixels[i] >> 16) & 0xff));
+    err += std::abs(int(decoded[i * 4 + 1]) - int((pixels[i] >> 8) & 0xff));
+    err += std::abs(int(decoded[i * 4 + 2]) - int(pixels[i] & 0xff));
+    EXPECT(decoded[i * 4 + 3] == 0xff);
+  }
+
+  EXPECT(err / (pixels.size() * 3) < 8);
+}
+
+int main() {
+  test_png_writer_argb32();
+  test_png_writer_row_count();
+  test_png_parallel_encoder();
+  test_png_indexed();
+  return EXIT_SUCCESS;
+}
+
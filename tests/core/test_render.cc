@@ -0,0 +1,141 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <common/element_tree.h>
+#include <common/render.h>
+#include <graphics/layer.h>
+#include <utils/buffer.h>
+#include <utils/outputstream.h>
+#include <utils/profile.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+static const char kSpec[] = R"(
+  linechart {
+    axis-top: off;
+    axis-right: off;
+    axis-bottom: off;
+    axis-left: off;
+
+    series {
+      xs: 10   20   30   40   50   60    70   80  90  100;
+      ys: 1.23 4.32 3.23 6.43 3.45 12.32 8.14 5.2 3.5 2.2;
+    }
+  }
+)";
+
+static bool isPNG(const Buffer& buf) {
+  static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+  return buf.size() > sizeof(signature) &&
+      memcmp(buf.data(), signature, sizeof(signature)) == 0;
+}
+
+void test_render_to_buffer() {
+  ElementTree elems;
+  EXPECT(buildElementTree(kSpec, &elems).isSuccess());
+
+  RenderOptions opts;
+  opts.width = 400;
+  opts.height = 300;
+  Layer frame(opts.width, opts.height);
+
+  Buffer out;
+  EXPECT(renderToBuffer(elems, OutputFormat::PNG, &frame, opts, &out).isSuccess());
+  EXPECT(isPNG(out));
+
+  /* the buffer is reused and holds exactly one image after each render */
+  auto first = out;
+  EXPECT(renderToBuffer(elems, OutputFormat::PNG, &frame, opts, &out).isSuccess());
+  EXPECT(out == first);
+
+  EXPECT(renderToBuffer(elems, OutputFormat::SVG, &frame, opts, &out).isSuccess());
+  EXPECT(out.toString().find("<svg") != std::string::npos);
+}
+
+void test_render_to_stream_banded() {
+  ElementTree elems;
+  EXPECT(buildElementTree(kSpec, &elems).isSuccess());
+
+  RenderOptions opts;
+  opts.width = 400;
+  opts.height = 300;
+  opts.band_rows = 64;
+  Buffer banded;
+  BufferOutputStream os(&banded);
+  EXPECT(renderToStreamBanded(elems, OutputFormat::PNG, opts, &os).isSuccess());
+  EXPECT(isPNG(banded));
+
+  opts.band_rows = 0;
+  EXPECT(!renderToStreamBanded(elems, OutputFormat::PNG, opts, &os).isSuccess());
+}
+
+/* every output path reports the encoded size to --profile */
+void test_render_bytes_written() {
+  ElementTree elems;
+  EXPECT(buildElementTree(kSpec, &elems).isSuccess());
+
+  auto profiler = Profiler::get();
+  profiler->enable();
+
+  RenderOptions opts;
+  opts.width = 400;
+  opts.height = 300;
+
+  for (auto format : {OutputFormat::PNG, OutputFormat::SVG}) {
+    auto before = profiler->getCounter(ProfileCounter::BYTES_WRITTEN);
+    Buffer out;
+    EXPECT(renderToBuffer(elems, format, opts, &out).isSuccess());
+    auto count = profiler->getCounter(ProfileCounter::BYTES_WRITTEN) - before;
+    EXPECT(count == out.size());
+  }
+
+  opts.band_rows = 64;
+  auto before = profiler->getCounter(ProfileCounter::BYTES_WRITTEN);
+  Buffer banded;
+  BufferOutputStream os(&banded);
+  EXPECT(renderToStreamBanded(elems, OutputFormat::PNG, opts, &os).isSuccess());
+  auto count = profiler->getCounter(ProfileCounter::BYTES_WRITTEN) - before;
+  EXPECT(count == banded.size());
+}
+
+int main() {
+  test_render_to_buffer();
+  test_render_to_stream_banded();
+  test_render_bytes_written();
+  return EXIT_SUCCESS;
+}
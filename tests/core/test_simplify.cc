@@ -0,0 +1,156 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <graphics/simplify.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_simplify_collinear() {
+  CompactPath path;
+  path.moveTo(0, 0);
+  for (size_t i = 1; i <= 100; ++i) {
+    path.lineTo(i, i * 0.5);
+    path.lineTo(i, i * 0.5);
+  }
+
+  CompactPath out;
+  path_simplify(path, 0, &out);
+  EXPECT_EQ(out.size(), 2);
+  EXPECT(out.command(0) == PathCommand::MOVE_TO);
+  EXPECT(out.command(1) == PathCommand::LINE_TO);
+  EXPECT_EQ(out.coords()[2], 100);
+  EXPECT_EQ(out.coords()[3], 50);
+}
+
+void test_simplify_keeps_turns() {
+  /* backtracking along the same line must not be removed */
+  CompactPath path;
+  path.moveTo(0, 0);
+  path.lineTo(10, 0);
+  path.lineTo(5, 0);
+
+  CompactPath out;
+  path_simplify(path, 0, &out);
+  EXPECT_EQ(out.size(), 3);
+
+  /* a spike is kept, sub-pixel noise is removed */
+  CompactPath noisy;
+  noisy.moveTo(0, 0);
+  for (size_t i = 1; i < 100; ++i) {
+    noisy.lineTo(i, i == 50 ? 20 : (i % 2) * 0.1);
+  }
+
+  path_simplify(noisy, 0.5, &out);
+  EXPECT(out.size() <= 5);
+  EXPECT(out.size() >= 3);
+
+  bool has_spike = false;
+  for (size_t i = 0; i < out.size(); ++i) {
+    has_spike |= out.coords()[i * 2] == 50 && out.coords()[i * 2 + 1] == 20;
+  }
+
+  EXPECT(has_spike);
+}
+
+void test_simplify_tolerance() {
+  CompactPath path;
+  path.moveTo(0, 0);
+  for (size_t i = 1; i < 1000; ++i) {
+    path.lineTo(i, sin(i * 0.01) * 100);
+  }
+
+  CompactPath out;
+  path_simplify(path, 0.25, &out);
+  EXPECT(out.size() < path.size() / 4);
+
+  /* every input point is within the tolerance of the simplified line */
+  for (size_t i = 0; i < path.size(); ++i) {
+    auto px = path.coords()[i * 2];
+    auto py = path.coords()[i * 2 + 1];
+
+    double min_dist = INFINITY;
+    for (size_t j = 1; j < out.size(); ++j) {
+      double ax = out.coords()[j * 2 - 2];
+      double ay = out.coords()[j * 2 - 1];
+      double bx = out.coords()[j * 2];
+      double by = out.coords()[j * 2 + 1];
+
+      auto t = ((px - ax) * (bx - ax) + (py - ay) * (by - ay)) /
+          ((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+      t = std::max(0.0, std::min(1.0, t));
+      min_dist = std::min(
+          min_dist,
+          hypot(px - (ax + t * (bx - ax)), py - (ay + t * (by - ay))));
+    }
+
+    EXPECT(min_dist <= 0.25 * 1.01);
+  }
+}
+
+void test_simplify_subpaths() {
+  CompactPath path;
+  path.moveTo(0, 0);
+  path.lineTo(5, 0);
+  path.lineTo(10, 0);
+  path.closePath();
+  path.moveTo(20, 20);
+  path.lineTo(20, 20);
+  path.moveTo(30, 30);
+
+  CompactPath out;
+  path_simplify(path, 1, &out);
+  EXPECT_EQ(out.size(), 5);
+  EXPECT(out.command(0) == PathCommand::MOVE_TO);
+  EXPECT(out.command(1) == PathCommand::LINE_TO);
+  EXPECT(out.command(2) == PathCommand::CLOSE);
+  EXPECT(out.command(3) == PathCommand::MOVE_TO);
+  EXPECT(out.command(4) == PathCommand::LINE_TO);
+  EXPECT_EQ(out.coords()[4], 20);
+  EXPECT_EQ(out.coords()[6], 20);
+}
+
+int main() {
+  test_simplify_collinear();
+  test_simplify_keeps_turns();
+  test_simplify_tolerance();
+  test_simplify_subpaths();
+  return EXIT_SUCCESS;
+}
+
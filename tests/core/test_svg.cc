@@ -0,0 +1,200 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <graphics/display_list.h>
+#include <graphics/svg.h>
+#include <utils/outputstream.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static size_t countOccurrences(const std::string& str, const std::string& needle) {
+  size_t n = 0;
+  for (auto pos = str.find(needle); pos != std::string::npos; pos = str.find(needle, pos + 1)) {
+    ++n;
+  }
+
+  return n;
+}
+
+static MeasureTable testMeasures() {
+  MeasureTable m;
+  m.dpi = 96;
+  m.rem = 12;
+  return m;
+}
+
+void test_svg_quantize() {
+  std::string out;
+  StringOutputStream os(&out);
+
+  SVGOptions opts;
+  opts.precision = 1;
+
+  SVGWriter writer(&os, 100, 50, testMeasures(), opts);
+  EXPECT(writer.begin() == OK);
+
+  StrokeStyle style;
+  style.colour = Colour::fromRGB(1, 0, 0);
+
+  Path path;
+  path.moveTo(10.04, 20);
+  path.lineTo(12.5, 20);
+  path.lineTo(12.52, 20.01);
+  path.lineTo(10, 17.25);
+  path.closePath();
+
+  auto rc = writer.strokePath(
+      Rectangle(0, 0, 100, 50),
+      path.data(),
+      path.size(),
+      style);
+
+  EXPECT(rc == OK);
+  EXPECT(writer.finish() == OK);
+
+  EXPECT(out.find("viewBox=\"0 0 100 50\"") != std::string::npos);
+  EXPECT(out.find("stroke=\"#ff0000\"") != std::string::npos);
+  EXPECT(out.find("d=\"M10 20l2.5 0 -2.5 -2.7z\"") != std::string::npos);
+  EXPECT(out.find("</svg>\n") == out.size() - 7);
+}
+
+void test_svg_merge_strokes() {
+  StrokeStyle style;
+  style.colour = Colour::fromRGB(0, 0, 0);
+
+  DisplayList list;
+  list.setDPI(96);
+  for (size_t i = 0; i < 10; ++i) {
+    Path path;
+    path.moveTo(0, i);
+    path.lineTo(100, i);
+    list.addStrokePath(Rectangle(0, 0, 100, 100), path.data(), path.size(), style);
+  }
+
+  style.colour = Colour::fromRGB(0, 0, 1);
+  Path path;
+  path.moveTo(0, 0);
+  path.lineTo(100, 100);
+  list.addStrokePath(Rectangle(0, 0, 100, 100), path.data(), path.size(), style);
+
+  std::string out;
+  StringOutputStream os(&out);
+  auto rc = writeSVG(list, 100, 100, testMeasures(), SVGOptions{}, &os);
+  EXPECT(rc.isSuccess());
+
+  EXPECT_EQ(countOccurrences(out, "<path "), 2);
+  EXPECT_EQ(countOccurrences(out, "<clipPath "), 1);
+  EXPECT_EQ(countOccurrences(out, "M0 9l100 0"), 1);
+}
+
+void test_svg_text_mode() {
+  DisplayList list;
+  list.setDPI(96);
+
+  FontInfo font;
+  font.font_file = "/usr/share/fonts/Roboto-Medium.ttf";
+  font.font_size = 12;
+
+  GlyphPlacement glyphs[2] = {{42, 1.5, 20}, {43, 8.5, 20}};
+  list.addTextGlyphs(font, glyphs, 2, "a<b");
+
+  SVGOptions opts;
+  opts.text_mode = SVGTextMode::TEXT;
+
+  std::string out;
+  StringOutputStream os(&out);
+  auto rc = writeSVG(list, 100, 100, testMeasures(), opts, &os);
+  EXPECT(rc.isSuccess());
+
+  EXPECT(out.find("<text x=\"1.5\" y=\"20\" font-family=\"Roboto\" font-size=\"16\" fill=\"#000000\">a&lt;b</text>") != std::string::npos);
+}
+
+void test_svg_markers() {
+  DisplayList list;
+  list.setDPI(96);
+
+  MarkerStyle marker;
+  marker.size = Measure(Unit::PX, 4);
+  marker.colour = Colour::fromRGB(0, 0, 1);
+
+  double points[] = {10, 10, 20, 20, 500, 500, 30, 30};
+  list.addMarkers(Rectangle(0, 0, 100, 100), marker, points, 4);
+  list.addMarkers(Rectangle(0, 0, 100, 100), marker, points, 1);
+
+  std::string out;
+  StringOutputStream os(&out);
+  auto rc = writeSVG(list, 100, 100, testMeasures(), SVGOptions{}, &os);
+  EXPECT(rc.isSuccess());
+
+  /* the marker shape is defined once; points outside of the clip are dropped */
+  EXPECT_EQ(countOccurrences(out, "<circle id=\"m0\" r=\"2\"/>"), 1);
+  EXPECT_EQ(countOccurrences(out, "<use xlink:href=\"#m0\""), 4);
+  EXPECT_EQ(countOccurrences(out, "fill=\"#0000ff\""), 2);
+}
+
+void test_svg_bitmap() {
+  DisplayList list;
+  list.setDPI(96);
+
+  /* two runs in the first row, one transparent row */
+  uint32_t pixels[8] = {
+    0xffff0000, 0xffff0000, 0x80000080, 0x80000080,
+    0, 0, 0, 0
+  };
+
+  list.addBitmap(Rectangle(0, 0, 100, 100), Rectangle(10, 10, 40, 20), pixels, 4, 2);
+
+  std::string out;
+  StringOutputStream os(&out);
+  auto rc = writeSVG(list, 100, 100, testMeasures(), SVGOptions{}, &os);
+  EXPECT(rc.isSuccess());
+
+  EXPECT_EQ(countOccurrences(out, "<rect x="), 3);
+  EXPECT_EQ(countOccurrences(out, "<rect x=\"10\" y=\"10\" width=\"20\" height=\"10\" fill=\"#ff0000\"/>"), 1);
+  EXPECT_EQ(countOccurrences(out, "fill=\"#0000ff\" fill-opacity=\"0.5\""), 1);
+}
+
+int main() {
+  test_svg_quantize();
+  test_svg_merge_strokes();
+  test_svg_text_mode();
+  test_svg_markers();
+  test_svg_bitmap();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,110 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <graphics/text_cache.h>
+
+using namespace plotfx;
+using namespace plotfx::text;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static ShapedRunRef mkRun(size_t glyphs) {
+  auto run = std::make_shared<ShapedRun>();
+  run->glyphs.resize(glyphs);
+  run->advance_x = glyphs * 10;
+  return run;
+}
+
+static FontInfo mkFont(double size) {
+  FontInfo f;
+  f.font_file = "font.ttf";
+  f.font_size = size;
+  return f;
+}
+
+void test_lookup_insert() {
+  ShapedRunCache cache;
+  ShapedRunRef run;
+  EXPECT(!cache.lookup("20.0", mkFont(12), 96, TextDirection::LTR, &run));
+
+  cache.insert("20.0", mkFont(12), 96, TextDirection::LTR, mkRun(4));
+  EXPECT(cache.lookup("20.0", mkFont(12), 96, TextDirection::LTR, &run));
+  EXPECT_EQ(run->glyphs.size(), 4);
+
+  /* every key component must match */
+  EXPECT(!cache.lookup("20.0", mkFont(14), 96, TextDirection::LTR, &run));
+  EXPECT(!cache.lookup("20.0", mkFont(12), 72, TextDirection::LTR, &run));
+  EXPECT(!cache.lookup("20.0", mkFont(12), 96, TextDirection::RTL, &run));
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.entries, 1);
+}
+
+void test_lru_eviction() {
+  ShapedRunCache cache;
+  cache.insert("a", mkFont(12), 96, TextDirection::LTR, mkRun(1));
+  auto entry_size = cache.getStats().memory_used;
+  cache.setMemoryLimit(entry_size * 2);
+
+  ShapedRunRef run;
+  cache.insert("b", mkFont(12), 96, TextDirection::LTR, mkRun(1));
+  EXPECT(cache.lookup("a", mkFont(12), 96, TextDirection::LTR, &run));
+  cache.insert("c", mkFont(12), 96, TextDirection::LTR, mkRun(1));
+
+  /* "b" was least recently used */
+  EXPECT(cache.lookup("a", mkFont(12), 96, TextDirection::LTR, &run));
+  EXPECT(!cache.lookup("b", mkFont(12), 96, TextDirection::LTR, &run));
+  EXPECT(cache.lookup("c", mkFont(12), 96, TextDirection::LTR, &run));
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(stats.entries, 2);
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT(stats.memory_used <= stats.memory_limit);
+
+  cache.setMemoryLimit(0);
+  EXPECT_EQ(cache.getStats().entries, 0);
+  EXPECT_EQ(cache.getStats().memory_used, 0);
+}
+
+int main() {
+  test_lookup_insert();
+  test_lru_eviction();
+  return EXIT_SUCCESS;
+}
+
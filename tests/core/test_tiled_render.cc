@@ -0,0 +1,129 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <graphics/brush.h>
+#include <graphics/display_list.h>
+#include <graphics/layer.h>
+#include <graphics/tiled_render.h>
+#include "compare_layers.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+static void drawScene(Layer* layer) {
+  StrokeStyle style;
+  style.line_width = Measure(Unit::PT, 2.5);
+  style.colour = Colour::fromRGB(0.2, 0.4, 0.8);
+
+  Path path;
+  for (size_t i = 0; i < 500; ++i) {
+    auto x = 10.3 + i * 1.57;
+    auto y = 150 + ((i * 7919) % 211) * 0.93;
+    i == 0 ? path.moveTo(x, y) : path.lineTo(x, y);
+  }
+
+  strokePath(layer, Rectangle(20.5, 30.25, 700, 400), path, style);
+  strokeLine(layer, 0, 0, 799, 499, style);
+}
+
+void test_tiled_render_identical() {
+  Layer direct(800, 500);
+  direct.clear(Colour{1, 1, 1, 1});
+  drawScene(&direct);
+
+  for (size_t threads : {2, 3, 8}) {
+    Layer tiled(800, 500);
+    tiled.clear(Colour{1, 1, 1, 1});
+
+    DisplayList list;
+    tiled.rasterizer.beginRecording(&list);
+    drawScene(&tiled);
+    tiled.rasterizer.endRecording();
+    EXPECT(list.size() == 2);
+
+    EXPECT(rasterizeTiled(list, &tiled.rasterizer, threads) == OK);
+    EXPECT(compareLayers(direct, tiled));
+  }
+}
+
+void test_banded_render_identical() {
+  Layer direct(800, 500);
+  direct.clear(Colour{1, 1, 1, 1});
+  drawScene(&direct);
+
+  cairo_surface_flush(direct.rasterizer.cr_surface);
+  auto direct_data = cairo_image_surface_get_data(direct.rasterizer.cr_surface);
+  auto direct_stride = cairo_image_surface_get_stride(direct.rasterizer.cr_surface);
+
+  DisplayList list;
+  Layer recording(&list, 800, 500);
+  drawScene(&recording);
+  recording.rasterizer.endRecording();
+  EXPECT(list.size() == 2);
+
+  for (uint32_t band_rows : {1, 37, 64, 500, 1000}) {
+    uint32_t rows_done = 0;
+    auto rc = rasterizeBands(
+        list,
+        800,
+        500,
+        direct.measures,
+        band_rows,
+        Colour{1, 1, 1, 1},
+        [&] (const unsigned char* data, uint32_t row_count, uint32_t stride) {
+          for (uint32_t y = 0; y < row_count; ++y) {
+            auto expected = direct_data + size_t(rows_done + y) * direct_stride;
+            if (memcmp(data + size_t(y) * stride, expected, 800 * 4) != 0) {
+              return ERROR;
+            }
+          }
+
+          rows_done += row_count;
+          return OK;
+        });
+
+    EXPECT(rc == OK);
+    EXPECT(rows_done == 500);
+  }
+}
+
+int main() {
+  test_tiled_render_identical();
+  test_banded_render_identical();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,111 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <png.h>
+
+/**
+ * Compare two PNG files by their decoded pixels. The encoder (filters, zlib
+ * stream, IDAT split) and the colour type of the two files may differ; only
+ * the size and the RGBA8 value of every pixel have to match
+ *
+ * Usage: image_diff <actual.png> <master.png>
+ */
+
+static bool decodePNG(
+    const char* path,
+    uint32_t* width,
+    uint32_t* height,
+    std::vector<uint8_t>* rgba) {
+  png_image image;
+  memset(&image, 0, sizeof(image));
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&image, path)) {
+    std::cerr << "ERROR: " << path << ": " << image.message << std::endl;
+    return false;
+  }
+
+  image.format = PNG_FORMAT_RGBA;
+  rgba->resize(PNG_IMAGE_SIZE(image));
+  *width = image.width;
+  *height = image.height;
+  if (!png_image_finish_read(&image, nullptr, rgba->data(), 0, nullptr)) {
+    std::cerr << "ERROR: " << path << ": " << image.message << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char** argv) {
+  if (argc != 3) {
+    std::cerr << "usage: image_diff <actual.png> <master.png>" << std::endl;
+    return 2;
+  }
+
+  uint32_t a_width;
+  uint32_t a_height;
+  std::vector<uint8_t> a_pixels;
+  if (!decodePNG(argv[1], &a_width, &a_height, &a_pixels)) {
+    return 2;
+  }
+
+  uint32_t b_width;
+  uint32_t b_height;
+  std::vector<uint8_t> b_pixels;
+  if (!decodePNG(argv[2], &b_width, &b_height, &b_pixels)) {
+    return 2;
+  }
+
+  if (a_width != b_width || a_height != b_height) {
+    std::cerr
+        << "image size differs: "
+        << a_width << "x" << a_height << " vs "
+        << b_width << "x" << b_height << std::endl;
+    return 1;
+  }
+
+  size_t diff_count = 0;
+  for (size_t i = 0; i < a_pixels.size(); i += 4) {
+    if (memcmp(&a_pixels[i], &b_pixels[i], 4) != 0) {
+      ++diff_count;
+    }
+  }
+
+  if (diff_count > 0) {
+    std::cerr << diff_count << " pixels differ" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
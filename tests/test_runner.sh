@@ -11,6 +11,7 @@ binfile="$1"
 specfile="$2"
 outfile="$3"
 masterfile="$4"
+difffile="$5"
 
 ${binfile} --in ${specfile} --out ${outfile} || exit 1
 
@@ -18,8 +19,8 @@ if [[ ! -e ${masterfile} ]]; then
   cp ${outfile} ${masterfile}
 fi
 
-# FIXME image diff
-if !(diff ${outfile} ${masterfile} &>/dev/null); then
+# compare decoded pixels; the PNG encoding itself is not part of the contract
+if !(${difffile} ${outfile} ${masterfile}); then
   echo
   print_error "ERROR: output files do not match:\n    - actual: ${outfile}\n    - master: ${masterfile}"
   echo